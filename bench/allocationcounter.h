@@ -0,0 +1,50 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+// Replaces the global operator new/delete to count heap allocations.
+// Include from exactly one translation unit of a benchmark binary.
+
+#include <QtGlobal>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<quint64> allocationCount(0);
+static std::atomic<quint64> allocationBytes(0);
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocationBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+#endif // ALLOCATIONCOUNTER_H
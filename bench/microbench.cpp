@@ -0,0 +1,332 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+// Per request CPU cost microbenchmarks.
+//
+//   microbench [--journal FILE] [--min-ms MS] [--json FILE]
+//
+// Cases:
+//   sign/<n>B              binanceapi::signature over an n byte query string
+//   request/getAggregateTrades, request/getKlines
+//                          query building and request dispatch into a sink
+//                          network manager that never answers
+//   encode/sendNewOrder    sendNewOrder payload encoding and signing
+//   parse/<kind>           QJsonDocument::fromJson of the payload
+//   handler/<kind>         the binanceapi handler the payload was captured for
+//
+// Decode payloads (depth, klines, exchangeInfo, userTrades) are taken from a
+// binancerecorder journal when one is given, the last reply per handler;
+// otherwise payloads of typical size are generated. Each case reports ns/op,
+// allocations/op and bytes/op.
+#include "../binanceapi.h"
+#include "../binancerecorder.h"
+#include "../binancereplayer.h"
+#include "../binancemockexchange.h"
+#include "allocationcounter.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QDataStream>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <cstdio>
+#include <functional>
+
+// Accepts every request and never answers; replies are collected between runs.
+class sinknetwork : public QNetworkAccessManager {
+public:
+    void clear() {
+        qDeleteAll(findChildren<QNetworkReply*>());
+    }
+
+protected:
+    QNetworkReply* createRequest(Operation operation, const QNetworkRequest& request, QIODevice* outgoingData) override {
+        Q_UNUSED(outgoingData);
+        return new binancemockreply(operation, request, 200, QByteArray(), this);
+    }
+};
+
+class binancemicrobench {
+public:
+    binancemicrobench(const QByteArray& secret, qint64 minNs)
+        : secret(secret), minNs(minNs) {
+    }
+
+    QByteArray sign(const QString& query) const {
+        return binanceapi::signature(query.toUtf8(), secret);
+    }
+
+    // Runs op in batches until minNs of measured time; cleanup runs untimed between batches.
+    QJsonObject run(const QString& name, const std::function<void()>& op, const std::function<void()>& cleanup = nullptr) {
+        const int batch = 256;
+        for (int i = 0; i < 16; ++i) {
+            op();
+        }
+        if (cleanup) {
+            cleanup();
+        }
+
+        qint64 measuredNs = 0;
+        qint64 iterations = 0;
+        quint64 allocations = 0;
+        quint64 bytes = 0;
+        QElapsedTimer clock;
+        while (measuredNs < minNs) {
+            quint64 count0 = allocationCount.load(std::memory_order_relaxed);
+            quint64 bytes0 = allocationBytes.load(std::memory_order_relaxed);
+            clock.start();
+            for (int i = 0; i < batch; ++i) {
+                op();
+            }
+            measuredNs += clock.nsecsElapsed();
+            allocations += allocationCount.load(std::memory_order_relaxed) - count0;
+            bytes += allocationBytes.load(std::memory_order_relaxed) - bytes0;
+            iterations += batch;
+            if (cleanup) {
+                cleanup();
+            }
+        }
+
+        QJsonObject result;
+        result.insert("iterations", iterations);
+        result.insert("nsPerOp", double(measuredNs) / iterations);
+        result.insert("allocationsPerOp", double(allocations) / iterations);
+        result.insert("bytesPerOp", double(bytes) / iterations);
+        fprintf(stderr, "%-36s %12.1f ns/op %10.1f allocs/op %12.1f B/op\n", qPrintable(name),
+                double(measuredNs) / iterations, double(allocations) / iterations, double(bytes) / iterations);
+        return result;
+    }
+
+private:
+    QByteArray secret;
+    qint64 minNs;
+};
+
+static QByteArray generatedDepth() {
+    QJsonArray bids;
+    QJsonArray asks;
+    for (int i = 0; i < 1000; ++i) {
+        bids.append(QJsonArray{QString::number(30000.0 - i * 0.1, 'f', 1), QString::number(0.001 * (i % 97 + 1), 'f', 3)});
+        asks.append(QJsonArray{QString::number(30000.1 + i * 0.1, 'f', 1), QString::number(0.001 * (i % 89 + 1), 'f', 3)});
+    }
+    QJsonObject depth;
+    depth.insert("lastUpdateId", 1027024);
+    depth.insert("E", 1589436922972LL);
+    depth.insert("T", 1589436922959LL);
+    depth.insert("bids", bids);
+    depth.insert("asks", asks);
+    return QJsonDocument(depth).toJson(QJsonDocument::Compact);
+}
+
+static QByteArray generatedKlines() {
+    QJsonArray klines;
+    qint64 open = 1700000000000LL;
+    for (int i = 0; i < 500; ++i) {
+        QJsonArray k;
+        k.append(open + i * 60000LL);
+        k.append("30000.10");
+        k.append("30012.40");
+        k.append("29990.00");
+        k.append("30005.20");
+        k.append("152.413");
+        k.append(open + i * 60000LL + 59999);
+        k.append("4573012.55170");
+        k.append(1532);
+        k.append("80.211");
+        k.append("2406581.11500");
+        k.append("0");
+        klines.append(k);
+    }
+    return QJsonDocument(klines).toJson(QJsonDocument::Compact);
+}
+
+static QByteArray generatedExchangeInfo() {
+    QJsonArray symbols;
+    for (int i = 0; i < 250; ++i) {
+        QJsonArray filters;
+        filters.append(QJsonObject{{"filterType", "PRICE_FILTER"}, {"minPrice", "0.10"}, {"maxPrice", "4529764"}, {"tickSize", "0.10"}});
+        filters.append(QJsonObject{{"filterType", "LOT_SIZE"}, {"minQty", "0.001"}, {"maxQty", "1000"}, {"stepSize", "0.001"}});
+        filters.append(QJsonObject{{"filterType", "MARKET_LOT_SIZE"}, {"minQty", "0.001"}, {"maxQty", "120"}, {"stepSize", "0.001"}});
+        filters.append(QJsonObject{{"filterType", "MAX_NUM_ORDERS"}, {"limit", 200}});
+        filters.append(QJsonObject{{"filterType", "MIN_NOTIONAL"}, {"notional", "100"}});
+        filters.append(QJsonObject{{"filterType", "PERCENT_PRICE"}, {"multiplierUp", "1.0500"}, {"multiplierDown", "0.9500"}, {"multiplierDecimal", "4"}});
+        QJsonObject symbol;
+        symbol.insert("symbol", QString("SYM%1USDT").arg(i));
+        symbol.insert("pair", QString("SYM%1USDT").arg(i));
+        symbol.insert("contractType", "PERPETUAL");
+        symbol.insert("status", "TRADING");
+        symbol.insert("baseAsset", QString("SYM%1").arg(i));
+        symbol.insert("quoteAsset", "USDT");
+        symbol.insert("marginAsset", "USDT");
+        symbol.insert("pricePrecision", 2);
+        symbol.insert("quantityPrecision", 3);
+        symbol.insert("filters", filters);
+        symbol.insert("orderTypes", QJsonArray{"LIMIT", "MARKET", "STOP", "STOP_MARKET", "TAKE_PROFIT", "TAKE_PROFIT_MARKET", "TRAILING_STOP_MARKET"});
+        symbol.insert("timeInForce", QJsonArray{"GTC", "IOC", "FOK", "GTX"});
+        symbols.append(symbol);
+    }
+    QJsonObject info;
+    info.insert("timezone", "UTC");
+    info.insert("serverTime", 1700000000000LL);
+    info.insert("symbols", symbols);
+    return QJsonDocument(info).toJson(QJsonDocument::Compact);
+}
+
+static QByteArray generatedUserTrades() {
+    QJsonArray trades;
+    for (int i = 0; i < 500; ++i) {
+        QJsonObject trade;
+        trade.insert("buyer", i % 2 == 0);
+        trade.insert("commission", "-0.07819010");
+        trade.insert("commissionAsset", "USDT");
+        trade.insert("id", 698759 + i);
+        trade.insert("maker", i % 3 == 0);
+        trade.insert("orderId", 25851813 + i);
+        trade.insert("price", "7819.01");
+        trade.insert("qty", "0.002");
+        trade.insert("quoteQty", "15.63802");
+        trade.insert("realizedPnl", "-0.91539999");
+        trade.insert("side", i % 2 == 0 ? "BUY" : "SELL");
+        trade.insert("positionSide", "BOTH");
+        trade.insert("symbol", "BTCUSDT");
+        trade.insert("time", 1569514978020LL + i);
+        trades.append(trade);
+    }
+    return QJsonDocument(trades).toJson(QJsonDocument::Compact);
+}
+
+static void silentMessages(QtMsgType, const QMessageLogContext&, const QString&) {
+}
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    auto option = [&args](const QString& name, const QString& fallback) {
+        int at = args.indexOf(name);
+        return at >= 0 && at + 1 < args.size() ? args.at(at + 1) : fallback;
+    };
+    qint64 minNs = option("--min-ms", "500").toLongLong() * 1000000;
+    QString journal = option("--journal", QString());
+    QString jsonFile = option("--json", QString());
+
+    struct Capture {
+        QString kind;
+        QByteArray handler;
+        QByteArray url;
+        QByteArray payload;
+    };
+    QVector<Capture> captures = {
+        {"depth", "handleDepthResponse", "https://fapi.binance.com/fapi/v1/depth?symbol=BTCUSDT&limit=1000", generatedDepth()},
+        {"klines", "handleKlinesResponse", "https://fapi.binance.com/fapi/v1/klines?symbol=BTCUSDT&interval=1m", generatedKlines()},
+        {"exchangeInfo", "handleExchangeInfoResponse", "https://fapi.binance.com/fapi/v1/exchangeInfo", generatedExchangeInfo()},
+        {"userTrades", "handleUserTrades", "https://fapi.binance.com/fapi/v1/userTrades?symbol=BTCUSDT", generatedUserTrades()},
+    };
+    bool captured = false;
+    if (!journal.isEmpty()) {
+        QFile file(journal);
+        if (!file.open(QIODevice::ReadOnly)) {
+            fprintf(stderr, "cannot open %s\n", qPrintable(journal));
+            return 1;
+        }
+        QDataStream in(&file);
+        if (!binancerecorder::readHeader(in)) {
+            fprintf(stderr, "%s is not a binancerecorder journal\n", qPrintable(journal));
+            return 1;
+        }
+        binancerecorder::Record record;
+        while (binancerecorder::readRecord(in, record)) {
+            for (Capture& capture : captures) {
+                if (record.kind == binancerecorder::Reply && record.handler == capture.handler && record.httpStatus == 200) {
+                    capture.url = record.url;
+                    capture.payload = record.payload;
+                    captured = true;
+                }
+            }
+        }
+    }
+
+    sinknetwork sink;
+    const QByteArray secret("benchsecretbenchsecretbenchsecretbenchsecretbenchsecretbenchsecret");
+    binanceapi api("benchkey", QString::fromLatin1(secret));
+    api.setNetworkAccessManager(&sink);
+    binancereplayer replayer;
+    replayer.addTarget(&api);
+    binancemicrobench bench(secret, minNs);
+    auto collect = [&sink]() {
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+        sink.clear();
+    };
+
+    QJsonObject results;
+    for (int size : {64, 256, 1024, 4096}) {
+        QString query;
+        while (query.size() < size) {
+            query += QString("symbol=BTCUSDT&side=BUY&type=LIMIT&quantity=0.010&price=30000.10&timestamp=%1&")
+                         .arg(QDateTime::currentMSecsSinceEpoch());
+        }
+        query.truncate(size);
+        results.insert(QString("sign/%1B").arg(size), bench.run(QString("sign/%1B").arg(size), [&]() { bench.sign(query); }));
+    }
+
+    results.insert("request/getAggregateTrades", bench.run("request/getAggregateTrades", [&]() {
+        api.getAggregateTrades("BTCUSDT", 26129, 1700000000000LL, 1700003600000LL, 500);
+    }, collect));
+    results.insert("request/getKlines", bench.run("request/getKlines", [&]() {
+        api.getKlines("BTCUSDT", "1m", 1700000000000LL, 1700003600000LL, 500);
+    }, collect));
+    results.insert("encode/sendNewOrder", bench.run("encode/sendNewOrder", [&]() {
+        api.sendNewOrder("BTCUSDT", "BUY", "BOTH", "LIMIT", "GTC", "0.010", QString(), "30000.10", "bench-order",
+                         QString(), QString(), QString(), QString(), QString(), QString(), "ACK", 5000,
+                         QDateTime::currentMSecsSinceEpoch());
+    }, collect));
+
+    // Handlers log what they decode; keep the terminal out of the measurement.
+    QtMessageHandler previous = qInstallMessageHandler(silentMessages);
+    for (const Capture& capture : captures) {
+        results.insert("parse/" + capture.kind, bench.run("parse/" + capture.kind, [&]() {
+            QJsonDocument document = QJsonDocument::fromJson(capture.payload);
+            Q_UNUSED(document);
+        }));
+
+        binancerecorder::Record record;
+        record.kind = binancerecorder::Reply;
+        record.handler = capture.handler;
+        record.url = capture.url;
+        record.httpStatus = 200;
+        record.payload = capture.payload;
+        results.insert("handler/" + capture.kind, bench.run("handler/" + capture.kind, [&]() {
+            replayer.dispatch(record);
+        }, collect));
+    }
+    qInstallMessageHandler(previous);
+
+    QJsonObject payloads;
+    for (const Capture& capture : captures) {
+        payloads.insert(capture.kind, capture.payload.size());
+    }
+
+    QJsonObject report;
+    report.insert("benchmark", "microbench");
+    report.insert("qt", QString(qVersion()));
+    report.insert("payloads", captured ? "journal" : "generated");
+    report.insert("payloadBytes", payloads);
+    report.insert("results", results);
+
+    QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    if (jsonFile.isEmpty()) {
+        fwrite(json.constData(), 1, size_t(json.size()), stdout);
+    } else {
+        QFile file(jsonFile);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            fprintf(stderr, "cannot write %s\n", qPrintable(jsonFile));
+            return 1;
+        }
+        file.write(json);
+    }
+    return 0;
+}
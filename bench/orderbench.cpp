@@ -0,0 +1,225 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+// Order round trip benchmark against the in-process mock exchange.
+//
+//   orderbench [--ops N] [--rate OPS_PER_SEC] [--delay MS] [--json FILE]
+//
+// Runs sendNewOrder, batchOrders (5 orders), modifyOrder and cancelOrder one
+// at a time, paced at --rate (0 = back to back), and prints JSON with
+// throughput, allocations per operation and latency percentiles (ns) for the
+// whole round trip and for each stage:
+//   encode   call start -> request handed to the network manager, minus sign
+//   sign     HMAC-SHA256 over the same payload, timed separately
+//   send     network manager -> response built by the mock
+//   receive  response built -> reply delivered (delay + event loop)
+//   decode   reply delivered -> result signal emitted by binanceapi
+#include "../binanceapi.h"
+#include "../binancelatency.h"
+#include "../binancemockexchange.h"
+#include "allocationcounter.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QMessageAuthenticationCode>
+#include <QDateTime>
+#include <functional>
+
+class orderbench {
+public:
+    orderbench(binanceapi* api, binancemockexchange* mock, int ops, int rate)
+        : api(api), ops(ops), rate(rate), responsesLeft(0), loop(nullptr) {
+        QObject::connect(mock, &binancemockexchange::requestReceived, [this](const QString&, const QByteArray& body) {
+            t1 = clock.nsecsElapsed();
+            allocationsAtSend = allocationCount.load(std::memory_order_relaxed);
+            payload = body;
+        });
+        QObject::connect(mock, &binancemockexchange::responseReady, [this](const QString&) {
+            t2 = clock.nsecsElapsed();
+            mockAllocations = allocationCount.load(std::memory_order_relaxed) - allocationsAtSend;
+        });
+        QObject::connect(mock, &binancemockexchange::responseDelivered, [this](const QString&) {
+            t3 = clock.nsecsElapsed();
+        });
+        QObject::connect(api, &binanceapi::newOrderResponseReceived, [this](const QJsonObject&) { responded(); });
+        QObject::connect(api, &binanceapi::modifyOrderResponseReceived, [this](const QJsonObject&) { responded(); });
+        QObject::connect(api, &binanceapi::cancelOrderResponseReceived, [this](const QJsonObject&) { responded(); });
+        QObject::connect(api, &binanceapi::orderRequestFailed, [this](const QString&, int, const QString&) {
+            ++errors;
+            responded();
+        });
+        clock.start();
+    }
+
+    QJsonObject run(const std::function<void(int)>& issue, int responsesPerOp) {
+        binancehistogram total, encode, sign, send, receive, decode;
+        quint64 allocations = 0;
+        quint64 bytes = 0;
+        errors = 0;
+        qint64 periodNs = rate > 0 ? 1000000000LL / rate : 0;
+        qint64 startNs = clock.nsecsElapsed();
+
+        for (int i = 0; i < ops; ++i) {
+            if (periodNs > 0) {
+                qint64 wait = startNs + i * periodNs - clock.nsecsElapsed();
+                if (wait > 0) {
+                    QEventLoop pause;
+                    QTimer::singleShot(int(wait / 1000000), Qt::PreciseTimer, &pause, &QEventLoop::quit);
+                    pause.exec();
+                }
+            }
+
+            QEventLoop wait;
+            loop = &wait;
+            responsesLeft = responsesPerOp;
+            mockAllocations = 0;
+            quint64 count0 = allocationCount.load(std::memory_order_relaxed);
+            quint64 bytes0 = allocationBytes.load(std::memory_order_relaxed);
+            t0 = clock.nsecsElapsed();
+            issue(i);
+            if (responsesLeft > 0) {
+                wait.exec();
+            }
+            loop = nullptr;
+            allocations += allocationCount.load(std::memory_order_relaxed) - count0 - mockAllocations;
+            bytes += allocationBytes.load(std::memory_order_relaxed) - bytes0;
+
+            // Outside the timed window: sign the captured payload the way binanceapi does.
+            qint64 signStart = clock.nsecsElapsed();
+            QByteArray signature = QMessageAuthenticationCode::hash(payload, QByteArrayLiteral("benchsecret"),
+                                                                    QCryptographicHash::Sha256).toHex();
+            qint64 signNs = clock.nsecsElapsed() - signStart;
+            Q_UNUSED(signature);
+
+            total.record(t4 - t0);
+            sign.record(signNs);
+            encode.record(qMax<qint64>(0, t1 - t0 - signNs));
+            send.record(t2 - t1);
+            receive.record(t3 - t2);
+            decode.record(t4 - t3);
+        }
+        qint64 elapsedNs = clock.nsecsElapsed() - startNs;
+
+        QJsonObject stages;
+        stages.insert("encode", encode.toJson());
+        stages.insert("sign", sign.toJson());
+        stages.insert("send", send.toJson());
+        stages.insert("receive", receive.toJson());
+        stages.insert("decode", decode.toJson());
+
+        QJsonObject result;
+        result.insert("operations", ops);
+        result.insert("errors", errors);
+        result.insert("elapsedMs", double(elapsedNs) / 1e6);
+        result.insert("throughput", elapsedNs > 0 ? ops * 1e9 / double(elapsedNs) : 0.0);
+        result.insert("allocationsPerOp", double(allocations) / qMax(1, ops));
+        result.insert("bytesPerOp", double(bytes) / qMax(1, ops));
+        result.insert("latencyNs", total.toJson());
+        result.insert("stagesNs", stages);
+        return result;
+    }
+
+private:
+    void responded() {
+        if (--responsesLeft == 0) {
+            t4 = clock.nsecsElapsed();
+            if (loop) {
+                loop->quit();
+            }
+        }
+    }
+
+    binanceapi* api;
+    int ops;
+    int rate;
+    int responsesLeft;
+    int errors = 0;
+    QEventLoop* loop;
+    QElapsedTimer clock;
+    QByteArray payload;
+    quint64 allocationsAtSend = 0;
+    quint64 mockAllocations = 0;
+    qint64 t0 = 0;
+    qint64 t1 = 0;
+    qint64 t2 = 0;
+    qint64 t3 = 0;
+    qint64 t4 = 0;
+};
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    auto option = [&args](const QString& name, const QString& fallback) {
+        int at = args.indexOf(name);
+        return at >= 0 && at + 1 < args.size() ? args.at(at + 1) : fallback;
+    };
+    int ops = option("--ops", "10000").toInt();
+    int rate = option("--rate", "0").toInt();
+    int delay = option("--delay", "0").toInt();
+    QString jsonFile = option("--json", QString());
+
+    binancemockexchange mock;
+    mock.setResponseDelay(delay);
+    binanceapi api("benchkey", "benchsecret");
+    api.setNetworkAccessManager(&mock);
+    orderbench bench(&api, &mock, ops, rate);
+
+    auto clientOrderId = [](const char* prefix, int i) { return QString("%1-%2").arg(prefix).arg(i); };
+
+    QJsonObject results;
+    results.insert("sendNewOrder", bench.run([&](int i) {
+        api.sendNewOrder("BTCUSDT", "BUY", "BOTH", "LIMIT", "GTC", "0.010", QString(), "30000.10",
+                         clientOrderId("new", i), QString(), QString(), QString(), QString(), QString(), QString(),
+                         "ACK", 5000, QDateTime::currentMSecsSinceEpoch());
+    }, 1));
+    results.insert("batchOrders", bench.run([&](int i) {
+        QJsonArray orderList;
+        for (int n = 0; n < 5; ++n) {
+            QJsonObject order;
+            order.insert("symbol", "BTCUSDT");
+            order.insert("side", "BUY");
+            order.insert("type", "LIMIT");
+            order.insert("timeInForce", "GTC");
+            order.insert("quantity", "0.010");
+            order.insert("price", QString::number(30000.10 - n, 'f', 2));
+            order.insert("newClientOrderId", clientOrderId("batch", i * 5 + n));
+            orderList.append(order);
+        }
+        api.batchOrders(orderList, 5000, QDateTime::currentMSecsSinceEpoch());
+    }, 5));
+    results.insert("modifyOrder", bench.run([&](int i) {
+        api.modifyOrder(1000000 + i, clientOrderId("new", i), "BTCUSDT", "BUY", "0.010", "30001.20",
+                        5000, QDateTime::currentMSecsSinceEpoch());
+    }, 1));
+    results.insert("cancelOrder", bench.run([&](int i) {
+        api.cancelOrder("BTCUSDT", 1000000 + i, clientOrderId("new", i), 5000, QDateTime::currentMSecsSinceEpoch());
+    }, 1));
+
+    QJsonObject report;
+    report.insert("benchmark", "orderbench");
+    report.insert("qt", QString(qVersion()));
+    report.insert("operations", ops);
+    report.insert("rate", rate);
+    report.insert("responseDelayMs", delay);
+    report.insert("results", results);
+
+    QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    if (jsonFile.isEmpty()) {
+        fwrite(json.constData(), 1, size_t(json.size()), stdout);
+    } else {
+        QFile file(jsonFile);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            fprintf(stderr, "cannot write %s\n", qPrintable(jsonFile));
+            return 1;
+        }
+        file.write(json);
+    }
+    return 0;
+}
@@ -5,147 +5,609 @@
 ======================================================================
 */
 #include "binanceapi.h"
+#include "binancerecorder.h"
+#include "binancelatency.h"
+#include "binancemetrics.h"
+#include "binancetracer.h"
+#include "binancelogger.h"
+#include "binancevalidator.h"
+#include "binancereplayer.h"
+#include <QElapsedTimer>
+#include <QSharedPointer>
 
 
 binanceapi::binanceapi(const QString& apiKey, const QString& apiSecret, QObject* parent)
-    : QObject(parent), apiKey(apiKey), apiSecret(apiSecret) {
+    : QObject(parent), apiKey(apiKey), apiSecret(apiSecret), baseUrl("https://fapi.binance.com"), spotBaseUrl("https://api.binance.com"),
+      streamBaseUrl("wss://fstream.binance.com"), webSocketApiUrl("wss://ws-fapi.binance.com/ws-fapi/v1"), networkManager(new QNetworkAccessManager(this)), recorder(nullptr), latency(nullptr), metrics(nullptr), tracer(nullptr), traceEnqueueNs(-1), traceDecodedNs(-1), orderBatchEnqueueNs(-1), sentWeight(0), cacheRefreshing(false), coalescedCount(0), logger(nullptr), logHandler(nullptr), logBytes(0), userStreamRequested(false), validator(nullptr), orderBatchWindowUs(0), orderBatchRecvWindow(-1), batchClientIds(binanceclientid::batchStrategy) {
+    binancetypes::registerMetaTypes();
+    connect(&marketStream, &QWebSocket::connected, this, &binanceapi::onMarketStreamConnected);
+    connect(&marketStream, &QWebSocket::disconnected, this, &binanceapi::onMarketStreamDisconnected);
+    connect(&marketStream, &QWebSocket::textMessageReceived, this, &binanceapi::handleMarketStreamMessage);
+    marketStreamReconnect.setSingleShot(true);
+    connect(&marketStreamReconnect, &QTimer::timeout, this, &binanceapi::reconnectMarketStream);
+    connect(&userStream, &QWebSocket::connected, this, &binanceapi::userStreamConnected);
+    connect(&userStream, &QWebSocket::disconnected, this, &binanceapi::onUserStreamDisconnected);
+    connect(&userStream, &QWebSocket::textMessageReceived, this, &binanceapi::handleUserStreamMessage);
+    connect(&userStreamKeepAlive, &QTimer::timeout, this, [this]() { extendUserDataStream(userStreamListenKey); });
+    orderBatchTimer.setSingleShot(true);
+    orderBatchTimer.setTimerType(Qt::PreciseTimer);
+    connect(&orderBatchTimer, &QTimer::timeout, this, &binanceapi::flushOrderBatch);
+    connect(&webSocketApi, &QWebSocket::connected, this, &binanceapi::onWebSocketApiConnected);
+    connect(&webSocketApi, &QWebSocket::disconnected, this, &binanceapi::onWebSocketApiDisconnected);
+    connect(&webSocketApi, &QWebSocket::textMessageReceived, this, &binanceapi::handleWebSocketApiMessage);
+    connect(&webSocketApi, static_cast<void (QWebSocket::*)(QAbstractSocket::SocketError)>(&QWebSocket::error),
+            this, &binanceapi::onWebSocketApiError);
+    webSocketApiTimer.setSingleShot(true);
+    connect(&webSocketApiTimer, &QTimer::timeout, this, &binanceapi::expireWebSocketApiRequests);
 }
 
 void binanceapi::getAccountInformation() {
-    QUrl url("https://api.binance.com/api/v3/account");
-    QUrlQuery query;
-    query.addQueryItem("timestamp", QString::number(QDateTime::currentMSecsSinceEpoch()));
-    QString signature = generateSignature(query.toString());
-    query.addQueryItem("signature", signature);
-    url.setQuery(query);
+    if (joinInFlight(binanceendpointid::SpotAccount, QString())) {
+        return;
+    }
+    QUrl url = endpointUrl<binanceendpointid::SpotAccount>();
+    url.setQuery(QString::fromLatin1(encodeParams<binanceendpointid::SpotAccount>(QUrlQuery())));
 
     QNetworkRequest request(url);
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
 
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleAccountInformation(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    trackInFlight(reply, binanceendpointid::SpotAccount, QString());
+    watchReply(reply, "handleAccountInformation", &binanceapi::handleAccountInformation);
+}
+
+
+QByteArray binanceapi::signature(const QByteArray& payload, const QByteArray& secret) {
+    return QMessageAuthenticationCode::hash(payload, secret, QCryptographicHash::Sha256).toHex();
+}
+
+QNetworkRequest binanceapi::endpointRequest(binanceendpointid endpoint) const {
+    const binanceendpoint& spec = binanceendpointspec(endpoint);
+    QNetworkRequest request(QUrl((spec.spot ? spotBaseUrl : baseUrl) + QLatin1String(spec.path)));
+    request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
+    if (qstrcmp(spec.method, "POST") == 0 || qstrcmp(spec.method, "PUT") == 0) {
+        request.setRawHeader("Content-Type", "application/x-www-form-urlencoded");
+    }
+    return request;
+}
+
+void binanceapi::keySigner(QMessageAuthenticationCode& mac) const {
+    mac.setKey(apiSecret.toUtf8());
+}
+
+QByteArray binanceapi::signParams(QByteArray params) const {
+    // Callers may leave timestamp out (-1 defaults); the exchange rejects a signed call without one.
+    if (!params.startsWith("timestamp=") && !params.contains("&timestamp=")) {
+        if (!params.isEmpty()) {
+            params += '&';
+        }
+        params += "timestamp=" + QByteArray::number(QDateTime::currentMSecsSinceEpoch());
+    }
+    // The HMAC covers exactly the bytes sent, so it is taken after encoding and appended last.
+    return params + "&signature=" + signature(params, apiSecret.toUtf8());
+}
+
+void binanceapi::setBaseUrls(const QString& restUrl, const QString& streamUrl, const QString& webSocketApiUrl, const QString& spotUrl) {
+    baseUrl = restUrl;
+    spotBaseUrl = spotUrl.isEmpty() ? restUrl : spotUrl;
+    streamBaseUrl = streamUrl;
+    this->webSocketApiUrl = webSocketApiUrl;
+}
+
+void binanceapi::setNetworkAccessManager(QNetworkAccessManager* manager) {
+    if (networkManager->parent() == this) {
+        networkManager->deleteLater();
+    }
+    networkManager = manager;
+}
+
+void binanceapi::setRecorder(binancerecorder* recorder) {
+    this->recorder = recorder;
+}
+
+void binanceapi::setLatencyMonitor(binancelatency* latency) {
+    this->latency = latency;
+    firstByteHistograms.clear();
+    decodeHistograms.clear();
+    marketStreamHistograms.clear();
+    userStreamHistograms.clear();
+}
+
+binancehistogram* binanceapi::latencyHistogram(QHash<const char*, binancehistogram*>& cache, const char* handler, bool decode) {
+    auto it = cache.constFind(handler);
+    if (it == cache.constEnd()) {
+        it = cache.insert(handler, decode ? latency->decode(handler) : latency->firstByte(handler));
+    }
+    return it.value();
+}
+
+binancelatency::Stream binanceapi::latencyStream(QHash<QString, binancelatency::Stream>& cache, const char* prefix, const QString& stream) {
+    auto it = cache.constFind(stream);
+    if (it == cache.constEnd()) {
+        it = cache.insert(stream, latency->stream(QLatin1String(prefix) + stream));
+    }
+    return it.value();
+}
+
+void binanceapi::setMetrics(binancemetrics* metrics) {
+    this->metrics = metrics;
+    replyMetricSeries.clear();
+    streamMetricSeries.clear();
+}
+
+int binanceapi::metricSeries(int kind, const QString& endpoint) {
+    QString key = QString::number(kind) + endpoint;
+    auto it = streamMetricSeries.constFind(key);
+    if (it != streamMetricSeries.constEnd()) {
+        return it.value();
+    }
+    int series = metrics->series(binancemetrics::Kind(kind), endpoint, objectName());
+    streamMetricSeries.insert(key, series);
+    return series;
+}
+
+void binanceapi::recordReplyMetrics(const char* handler, QNetworkReply* reply, qint64 elapsedUs) {
+    auto it = replyMetricSeries.constFind(handler);
+    if (it == replyMetricSeries.constEnd()) {
+        it = replyMetricSeries.insert(handler, metrics->series(binancemetrics::Rest, handler, objectName()));
+    }
+    int code = 0;
+    if (reply->error() != QNetworkReply::NoError) {
+        // Error bodies are small; peek so the handler still reads the whole reply.
+        QJsonObject error = QJsonDocument::fromJson(reply->peek(4096)).object();
+        code = error.contains("code") ? error.value("code").toInt() : -int(reply->error());
+    }
+    metrics->recordRequest(it.value(), reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), code, elapsedUs);
+    auto header = [reply](const char* name) {
+        QByteArray value = reply->rawHeader(name);
+        return value.isEmpty() ? qint64(-1) : value.toLongLong();
+    };
+    metrics->recordUsage(it.value(), header("X-MBX-USED-WEIGHT-1M"), header("X-MBX-ORDER-COUNT-10S"), header("X-MBX-ORDER-COUNT-1M"));
+}
+
+void binanceapi::setTracer(binancetracer* tracer) {
+    this->tracer = tracer;
+}
+
+void binanceapi::traceEnqueue() {
+    traceEnqueueNs = tracer ? tracer->now() : -1;
+}
+
+void binanceapi::traceDecoded() {
+    if (tracer) {
+        traceDecodedNs = tracer->now();
+    }
+}
+
+void binanceapi::traceReply(binancetracer* trace, const char* handler, const ReplyTiming& timing) {
+    qint64 endNs = trace->now();
+    quint64 id = trace->nextId();
+    trace->record(handler, nullptr, id, timing.enqueuedNs >= 0 ? timing.enqueuedNs : timing.dispatchNs, endNs);
+    if (timing.enqueuedNs >= 0) {
+        trace->record(handler, "queue", id, timing.enqueuedNs, timing.dispatchNs);
+    }
+    qint64 waitFrom = timing.dispatchNs;
+    if (timing.connectedNs >= 0) {
+        trace->record(handler, "connect", id, timing.dispatchNs, timing.connectedNs);
+        waitFrom = timing.connectedNs;
+    }
+    qint64 firstByteNs = timing.firstByteNs >= 0 ? timing.firstByteNs : timing.lastByteNs;
+    trace->record(handler, "wait", id, waitFrom, firstByteNs);
+    trace->record(handler, "download", id, firstByteNs, timing.lastByteNs);
+    if (traceDecodedNs >= 0) {
+        trace->record(handler, "decode", id, timing.lastByteNs, traceDecodedNs);
+        trace->record(handler, "deliver", id, traceDecodedNs, endNs);
+    } else {
+        trace->record(handler, "handle", id, timing.lastByteNs, endNs);
+    }
+}
+
+void binanceapi::traceMessage(binancetracer* trace, const char* handler, qint64 startNs, qint64 receivedNs, qint64 decodedNs) {
+    qint64 endNs = trace->now();
+    quint64 id = trace->nextId();
+    trace->record(handler, nullptr, id, startNs, endNs);
+    if (receivedNs > startNs) {
+        trace->record(handler, "wait", id, startNs, receivedNs);
+    }
+    trace->record(handler, "decode", id, receivedNs, decodedNs);
+    trace->record(handler, "deliver", id, decodedNs, endNs);
+}
+
+void binanceapi::setLogger(binancelogger* logger) {
+    this->logger = logger;
+    logEndpoints.clear();
+}
+
+binancelogendpoint* binanceapi::logEndpoint(const char* handler) {
+    binancelogendpoint*& endpoint = logEndpoints[handler];
+    if (!endpoint) {
+        endpoint = logger->endpoint(handler);
+    }
+    return endpoint;
+}
+
+void binanceapi::logReply(const char* handler, QNetworkReply* reply) {
+    logHandler = handler;
+    if (!logger) {
+        return;
+    }
+    logBytes = reply->bytesAvailable();
+    binancelogendpoint* endpoint = logEndpoint(handler);
+    if (logger->payloads(endpoint)) {
+        // The only copy of the body, and only for endpoints switched on.
+        logger->write(endpoint, binancelogger::Debug, "Payload:", logBytes, reply->peek(logBytes));
+    }
+}
+
+void binanceapi::logMessage(int level, const char* message, qint64 value, const QString& detail) {
+    if (!logger) {
+        if (detail.isEmpty() && value == 0) {
+            qDebug() << message;
+        } else if (detail.isEmpty()) {
+            qDebug() << message << value;
+        } else {
+            qDebug() << message << detail;
+        }
+        return;
+    }
+    binancelogendpoint* endpoint = logEndpoint(logHandler ? logHandler : "binanceapi");
+    if (logger->enabled(endpoint, binancelogger::Level(level))) {
+        logger->write(endpoint, binancelogger::Level(level), message, value, detail.toUtf8());
+    }
 }
 
+void binanceapi::logReplyError(QNetworkReply* reply) {
+    logMessage(binancelogger::Warning, "There was an error with the request:", reply->error(), reply->errorString());
+}
+
+void binanceapi::logReceived(const char* message) {
+    // Body size instead of the decoded document; formatting it cost more than the decode.
+    logMessage(binancelogger::Debug, message, logger ? logBytes : 0);
+}
+
+void binanceapi::setCacheTtl(binanceendpointid endpoint, int ttlMs) {
+    responseCache.setTtl(endpoint, ttlMs);
+}
+
+void binanceapi::setCacheRefreshAhead(double fraction) {
+    responseCache.setRefreshAhead(fraction);
+}
 
-QString binanceapi::generateSignature(const QString& queryString) const {
-    return QMessageAuthenticationCode::hash(queryString.toUtf8(), apiSecret.toUtf8(), QCryptographicHash::Sha256).toHex();
+void binanceapi::invalidateCache(binanceendpointid endpoint) {
+    responseCache.invalidate(endpoint);
+}
+
+void binanceapi::clearCache() {
+    responseCache.clear();
+}
+
+bool binanceapi::answerFromCache(binanceendpointid endpoint, const QString& key, const char* handler,
+                                 void (binanceapi::*slot)(QNetworkReply*), const std::function<void()>& refresh) {
+    if (cacheRefreshing) {
+        return false;
+    }
+    QUrl url;
+    QByteArray body;
+    binanceresponsecache::State state = responseCache.lookup(endpoint, key, &url, &body);
+    if (state == binanceresponsecache::Miss) {
+        return false;
+    }
+    if (state == binanceresponsecache::Refresh && responseCache.beginRefresh(endpoint, key)) {
+        // Re-enters the getter, which skips the cache and sends a request
+        // whose reply only replaces the entry.
+        cacheRefreshing = true;
+        refresh();
+        cacheRefreshing = false;
+    }
+    // Delivered from the event loop like a network reply, so callers see the
+    // same ordering whether or not the data was cached.
+    QTimer::singleShot(0, this, [=]() {
+        binancereplayreply* reply = new binancereplayreply(url, 200, body, this);
+        reply->setProperty("cacheEndpoint", int(endpoint));
+        reply->setProperty("cacheKey", key);
+        logReply(handler, reply);
+        (this->*slot)(reply);
+        logHandler = nullptr;
+    });
+    return true;
+}
+
+bool binanceapi::cacheReply(QNetworkReply* reply, binanceendpointid endpoint, const QString& key) {
+    bool refreshing = cacheRefreshing;
+    if (responseCache.ttl(endpoint) <= 0 && !refreshing) {
+        return false;
+    }
+    quint64 generation = responseCache.generation(endpoint);
+    connect(reply, &QNetworkReply::finished, this, [=]() {
+        int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        // Peek: the handler connected after this still reads the whole body.
+        if (reply->error() == QNetworkReply::NoError && status == 200 && responseCache.generation(endpoint) == generation) {
+            responseCache.store(endpoint, key, reply->url(), reply->peek(reply->bytesAvailable()));
+            // The handler then decodes the stored body instead of its own copy.
+            reply->setProperty("cacheEndpoint", int(endpoint));
+            reply->setProperty("cacheKey", key);
+        }
+        if (refreshing) {
+            // No handler sees a background refresh; the stale entry keeps
+            // serving until it expires and the next read retries.
+            if (reply->error() != QNetworkReply::NoError) {
+                QJsonObject error = QJsonDocument::fromJson(reply->readAll()).object();
+                int code = error.contains("code") ? error.value("code").toInt() : -int(reply->error());
+                QString message = error.contains("msg") ? error.value("msg").toString() : reply->errorString();
+                const char* path = binanceendpointspec(endpoint).path;
+                logMessage(binancelogger::Warning, "Cache refresh failed:", code, QLatin1String(path) + " " + message);
+                emit cacheRefreshFailed(QLatin1String(path), code, message);
+            }
+            responseCache.endRefresh(endpoint, key);
+            reply->deleteLater();
+        }
+    });
+    return refreshing;
+}
+
+QJsonDocument binanceapi::replyDocument(QNetworkReply* reply) {
+    // A cached endpoint's body is decoded once into its cache entry (stored
+    // before the handler runs) and every later hit shares that document.
+    QVariant endpoint = reply->property("cacheEndpoint");
+    if (endpoint.isValid()) {
+        const QJsonDocument* document = responseCache.document(binanceendpointid(endpoint.toInt()), reply->property("cacheKey").toString());
+        if (document) {
+            return *document;
+        }
+    }
+    return QJsonDocument::fromJson(reply->readAll());
+}
+
+bool binanceapi::joinInFlight(binanceendpointid endpoint, const QString& key) {
+    // The outstanding reply's handler emits once for every receiver, which is
+    // all a second identical request would have produced.
+    if (!inFlight.contains(QString::number(int(endpoint)) + '|' + key)) {
+        return false;
+    }
+    ++coalescedCount;
+    return true;
+}
+
+void binanceapi::trackInFlight(QNetworkReply* reply, binanceendpointid endpoint, const QString& key) {
+    QString entry = QString::number(int(endpoint)) + '|' + key;
+    inFlight.insert(entry);
+    // Connected ahead of the handler, so a receiver that asks again from
+    // inside the emit sends a new request instead of joining a finished one.
+    connect(reply, &QNetworkReply::finished, this, [this, entry]() { inFlight.remove(entry); });
+}
+
+qint64 binanceapi::coalescedRequests() const {
+    return coalescedCount;
+}
+
+qint64 binanceapi::totalRequestWeight() const {
+    return sentWeight;
+}
+
+bool binanceapi::invalidLimit(const binanceendpoint& endpoint, int limit) {
+    QString valid;
+    if (endpoint.limits[0] != 0) {
+        QStringList values;
+        for (int i = 0; i < 8 && endpoint.limits[i] != 0; ++i) {
+            values.append(QString::number(endpoint.limits[i]));
+        }
+        valid = "Valid limits are: " + values.join(", ");
+    } else {
+        valid = QString("Valid limits are between %1 and %2").arg(endpoint.minLimit).arg(endpoint.maxLimit);
+    }
+    logMessage(binancelogger::Warning, "Invalid limit.", limit, valid);
+    return false;
+}
+
+void binanceapi::setOrderValidator(binancevalidator* validator) {
+    this->validator = validator;
+}
+
+bool binanceapi::validateOrder(const QString& symbol, const QString& side, const QString& type, const QString& price,
+                               const QString& quantity, const QString& reduceOnly, const QString& clientOrderId) {
+    QString message;
+    int code = validator->check(symbol, side, type, price, quantity, reduceOnly == "true", &message);
+    if (code != 0) {
+        emit orderRequestFailed(clientOrderId, code, message);
+        return false;
+    }
+    return true;
+}
+
+void binanceapi::watchReply(QNetworkReply* reply, const char* handler, void (binanceapi::*slot)(QNetworkReply*)) {
+    binancetracer* trace = tracer && tracer->sample() ? tracer : nullptr;
+    qint64 enqueuedNs = traceEnqueueNs;
+    traceEnqueueNs = -1;
+    if (!latency && !metrics && !trace) {
+        connect(reply, &QNetworkReply::finished, this, [=]() {
+            if (recorder) {
+                recorder->recordReply(handler, reply);
+            }
+            logReply(handler, reply);
+            (this->*slot)(reply);
+            logHandler = nullptr;
+        });
+        return;
+    }
+
+    QSharedPointer<ReplyTiming> timing(new ReplyTiming);
+    timing->sent.start();
+    if (trace) {
+        timing->enqueuedNs = enqueuedNs;
+        timing->dispatchNs = trace->now();
+        // Only emitted when the request had to open a new TLS connection.
+        connect(reply, &QNetworkReply::encrypted, this, [=]() { timing->connectedNs = trace->now(); });
+    }
+    if (latency || trace) {
+        connect(reply, &QNetworkReply::metaDataChanged, this, [=]() {
+            if (!timing->firstByte) {
+                if (latency) {
+                    latencyHistogram(firstByteHistograms, handler, false)->record(timing->sent.nsecsElapsed() / 1000);
+                }
+                if (trace) {
+                    timing->firstByteNs = trace->now();
+                }
+                timing->firstByte = true;
+            }
+        });
+    }
+    connect(reply, &QNetworkReply::finished, this, [=]() {
+        if (trace) {
+            timing->lastByteNs = trace->now();
+        }
+        if (recorder) {
+            recorder->recordReply(handler, reply);
+        }
+        if (metrics) {
+            recordReplyMetrics(handler, reply, timing->sent.nsecsElapsed() / 1000);
+        }
+        QElapsedTimer decode;
+        decode.start();
+        traceDecodedNs = -1;
+        logReply(handler, reply);
+        (this->*slot)(reply);
+        logHandler = nullptr;
+        if (latency) {
+            latencyHistogram(decodeHistograms, handler, true)->record(decode.nsecsElapsed() / 1000);
+        }
+        if (trace) {
+            traceReply(trace, handler, *timing);
+        }
+    });
 }
 
 void binanceapi::ping() {
-    QUrl url("https://fapi.binance.com/fapi/v1/ping");
+    QUrl url = endpointUrl<binanceendpointid::Ping>();
     QNetworkRequest request(url);
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handlePingResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handlePingResponse", &binanceapi::handlePingResponse);
 }
 
 void binanceapi::handlePingResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        qDebug() << "Ping successful!";
+        logReceived("Ping successful!");
     }
     reply->deleteLater();
 }
 void binanceapi::getTime() {
-    QUrl url("https://fapi.binance.com/fapi/v1/time");
+    QUrl url = endpointUrl<binanceendpointid::Time>();
     QNetworkRequest request(url);
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleTimeResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handleTimeResponse", &binanceapi::handleTimeResponse);
 }
 
 void binanceapi::handleTimeResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
         QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
         QJsonObject jsonObject = jsonResponse.object();
         if (jsonObject.contains("serverTime")) {
-            qDebug() << "Server time:" << jsonObject["serverTime"].toString();
+            logMessage(binancelogger::Debug, "Server time:", jsonObject["serverTime"].toVariant().toLongLong());
         }
     }
     reply->deleteLater();
 }
 
 void binanceapi::getExchangeInfo() {
-    QUrl url("https://fapi.binance.com/fapi/v1/exchangeInfo");
+    if (answerFromCache(binanceendpointid::ExchangeInfo, QString(), "handleExchangeInfoResponse", &binanceapi::handleExchangeInfoResponse,
+                        [this]() { getExchangeInfo(); })) {
+        return;
+    }
+    QUrl url = endpointUrl<binanceendpointid::ExchangeInfo>();
     QNetworkRequest request(url);
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleExchangeInfoResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    if (!cacheReply(reply, binanceendpointid::ExchangeInfo, QString())) {
+        watchReply(reply, "handleExchangeInfoResponse", &binanceapi::handleExchangeInfoResponse);
+    }
 }
 
 void binanceapi::handleExchangeInfoResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Exchange Info:" << jsonObject;
+        QJsonObject jsonObject = replyDocument(reply).object();
+        logReceived("Exchange Info");
+        emit exchangeInfoReceived(jsonObject);
     }
     reply->deleteLater();
 }
 void binanceapi::getDepth(const QString& symbol, int limit) {
-    if (limit != 5 && limit != 10 && limit != 20 && limit != 50 &&
-        limit != 100 && limit != 500 && limit != 1000) {
-        qDebug() << "Invalid limit. Valid limits are: 5, 10, 20, 50, 100, 500, 1000";
+    if (!checkLimit<binanceendpointid::Depth>(limit)) {
         return;
     }
+    QString flightKey = symbol + '|' + QString::number(limit);
+    if (joinInFlight(binanceendpointid::Depth, flightKey)) {
+        return;
+    }
+    traceEnqueue();
 
-    QUrl url("https://fapi.binance.com/fapi/v1/depth");
+    QUrl url = endpointUrl<binanceendpointid::Depth>(limit);
     QUrlQuery query;
     query.addQueryItem("symbol", symbol);
     query.addQueryItem("limit", QString::number(limit));
     url.setQuery(query);
 
     QNetworkRequest request(url);
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleDepthResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    trackInFlight(reply, binanceendpointid::Depth, flightKey);
+    watchReply(reply, "handleDepthResponse", &binanceapi::handleDepthResponse);
 }
 
 void binanceapi::handleDepthResponse(QNetworkReply* reply) {
+    QString symbol = QUrlQuery(reply->url()).queryItemValue("symbol");
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
+        emit depthRequestFailed(symbol);
     } else {
         QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
         QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Depth Info:" << jsonObject;
+        logReceived("Depth Info");
+        binancetypes::DepthSnapshotPtr snapshot;
+        if (isConnected(&binanceapi::depthSnapshotReceived)) {
+            snapshot = binancetypes::decodeDepth(symbol, jsonObject);
+        }
+        traceDecoded();
+        emit depthReceived(symbol, jsonObject);
+        if (snapshot) {
+            emit depthSnapshotReceived(snapshot);
+        }
     }
     reply->deleteLater();
 }
 void binanceapi::getRecentTrades(const QString& symbol, int limit) {
-    if (limit < 1 || limit > 1000) {
-        qDebug() << "Invalid limit. Valid limits are between 1 and 1000";
+    if (!checkLimit<binanceendpointid::RecentTrades>(limit)) {
         return;
     }
 
-    QUrl url("https://fapi.binance.com/fapi/v1/trades");
+    QUrl url = endpointUrl<binanceendpointid::RecentTrades>();
     QUrlQuery query;
     query.addQueryItem("symbol", symbol);
     query.addQueryItem("limit", QString::number(limit));
     url.setQuery(query);
 
     QNetworkRequest request(url);
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleRecentTradesResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handleRecentTradesResponse", &binanceapi::handleRecentTradesResponse);
 }
 
 void binanceapi::handleRecentTradesResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Recent Trades Info:" << jsonObject;
+        logReceived("Recent Trades Info");
     }
     reply->deleteLater();
 }
 
 void binanceapi::getHistoricalTrades(const QString& symbol, int limit, qint64 fromId) {
-    if (limit < 1 || limit > 1000) {
-        qDebug() << "Invalid limit. Valid limits are between 1 and 1000";
+    if (!checkLimit<binanceendpointid::HistoricalTrades>(limit)) {
         return;
     }
 
-    QUrl url("https://fapi.binance.com/fapi/v1/historicalTrades");
+    QUrl url = endpointUrl<binanceendpointid::HistoricalTrades>();
     QUrlQuery query;
     query.addQueryItem("symbol", symbol);
     query.addQueryItem("limit", QString::number(limit));
@@ -155,28 +617,25 @@ void binanceapi::getHistoricalTrades(const QString& symbol, int limit, qint64 fr
     url.setQuery(query);
 
     QNetworkRequest request(url);
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleHistoricalTradesResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handleHistoricalTradesResponse", &binanceapi::handleHistoricalTradesResponse);
 }
 
 void binanceapi::handleHistoricalTradesResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Historical Trades Info:" << jsonObject;
+        logReceived("Historical Trades Info");
     }
     reply->deleteLater();
 }
 
 void binanceapi::getAggregateTrades(const QString& symbol, qint64 fromId, qint64 startTime, qint64 endTime, int limit) {
-    if (limit < 1 || limit > 1000) {
-        qDebug() << "Invalid limit. Valid limits are between 1 and 1000";
+    if (!checkLimit<binanceendpointid::AggregateTrades>(limit)) {
         return;
     }
 
-    QUrl url("https://fapi.binance.com/fapi/v1/aggTrades");
+    QUrl url = endpointUrl<binanceendpointid::AggregateTrades>();
     QUrlQuery query;
     query.addQueryItem("symbol", symbol);
     query.addQueryItem("limit", QString::number(limit));
@@ -194,27 +653,24 @@ void binanceapi::getAggregateTrades(const QString& symbol, qint64 fromId, qint64
     url.setQuery(query);
 
     QNetworkRequest request(url);
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleAggregateTradesResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handleAggregateTradesResponse", &binanceapi::handleAggregateTradesResponse);
 }
 
 void binanceapi::handleAggregateTradesResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Aggregate Trades Info:" << jsonObject;
+        logReceived("Aggregate Trades Info");
     }
     reply->deleteLater();
 }
 void binanceapi::getKlines(const QString& symbol, const QString& interval, qint64 startTime, qint64 endTime, int limit) {
-    if (limit < 1 || limit > 1500) {
-        qDebug() << "Invalid limit. Valid limits are between 1 and 1500";
+    if (!checkLimit<binanceendpointid::Klines>(limit)) {
         return;
     }
 
-    QUrl url("https://fapi.binance.com/fapi/v1/klines");
+    QUrl url = endpointUrl<binanceendpointid::Klines>(limit);
     QUrlQuery query;
     query.addQueryItem("symbol", symbol);
     query.addQueryItem("interval", interval);
@@ -230,25 +686,30 @@ void binanceapi::getKlines(const QString& symbol, const QString& interval, qint6
     url.setQuery(query);
 
     QNetworkRequest request(url);
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleKlinesResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handleKlinesResponse", &binanceapi::handleKlinesResponse);
 }
 
 void binanceapi::handleKlinesResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
         QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
         if(!jsonResponse.isNull())
         {
                 emit snggetdatacandel(jsonResponse);
         }
+        if (jsonResponse.isArray() && isConnected(&binanceapi::klineBatchReceived)) {
+            QUrlQuery query(reply->url());
+            emit klineBatchReceived(binancetypes::decodeKlines("klines", query.queryItemValue("symbol"),
+                                                               query.queryItemValue("interval"), jsonResponse.array()));
+        }
     }
     reply->deleteLater();
 
 }
 void binanceapi::checkOrderStatus(const QString& symbol, qint64 orderId, const QString& origClientOrderId, qint64 recvWindow, qint64 timestamp) {
-    QUrl url("https://fapi.binance.com/fapi/v1/order");
+    QUrl url = endpointUrl<binanceendpointid::QueryOrder>();
     QUrlQuery query;
 
     query.addQueryItem("symbol", symbol);
@@ -265,32 +726,36 @@ void binanceapi::checkOrderStatus(const QString& symbol, qint64 orderId, const Q
         query.addQueryItem("timestamp", QString::number(timestamp));
     }
 
-    url.setQuery(query);
+    url.setQuery(QString::fromLatin1(encodeParams<binanceendpointid::QueryOrder>(query)));
 
     QNetworkRequest request(url);
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
 
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleCheckOrderStatusResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handleCheckOrderStatusResponse", &binanceapi::handleCheckOrderStatusResponse);
 }
 
 void binanceapi::handleCheckOrderStatusResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
+        QJsonObject error = QJsonDocument::fromJson(reply->readAll()).object();
+        int code = error.contains("code") ? error.value("code").toInt() : -int(reply->error());
+        emit orderStatusFailed(QUrlQuery(reply->url()).queryItemValue("origClientOrderId"), code,
+                               error.contains("msg") ? error.value("msg").toString() : reply->errorString());
     } else {
         QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
         QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Check Order Status Response:" << jsonObject;
+        logReceived("Check Order Status Response");
+        emit orderStatusReceived(jsonObject);
     }
     reply->deleteLater();
 }
 void binanceapi::getContinuousKlines(const QString& pair, const QString& contractType, const QString& interval, qint64 startTime, qint64 endTime, int limit) {
-    if (limit < 1 || limit > 1500) {
-        qDebug() << "Invalid limit. Valid limits are between 1 and 1500";
+    if (!checkLimit<binanceendpointid::ContinuousKlines>(limit)) {
         return;
     }
 
-    QUrl url("https://fapi.binance.com/fapi/v1/continuousKlines");
+    QUrl url = endpointUrl<binanceendpointid::ContinuousKlines>(limit);
     QUrlQuery query;
     query.addQueryItem("pair", pair);
     query.addQueryItem("contractType", contractType);
@@ -307,28 +772,31 @@ void binanceapi::getContinuousKlines(const QString& pair, const QString& contrac
     url.setQuery(query);
 
     QNetworkRequest request(url);
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleContinuousKlinesResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handleContinuousKlinesResponse", &binanceapi::handleContinuousKlinesResponse);
 }
 
 void binanceapi::handleContinuousKlinesResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
         QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Continuous Klines Info:" << jsonObject;
+        logReceived("Continuous Klines Info");
+        if (jsonResponse.isArray() && isConnected(&binanceapi::klineBatchReceived)) {
+            QUrlQuery query(reply->url());
+            emit klineBatchReceived(binancetypes::decodeKlines("continuousKlines", query.queryItemValue("pair"),
+                                                               query.queryItemValue("interval"), jsonResponse.array()));
+        }
     }
     reply->deleteLater();
 }
 
 void binanceapi::getIndexPriceKlines(const QString& pair, const QString& interval, qint64 startTime, qint64 endTime, int limit) {
-    if (limit < 1 || limit > 1500) {
-        qDebug() << "Invalid limit. Valid limits are between 1 and 1500";
+    if (!checkLimit<binanceendpointid::IndexPriceKlines>(limit)) {
         return;
     }
 
-    QUrl url("https://fapi.binance.com/fapi/v1/indexPriceKlines");
+    QUrl url = endpointUrl<binanceendpointid::IndexPriceKlines>(limit);
     QUrlQuery query;
     query.addQueryItem("pair", pair);
     query.addQueryItem("interval", interval);
@@ -344,27 +812,30 @@ void binanceapi::getIndexPriceKlines(const QString& pair, const QString& interva
     url.setQuery(query);
 
     QNetworkRequest request(url);
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleIndexPriceKlinesResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handleIndexPriceKlinesResponse", &binanceapi::handleIndexPriceKlinesResponse);
 }
 
 void binanceapi::handleIndexPriceKlinesResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
         QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Index Price Klines Info:" << jsonObject;
+        logReceived("Index Price Klines Info");
+        if (jsonResponse.isArray() && isConnected(&binanceapi::klineBatchReceived)) {
+            QUrlQuery query(reply->url());
+            emit klineBatchReceived(binancetypes::decodeKlines("indexPriceKlines", query.queryItemValue("pair"),
+                                                               query.queryItemValue("interval"), jsonResponse.array()));
+        }
     }
     reply->deleteLater();
 }
 void binanceapi::getMarkPriceKlines(const QString& symbol, const QString& interval, qint64 startTime, qint64 endTime, int limit) {
-    if (limit < 1 || limit > 1500) {
-        qDebug() << "Invalid limit. Valid limits are between 1 and 1500";
+    if (!checkLimit<binanceendpointid::MarkPriceKlines>(limit)) {
         return;
     }
 
-    QUrl url("https://fapi.binance.com/fapi/v1/markPriceKlines");
+    QUrl url = endpointUrl<binanceendpointid::MarkPriceKlines>(limit);
     QUrlQuery query;
     query.addQueryItem("symbol", symbol);
     query.addQueryItem("interval", interval);
@@ -380,22 +851,26 @@ void binanceapi::getMarkPriceKlines(const QString& symbol, const QString& interv
     url.setQuery(query);
 
     QNetworkRequest request(url);
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleMarkPriceKlinesResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handleMarkPriceKlinesResponse", &binanceapi::handleMarkPriceKlinesResponse);
 }
 
 void binanceapi::handleMarkPriceKlinesResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
         QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Mark Price Klines Info:" << jsonObject;
+        logReceived("Mark Price Klines Info");
+        if (jsonResponse.isArray() && isConnected(&binanceapi::klineBatchReceived)) {
+            QUrlQuery query(reply->url());
+            emit klineBatchReceived(binancetypes::decodeKlines("markPriceKlines", query.queryItemValue("symbol"),
+                                                               query.queryItemValue("interval"), jsonResponse.array()));
+        }
     }
     reply->deleteLater();
 }
 void binanceapi::getPremiumIndex(const QString& symbol) {
-    QUrl url("https://fapi.binance.com/fapi/v1/premiumIndex");
+    QUrl url = endpointUrl<binanceendpointid::PremiumIndex>(0, symbol.isEmpty());
     QUrlQuery query;
     if (!symbol.isEmpty()) {
         query.addQueryItem("symbol", symbol);
@@ -403,22 +878,24 @@ void binanceapi::getPremiumIndex(const QString& symbol) {
     url.setQuery(query);
 
     QNetworkRequest request(url);
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handlePremiumIndexResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handlePremiumIndexResponse", &binanceapi::handlePremiumIndexResponse);
 }
 
 void binanceapi::handlePremiumIndexResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
         QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Premium Index Info:" << jsonObject;
+        // A single symbol comes back as an object, the whole market as an array.
+        QJsonArray entries = jsonResponse.isArray() ? jsonResponse.array() : QJsonArray{jsonResponse.object()};
+        logReceived("Premium Index Info");
+        emit premiumIndexReceived(entries);
     }
     reply->deleteLater();
 }
 void binanceapi::getFundingRate(const QString& symbol, qint64 startTime, qint64 endTime, int limit) {
-    QUrl url("https://fapi.binance.com/fapi/v1/fundingRate");
+    QUrl url = endpointUrl<binanceendpointid::FundingRate>();
     QUrlQuery query;
     if (!symbol.isEmpty()) {
         query.addQueryItem("symbol", symbol);
@@ -429,28 +906,27 @@ void binanceapi::getFundingRate(const QString& symbol, qint64 startTime, qint64
     if (endTime >= 0) {
         query.addQueryItem("endTime", QString::number(endTime));
     }
-    if (limit > 0 && limit <= 1000) {
-        query.addQueryItem("limit", QString::number(limit));
-    }
+    addLimit<binanceendpointid::FundingRate>(query, limit);
     url.setQuery(query);
 
     QNetworkRequest request(url);
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleFundingRateResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handleFundingRateResponse", &binanceapi::handleFundingRateResponse);
 }
 
 void binanceapi::handleFundingRateResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Funding Rate Info:" << jsonObject;
+        logReceived("Funding Rate Info");
     }
     reply->deleteLater();
 }
 void binanceapi::get24hrTicker(const QString& symbol) {
-    QUrl url("https://fapi.binance.com/fapi/v1/ticker/24hr");
+    if (joinInFlight(binanceendpointid::Ticker24hr, symbol)) {
+        return;
+    }
+    QUrl url = endpointUrl<binanceendpointid::Ticker24hr>(0, symbol.isEmpty());
     QUrlQuery query;
     if (!symbol.isEmpty()) {
         query.addQueryItem("symbol", symbol);
@@ -458,22 +934,21 @@ void binanceapi::get24hrTicker(const QString& symbol) {
     url.setQuery(query);
 
     QNetworkRequest request(url);
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handle24hrTickerResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    trackInFlight(reply, binanceendpointid::Ticker24hr, symbol);
+    watchReply(reply, "handle24hrTickerResponse", &binanceapi::handle24hrTickerResponse);
 }
 
 void binanceapi::handle24hrTickerResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "24hr Ticker Info:" << jsonObject;
+        logReceived("24hr Ticker Info");
     }
     reply->deleteLater();
 }
 void binanceapi::getLatestPrice(const QString& symbol) {
-    QUrl url("https://fapi.binance.com/fapi/v1/ticker/price");
+    QUrl url = endpointUrl<binanceendpointid::LatestPrice>(0, symbol.isEmpty());
     QUrlQuery query;
     if (!symbol.isEmpty()) {
         query.addQueryItem("symbol", symbol);
@@ -481,22 +956,20 @@ void binanceapi::getLatestPrice(const QString& symbol) {
     url.setQuery(query);
 
     QNetworkRequest request(url);
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleLatestPriceResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handleLatestPriceResponse", &binanceapi::handleLatestPriceResponse);
 }
 
 void binanceapi::handleLatestPriceResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Latest Price Info:" << jsonObject;
+        logReceived("Latest Price Info");
     }
     reply->deleteLater();
 }
 void binanceapi::getBookTicker(const QString& symbol) {
-    QUrl url("https://fapi.binance.com/fapi/v1/ticker/bookTicker");
+    QUrl url = endpointUrl<binanceendpointid::BookTicker>(0, symbol.isEmpty());
     QUrlQuery query;
     if (!symbol.isEmpty()) {
         query.addQueryItem("symbol", symbol);
@@ -504,64 +977,58 @@ void binanceapi::getBookTicker(const QString& symbol) {
     url.setQuery(query);
 
     QNetworkRequest request(url);
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleBookTickerResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handleBookTickerResponse", &binanceapi::handleBookTickerResponse);
 }
 
 void binanceapi::handleBookTickerResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Book Ticker Info:" << jsonObject;
+        logReceived("Book Ticker Info");
     }
     reply->deleteLater();
 }
 void binanceapi::getOpenInterest(const QString& symbol) {
     if (symbol.isEmpty()) {
-        qDebug() << "Symbol is mandatory for open interest request";
+        logMessage(binancelogger::Warning, "Symbol is mandatory for open interest request");
         return;
     }
 
-    QUrl url("https://fapi.binance.com/fapi/v1/openInterest");
+    QUrl url = endpointUrl<binanceendpointid::OpenInterest>();
     QUrlQuery query;
     query.addQueryItem("symbol", symbol);
     url.setQuery(query);
 
     QNetworkRequest request(url);
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleOpenInterestResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handleOpenInterestResponse", &binanceapi::handleOpenInterestResponse);
 }
 
 void binanceapi::handleOpenInterestResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Open Interest Info:" << jsonObject;
+        logReceived("Open Interest Info");
     }
     reply->deleteLater();
 }
 void binanceapi::getOpenInterestHist(const QString& symbol, const QString& period, qint64 limit, qint64 startTime, qint64 endTime) {
     if (symbol.isEmpty()) {
-        qDebug() << "Symbol is mandatory for open interest history request";
+        logMessage(binancelogger::Warning, "Symbol is mandatory for open interest history request");
         return;
     }
 
     if (period.isEmpty()) {
-        qDebug() << "Period is mandatory for open interest history request";
+        logMessage(binancelogger::Warning, "Period is mandatory for open interest history request");
         return;
     }
 
-    QUrl url("https://fapi.binance.com/futures/data/openInterestHist");
+    QUrl url = endpointUrl<binanceendpointid::OpenInterestHist>();
     QUrlQuery query;
     query.addQueryItem("symbol", symbol);
     query.addQueryItem("period", period);
-    if (limit > 0 && limit <= 500) {
-        query.addQueryItem("limit", QString::number(limit));
-    }
+    addLimit<binanceendpointid::OpenInterestHist>(query, limit);
     if (startTime >= 0) {
         query.addQueryItem("startTime", QString::number(startTime));
     }
@@ -571,38 +1038,34 @@ void binanceapi::getOpenInterestHist(const QString& symbol, const QString& perio
     url.setQuery(query);
 
     QNetworkRequest request(url);
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleOpenInterestHistResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handleOpenInterestHistResponse", &binanceapi::handleOpenInterestHistResponse);
 }
 
 void binanceapi::handleOpenInterestHistResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Open Interest History Info:" << jsonObject;
+        logReceived("Open Interest History Info");
     }
     reply->deleteLater();
 }
 void binanceapi::getTopLongShortAccountRatio(const QString& symbol, const QString& period, qint64 limit, qint64 startTime, qint64 endTime) {
     if (symbol.isEmpty()) {
-        qDebug() << "Symbol is mandatory for top long short account ratio request";
+        logMessage(binancelogger::Warning, "Symbol is mandatory for top long short account ratio request");
         return;
     }
 
     if (period.isEmpty()) {
-        qDebug() << "Period is mandatory for top long short account ratio request";
+        logMessage(binancelogger::Warning, "Period is mandatory for top long short account ratio request");
         return;
     }
 
-    QUrl url("https://fapi.binance.com/futures/data/topLongShortAccountRatio");
+    QUrl url = endpointUrl<binanceendpointid::TopLongShortAccountRatio>();
     QUrlQuery query;
     query.addQueryItem("symbol", symbol);
     query.addQueryItem("period", period);
-    if (limit > 0 && limit <= 500) {
-        query.addQueryItem("limit", QString::number(limit));
-    }
+    addLimit<binanceendpointid::TopLongShortAccountRatio>(query, limit);
     if (startTime >= 0) {
         query.addQueryItem("startTime", QString::number(startTime));
     }
@@ -612,39 +1075,35 @@ void binanceapi::getTopLongShortAccountRatio(const QString& symbol, const QStrin
     url.setQuery(query);
 
     QNetworkRequest request(url);
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleTopLongShortAccountRatioResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handleTopLongShortAccountRatioResponse", &binanceapi::handleTopLongShortAccountRatioResponse);
 }
 
 void binanceapi::handleTopLongShortAccountRatioResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Top Long Short Account Ratio Info:" << jsonObject;
+        logReceived("Top Long Short Account Ratio Info");
     }
     reply->deleteLater();
 }
 
 void binanceapi::getTopLongShortPositionRatio(const QString& symbol, const QString& period, qint64 limit, qint64 startTime, qint64 endTime) {
     if (symbol.isEmpty()) {
-        qDebug() << "Symbol is mandatory for top long short position ratio request";
+        logMessage(binancelogger::Warning, "Symbol is mandatory for top long short position ratio request");
         return;
     }
 
     if (period.isEmpty()) {
-        qDebug() << "Period is mandatory for top long short position ratio request";
+        logMessage(binancelogger::Warning, "Period is mandatory for top long short position ratio request");
         return;
     }
 
-    QUrl url("https://fapi.binance.com/futures/data/topLongShortPositionRatio");
+    QUrl url = endpointUrl<binanceendpointid::TopLongShortPositionRatio>();
     QUrlQuery query;
     query.addQueryItem("symbol", symbol);
     query.addQueryItem("period", period);
-    if (limit > 0 && limit <= 500) {
-        query.addQueryItem("limit", QString::number(limit));
-    }
+    addLimit<binanceendpointid::TopLongShortPositionRatio>(query, limit);
     if (startTime >= 0) {
         query.addQueryItem("startTime", QString::number(startTime));
     }
@@ -654,38 +1113,34 @@ void binanceapi::getTopLongShortPositionRatio(const QString& symbol, const QStri
     url.setQuery(query);
 
     QNetworkRequest request(url);
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleTopLongShortPositionRatioResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handleTopLongShortPositionRatioResponse", &binanceapi::handleTopLongShortPositionRatioResponse);
 }
 
 void binanceapi::handleTopLongShortPositionRatioResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Top Long Short Position Ratio Info:" << jsonObject;
+        logReceived("Top Long Short Position Ratio Info");
     }
     reply->deleteLater();
 }
 void binanceapi::getGlobalLongShortAccountRatio(const QString& symbol, const QString& period, qint64 limit, qint64 startTime, qint64 endTime) {
     if (symbol.isEmpty()) {
-        qDebug() << "Symbol is mandatory for global long short account ratio request";
+        logMessage(binancelogger::Warning, "Symbol is mandatory for global long short account ratio request");
         return;
     }
 
     if (period.isEmpty()) {
-        qDebug() << "Period is mandatory for global long short account ratio request";
+        logMessage(binancelogger::Warning, "Period is mandatory for global long short account ratio request");
         return;
     }
 
-    QUrl url("https://fapi.binance.com/futures/data/globalLongShortAccountRatio");
+    QUrl url = endpointUrl<binanceendpointid::GlobalLongShortAccountRatio>();
     QUrlQuery query;
     query.addQueryItem("symbol", symbol);
     query.addQueryItem("period", period);
-    if (limit > 0 && limit <= 500) {
-        query.addQueryItem("limit", QString::number(limit));
-    }
+    addLimit<binanceendpointid::GlobalLongShortAccountRatio>(query, limit);
     if (startTime >= 0) {
         query.addQueryItem("startTime", QString::number(startTime));
     }
@@ -695,38 +1150,34 @@ void binanceapi::getGlobalLongShortAccountRatio(const QString& symbol, const QSt
     url.setQuery(query);
 
     QNetworkRequest request(url);
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleGlobalLongShortAccountRatioResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handleGlobalLongShortAccountRatioResponse", &binanceapi::handleGlobalLongShortAccountRatioResponse);
 }
 
 void binanceapi::handleGlobalLongShortAccountRatioResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Global Long Short Account Ratio Info:" << jsonObject;
+        logReceived("Global Long Short Account Ratio Info");
     }
     reply->deleteLater();
 }
 void binanceapi::getTakerLongShortRatio(const QString& symbol, const QString& period, qint64 limit, qint64 startTime, qint64 endTime) {
     if (symbol.isEmpty()) {
-        qDebug() << "Symbol is mandatory for taker long short ratio request";
+        logMessage(binancelogger::Warning, "Symbol is mandatory for taker long short ratio request");
         return;
     }
 
     if (period.isEmpty()) {
-        qDebug() << "Period is mandatory for taker long short ratio request";
+        logMessage(binancelogger::Warning, "Period is mandatory for taker long short ratio request");
         return;
     }
 
-    QUrl url("https://fapi.binance.com/futures/data/takerlongshortRatio");
+    QUrl url = endpointUrl<binanceendpointid::TakerLongShortRatio>();
     QUrlQuery query;
     query.addQueryItem("symbol", symbol);
     query.addQueryItem("period", period);
-    if (limit > 0 && limit <= 500) {
-        query.addQueryItem("limit", QString::number(limit));
-    }
+    addLimit<binanceendpointid::TakerLongShortRatio>(query, limit);
     if (startTime >= 0) {
         query.addQueryItem("startTime", QString::number(startTime));
     }
@@ -736,32 +1187,30 @@ void binanceapi::getTakerLongShortRatio(const QString& symbol, const QString& pe
     url.setQuery(query);
 
     QNetworkRequest request(url);
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleTakerLongShortRatioResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handleTakerLongShortRatioResponse", &binanceapi::handleTakerLongShortRatioResponse);
 }
 
 void binanceapi::handleTakerLongShortRatioResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Taker Long Short Ratio Info:" << jsonObject;
+        logReceived("Taker Long Short Ratio Info");
     }
     reply->deleteLater();
 }
 void binanceapi::getLvtKlines(const QString& symbol, const QString& interval, qint64 startTime, qint64 endTime, int limit) {
     if (symbol.isEmpty()) {
-        qDebug() << "Symbol is mandatory for LVT klines request";
+        logMessage(binancelogger::Warning, "Symbol is mandatory for LVT klines request");
         return;
     }
 
     if (interval.isEmpty()) {
-        qDebug() << "Interval is mandatory for LVT klines request";
+        logMessage(binancelogger::Warning, "Interval is mandatory for LVT klines request");
         return;
     }
 
-    QUrl url("https://fapi.binance.com/fapi/v1/lvtKlines");
+    QUrl url = endpointUrl<binanceendpointid::LvtKlines>();
     QUrlQuery query;
     query.addQueryItem("symbol", symbol);
     query.addQueryItem("interval", interval);
@@ -771,28 +1220,28 @@ void binanceapi::getLvtKlines(const QString& symbol, const QString& interval, qi
     if (endTime >= 0) {
         query.addQueryItem("endTime", QString::number(endTime));
     }
-    if (limit > 0 && limit <= 1000) {
-        query.addQueryItem("limit", QString::number(limit));
-    }
+    addLimit<binanceendpointid::LvtKlines>(query, limit);
     url.setQuery(query);
 
     QNetworkRequest request(url);
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleLvtKlinesResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handleLvtKlinesResponse", &binanceapi::handleLvtKlinesResponse);
 }
 
 void binanceapi::handleLvtKlinesResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "LVT Klines Info:" << jsonObject;
+        logReceived("LVT Klines Info");
     }
     reply->deleteLater();
 }
 void binanceapi::getIndexInfo(const QString& symbol) {
-    QUrl url("https://fapi.binance.com/fapi/v1/indexInfo");
+    if (answerFromCache(binanceendpointid::IndexInfo, symbol, "handleIndexInfoResponse", &binanceapi::handleIndexInfoResponse,
+                        [=]() { getIndexInfo(symbol); })) {
+        return;
+    }
+    QUrl url = endpointUrl<binanceendpointid::IndexInfo>();
     QUrlQuery query;
     if (!symbol.isEmpty()) {
         query.addQueryItem("symbol", symbol);
@@ -800,23 +1249,27 @@ void binanceapi::getIndexInfo(const QString& symbol) {
     url.setQuery(query);
 
     QNetworkRequest request(url);
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleIndexInfoResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    if (!cacheReply(reply, binanceendpointid::IndexInfo, symbol)) {
+        watchReply(reply, "handleIndexInfoResponse", &binanceapi::handleIndexInfoResponse);
+    }
 }
 
 void binanceapi::handleIndexInfoResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Index Info:" << jsonObject;
+        logReceived("Index Info");
     }
     reply->deleteLater();
 }
 
 void binanceapi::getAssetIndex(const QString& symbol) {
-    QUrl url("https://fapi.binance.com/fapi/v1/assetIndex");
+    if (answerFromCache(binanceendpointid::AssetIndex, symbol, "handleAssetIndexResponse", &binanceapi::handleAssetIndexResponse,
+                        [=]() { getAssetIndex(symbol); })) {
+        return;
+    }
+    QUrl url = endpointUrl<binanceendpointid::AssetIndex>(0, symbol.isEmpty());
     QUrlQuery query;
     if (!symbol.isEmpty()) {
         query.addQueryItem("symbol", symbol);
@@ -824,53 +1277,59 @@ void binanceapi::getAssetIndex(const QString& symbol) {
     url.setQuery(query);
 
     QNetworkRequest request(url);
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleAssetIndexResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    if (!cacheReply(reply, binanceendpointid::AssetIndex, symbol)) {
+        watchReply(reply, "handleAssetIndexResponse", &binanceapi::handleAssetIndexResponse);
+    }
 }
 
 void binanceapi::handleAssetIndexResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Asset Index Info:" << jsonObject;
+        logReceived("Asset Index Info");
     }
     reply->deleteLater();
 }
 
 
 void binanceapi::changePositionMode(bool dualSidePosition, qint64 recvWindow, qint64 timestamp) {
-    QString dualSidePositionStr = dualSidePosition ? "true" : "false";
-    QString timestampStr = QString::number(timestamp);
-    QByteArray payload = QString("dualSidePosition=%1&recvWindow=%2&timestamp=%3").arg(dualSidePositionStr, QString::number(recvWindow), timestampStr).toUtf8();
+    QUrlQuery query;
+    query.addQueryItem("dualSidePosition", dualSidePosition ? "true" : "false");
+    if (recvWindow >= 0) {
+        query.addQueryItem("recvWindow", QString::number(recvWindow));
+    }
+    if (timestamp >= 0) {
+        query.addQueryItem("timestamp", QString::number(timestamp));
+    }
+    QByteArray payload = encodeParams<binanceendpointid::ChangePositionMode>(query);
 
-    QUrl url("https://fapi.binance.com/fapi/v1/positionSide/dual");
+    QUrl url = endpointUrl<binanceendpointid::ChangePositionMode>();
     QNetworkRequest request(url);
 
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
     request.setRawHeader("Content-Type", "application/x-www-form-urlencoded");
 
-    QByteArray signature = QMessageAuthenticationCode::hash(payload, apiSecret.toUtf8(), QCryptographicHash::Sha256).toHex();
-    request.setRawHeader("signature", signature);
-
-    QNetworkReply* reply = networkManager.post(request, payload);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleChangePositionModeResponse(reply); });
+    QNetworkReply* reply = networkManager->post(request, payload);
+    watchReply(reply, "handleChangePositionModeResponse", &binanceapi::handleChangePositionModeResponse);
 }
 
 void binanceapi::handleChangePositionModeResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Change Position Mode Response:" << jsonObject;
+        logReceived("Change Position Mode Response");
+        responseCache.invalidate(binanceendpointid::PositionMode);
     }
     reply->deleteLater();
 }
 
 void binanceapi::getPositionMode(qint64 recvWindow, qint64 timestamp) {
-    QUrl url("https://fapi.binance.com/fapi/v1/positionSide/dual");
+    if (answerFromCache(binanceendpointid::PositionMode, QString(), "handlePositionModeResponse", &binanceapi::handlePositionModeResponse,
+                        [=]() { getPositionMode(recvWindow, timestamp >= 0 ? QDateTime::currentMSecsSinceEpoch() : timestamp); })) {
+        return;
+    }
+    QUrl url = endpointUrl<binanceendpointid::PositionMode>();
     QUrlQuery query;
     if (recvWindow >= 0) {
         query.addQueryItem("recvWindow", QString::number(recvWindow));
@@ -878,128 +1337,175 @@ void binanceapi::getPositionMode(qint64 recvWindow, qint64 timestamp) {
     if (timestamp >= 0) {
         query.addQueryItem("timestamp", QString::number(timestamp));
     }
-    url.setQuery(query);
+    url.setQuery(QString::fromLatin1(encodeParams<binanceendpointid::PositionMode>(query)));
 
     QNetworkRequest request(url);
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
 
-    QByteArray signature = QMessageAuthenticationCode::hash(url.toEncoded(), apiSecret.toUtf8(), QCryptographicHash::Sha256).toHex();
-    request.setRawHeader("signature", signature);
-
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handlePositionModeResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    if (!cacheReply(reply, binanceendpointid::PositionMode, QString())) {
+        watchReply(reply, "handlePositionModeResponse", &binanceapi::handlePositionModeResponse);
+    }
 }
 
 void binanceapi::handlePositionModeResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Position Mode Response:" << jsonObject;
+        logReceived("Position Mode Response");
     }
     reply->deleteLater();
 }
 void binanceapi::changeMultiAssetsMode(bool multiAssetsMargin, qint64 recvWindow, qint64 timestamp) {
-    QString multiAssetsMarginStr = multiAssetsMargin ? "true" : "false";
-    QString timestampStr = QString::number(timestamp);
-    QByteArray payload = QString("multiAssetsMargin=%1&recvWindow=%2&timestamp=%3").arg(multiAssetsMarginStr, QString::number(recvWindow), timestampStr).toUtf8();
+    QUrlQuery query;
+    query.addQueryItem("multiAssetsMargin", multiAssetsMargin ? "true" : "false");
+    if (recvWindow >= 0) {
+        query.addQueryItem("recvWindow", QString::number(recvWindow));
+    }
+    if (timestamp >= 0) {
+        query.addQueryItem("timestamp", QString::number(timestamp));
+    }
+    QByteArray payload = encodeParams<binanceendpointid::ChangeMultiAssetsMode>(query);
 
-    QUrl url("https://fapi.binance.com/fapi/v1/multiAssetsMargin");
+    QUrl url = endpointUrl<binanceendpointid::ChangeMultiAssetsMode>();
     QNetworkRequest request(url);
 
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
     request.setRawHeader("Content-Type", "application/x-www-form-urlencoded");
 
-    QByteArray signature = QMessageAuthenticationCode::hash(payload, apiSecret.toUtf8(), QCryptographicHash::Sha256).toHex();
-    request.setRawHeader("signature", signature);
-
-    QNetworkReply* reply = networkManager.post(request, payload);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleChangeMultiAssetsModeResponse(reply); });
+    QNetworkReply* reply = networkManager->post(request, payload);
+    watchReply(reply, "handleChangeMultiAssetsModeResponse", &binanceapi::handleChangeMultiAssetsModeResponse);
 }
 
 void binanceapi::handleChangeMultiAssetsModeResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Change Multi-Assets Mode Response:" << jsonObject;
+        logReceived("Change Multi-Assets Mode Response");
     }
     reply->deleteLater();
 }
-void binanceapi::sendNewOrder(const QString& symbol, const QString& side, const QString& positionSide, const QString& type,
-                              const QString& timeInForce, const QString& quantity, const QString& reduceOnly,
-                              const QString& price, const QString& newClientOrderId, const QString& stopPrice,
-                              const QString& closePosition, const QString& activationPrice, const QString& callbackRate,
-                              const QString& workingType, const QString& priceProtect, const QString& newOrderRespType,
-                              qint64 recvWindow, qint64 timestamp) {
-    QUrl url("https://fapi.binance.com/fapi/v1/order");
-    QNetworkRequest request(url);
-
-    request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
-    request.setRawHeader("Content-Type", "application/x-www-form-urlencoded");
-
-    QUrlQuery query;
-    query.addQueryItem("symbol", symbol);
-    query.addQueryItem("side", side);
+QList<QPair<QString, QString>> binanceapi::newOrderParams(const QString& symbol, const QString& side, const QString& positionSide, const QString& type,
+                                                          const QString& timeInForce, const QString& quantity, const QString& reduceOnly,
+                                                          const QString& price, const QString& newClientOrderId, const QString& stopPrice,
+                                                          const QString& closePosition, const QString& activationPrice, const QString& callbackRate,
+                                                          const QString& workingType, const QString& priceProtect, const QString& newOrderRespType) const {
+    QList<QPair<QString, QString>> params;
+    params.append(qMakePair(QString("symbol"), symbol));
+    params.append(qMakePair(QString("side"), side));
     if (!positionSide.isEmpty()) {
-        query.addQueryItem("positionSide", positionSide);
+        params.append(qMakePair(QString("positionSide"), positionSide));
     }
-    query.addQueryItem("type", type);
+    params.append(qMakePair(QString("type"), type));
     if (!timeInForce.isEmpty()) {
-        query.addQueryItem("timeInForce", timeInForce);
+        params.append(qMakePair(QString("timeInForce"), timeInForce));
     }
     if (!quantity.isEmpty()) {
-        query.addQueryItem("quantity", quantity);
+        params.append(qMakePair(QString("quantity"), quantity));
     }
     if (!reduceOnly.isEmpty()) {
-        query.addQueryItem("reduceOnly", reduceOnly);
+        params.append(qMakePair(QString("reduceOnly"), reduceOnly));
     }
     if (!price.isEmpty()) {
-        query.addQueryItem("price", price);
+        params.append(qMakePair(QString("price"), price));
     }
     if (!newClientOrderId.isEmpty()) {
-        query.addQueryItem("newClientOrderId", newClientOrderId);
+        params.append(qMakePair(QString("newClientOrderId"), newClientOrderId));
     }
     if (!stopPrice.isEmpty()) {
-        query.addQueryItem("stopPrice", stopPrice);
+        params.append(qMakePair(QString("stopPrice"), stopPrice));
     }
     if (!closePosition.isEmpty()) {
-        query.addQueryItem("closePosition", closePosition);
+        params.append(qMakePair(QString("closePosition"), closePosition));
     }
     if (!activationPrice.isEmpty()) {
-        query.addQueryItem("activationPrice", activationPrice);
+        params.append(qMakePair(QString("activationPrice"), activationPrice));
     }
     if (!callbackRate.isEmpty()) {
-        query.addQueryItem("callbackRate", callbackRate);
+        params.append(qMakePair(QString("callbackRate"), callbackRate));
     }
     if (!workingType.isEmpty()) {
-        query.addQueryItem("workingType", workingType);
+        params.append(qMakePair(QString("workingType"), workingType));
     }
     if (!priceProtect.isEmpty()) {
-        query.addQueryItem("priceProtect", priceProtect);
+        params.append(qMakePair(QString("priceProtect"), priceProtect));
     }
     if (!newOrderRespType.isEmpty()) {
-        query.addQueryItem("newOrderRespType", newOrderRespType);
+        params.append(qMakePair(QString("newOrderRespType"), newOrderRespType));
+    }
+    return params;
+}
+
+QString binanceapi::sendNewOrder(const QString& symbol, const QString& side, const QString& positionSide, const QString& type,
+                                 const QString& timeInForce, const QString& quantity, const QString& reduceOnly,
+                                 const QString& price, const QString& newClientOrderId, const QString& stopPrice,
+                                 const QString& closePosition, const QString& activationPrice, const QString& callbackRate,
+                                 const QString& workingType, const QString& priceProtect, const QString& newOrderRespType,
+                                 qint64 recvWindow, qint64 timestamp) {
+    // Batch results and failures are routed by clientOrderId only, so a batched order always has one.
+    const QString clientOrderId = newClientOrderId.isEmpty() && orderBatchWindowUs > 0
+                                      ? QString::fromLatin1(batchClientIds.next()) : newClientOrderId;
+    const QList<QPair<QString, QString>> params = newOrderParams(symbol, side, positionSide, type, timeInForce, quantity, reduceOnly, price,
+                                                                 clientOrderId, stopPrice, closePosition, activationPrice, callbackRate,
+                                                                 workingType, priceProtect, newOrderRespType);
+    if (validator && !validateOrder(symbol, side, type, price, quantity, reduceOnly, clientOrderId)) {
+        return clientOrderId;
+    }
+    traceEnqueue();
+    if (orderBatchWindowUs > 0) {
+        QJsonObject order;
+        for (const QPair<QString, QString>& item : params) {
+            order.insert(item.first, item.second);
+        }
+        queueBatchedOrder(order, recvWindow);
+        return clientOrderId;
     }
-    url.setQuery(query);
 
-    QByteArray payload = url.toEncoded(QUrl::RemoveScheme | QUrl::RemoveAuthority);
+    QUrl url = endpointUrl<binanceendpointid::NewOrder>();
+    QNetworkRequest request(url);
+
+    request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
+    request.setRawHeader("Content-Type", "application/x-www-form-urlencoded");
+
+    QUrlQuery query;
+    query.setQueryItems(params);
+    if (recvWindow >= 0) {
+        query.addQueryItem("recvWindow", QString::number(recvWindow));
+    }
+    if (timestamp >= 0) {
+        query.addQueryItem("timestamp", QString::number(timestamp));
+    }
+    QByteArray payload = encodeParams<binanceendpointid::NewOrder>(query);
 
-    request.setRawHeader("signature", QMessageAuthenticationCode::hash(payload, apiSecret.toUtf8() , QCryptographicHash::Sha256).toHex());
+    QNetworkReply* reply = networkManager->post(request, payload);
+    reply->setProperty("clientOrderId", clientOrderId);
+    watchReply(reply, "handleNewOrderResponse", &binanceapi::handleNewOrderResponse);
+    return clientOrderId;
+}
 
-    QNetworkReply* reply = networkManager.post(request, payload);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleNewOrderResponse(reply); });
+void binanceapi::postSignedOrder(const QNetworkRequest& request, const QByteArray& payload, const QString& clientOrderId) {
+    QNetworkReply* reply = networkManager->post(request, payload);
+    reply->setProperty("clientOrderId", clientOrderId);
+    watchReply(reply, "handleNewOrderResponse", &binanceapi::handleNewOrderResponse);
 }
 
 void binanceapi::handleNewOrderResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
+        emitOrderFailure(reply, reply->readAll());
     } else {
         QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
         QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "New Order Response:" << jsonObject;
+        logReceived("New Order Response");
+        binancetypes::OrderAckPtr ack;
+        if (isConnected(&binanceapi::orderAckReceived)) {
+            ack = binancetypes::decodeOrderAck(jsonObject);
+        }
+        traceDecoded();
+        emit newOrderResponseReceived(jsonObject);
+        if (ack) {
+            emit orderAckReceived(ack);
+        }
     }
     reply->deleteLater();
 }
@@ -1007,7 +1513,8 @@ void binanceapi::handleNewOrderResponse(QNetworkReply* reply) {
 
 void binanceapi::modifyOrder(qint64 orderId, const QString& origClientOrderId, const QString& symbol, const QString& side,
                              const QString& quantity, const QString& price, qint64 recvWindow, qint64 timestamp) {
-    QUrl url("https://fapi.binance.com/fapi/v1/order");
+    traceEnqueue();
+    QUrl url = endpointUrl<binanceendpointid::ModifyOrder>();
     QUrlQuery query;
 
     if (orderId >= 0) {
@@ -1027,34 +1534,63 @@ void binanceapi::modifyOrder(qint64 orderId, const QString& origClientOrderId, c
         query.addQueryItem("timestamp", QString::number(timestamp));
     }
 
-    url.setQuery(query);
-
-    QByteArray payload = url.toEncoded(QUrl::RemoveScheme | QUrl::RemoveAuthority);
+    QByteArray payload = encodeParams<binanceendpointid::ModifyOrder>(query);
 
     QNetworkRequest request(url);
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
     request.setRawHeader("Content-Type", "application/x-www-form-urlencoded");
-    request.setRawHeader("signature", QMessageAuthenticationCode::hash(payload, apiSecret.toUtf8(), QCryptographicHash::Sha256).toHex());
 
-    QNetworkReply* reply = networkManager.put(request, payload);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleModifyOrderResponse(reply); });
+    QNetworkReply* reply = networkManager->put(request, payload);
+    reply->setProperty("clientOrderId", origClientOrderId);
+    watchReply(reply, "handleModifyOrderResponse", &binanceapi::handleModifyOrderResponse);
 }
 
 void binanceapi::handleModifyOrderResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
+        emitOrderFailure(reply, reply->readAll());
     } else {
         QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
         QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Modify Order Response:" << jsonObject;
+        logReceived("Modify Order Response");
+        binancetypes::OrderAckPtr ack;
+        if (isConnected(&binanceapi::orderAckReceived)) {
+            ack = binancetypes::decodeOrderAck(jsonObject);
+        }
+        traceDecoded();
+        emit modifyOrderResponseReceived(jsonObject);
+        if (ack) {
+            emit orderAckReceived(ack);
+        }
     }
     reply->deleteLater();
 }
-void binanceapi::batchOrders(const QJsonArray& orderList, qint64 recvWindow, qint64 timestamp) {
-    QUrl url("https://fapi.binance.com/fapi/v1/batchOrders");
+void binanceapi::batchOrders(const QJsonArray& orderList, qint64 recvWindow, qint64 timestamp) {
+    if (validator) {
+        QJsonArray accepted;
+        for (const QJsonValue& value : orderList) {
+            QJsonObject order = value.toObject();
+            if (validateOrder(order.value("symbol").toString(), order.value("side").toString(), order.value("type").toString(),
+                              order.value("price").toString(), order.value("quantity").toString(),
+                              order.value("reduceOnly").toString(), order.value("newClientOrderId").toString())) {
+                accepted.append(order);
+            }
+        }
+        if (!accepted.isEmpty()) {
+            traceEnqueue();
+            sendBatchOrders(accepted, recvWindow, timestamp);
+        }
+        return;
+    }
+    traceEnqueue();
+    sendBatchOrders(orderList, recvWindow, timestamp);
+}
+
+void binanceapi::sendBatchOrders(const QJsonArray& orderList, qint64 recvWindow, qint64 timestamp) {
+    QUrl url = endpointUrl<binanceendpointid::BatchOrders>();
     QUrlQuery query;
 
-    query.addQueryItem("batchOrders", QJsonDocument(orderList).toJson());
+    query.addQueryItem("batchOrders", QJsonDocument(orderList).toJson(QJsonDocument::Compact));
     if (recvWindow >= 0) {
         query.addQueryItem("recvWindow", QString::number(recvWindow));
     }
@@ -1062,34 +1598,99 @@ void binanceapi::batchOrders(const QJsonArray& orderList, qint64 recvWindow, qin
         query.addQueryItem("timestamp", QString::number(timestamp));
     }
 
-    url.setQuery(query);
-
-    QByteArray payload = url.toEncoded(QUrl::RemoveScheme | QUrl::RemoveAuthority);
+    QByteArray payload = encodeParams<binanceendpointid::BatchOrders>(query);
 
     QNetworkRequest request(url);
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
     request.setRawHeader("Content-Type", "application/x-www-form-urlencoded");
-    request.setRawHeader("signature", QMessageAuthenticationCode::hash(payload, apiSecret.toUtf8(), QCryptographicHash::Sha256).toHex());
 
-    QNetworkReply* reply = networkManager.post(request, payload);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleBatchOrdersResponse(reply); });
+    // Results come back in submission order; keep the ids to route them.
+    QStringList clientOrderIds;
+    for (const QJsonValue& order : orderList) {
+        clientOrderIds.append(order.toObject().value("newClientOrderId").toString());
+    }
+
+    QNetworkReply* reply = networkManager->post(request, payload);
+    reply->setProperty("clientOrderIds", clientOrderIds);
+    watchReply(reply, "handleBatchOrdersResponse", &binanceapi::handleBatchOrdersResponse);
 }
 
 void binanceapi::handleBatchOrdersResponse(QNetworkReply* reply) {
+    const QStringList clientOrderIds = reply->property("clientOrderIds").toStringList();
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
+        QJsonObject error = QJsonDocument::fromJson(reply->readAll()).object();
+        int code = error.contains("code") ? error.value("code").toInt() : -int(reply->error());
+        QString message = error.contains("msg") ? error.value("msg").toString() : reply->errorString();
+        for (const QString& clientOrderId : clientOrderIds) {
+            emit orderRequestFailed(clientOrderId, code, message);
+        }
     } else {
         QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Batch Orders Response:" << jsonObject;
+        QJsonArray results = jsonResponse.array();
+        logReceived("Batch Orders Response");
+        traceDecoded();
+        for (int i = 0; i < results.size(); ++i) {
+            QJsonObject result = results.at(i).toObject();
+            if (result.contains("code") && !result.contains("orderId")) {
+                emit orderRequestFailed(clientOrderIds.value(i), result.value("code").toInt(), result.value("msg").toString());
+            } else {
+                emit newOrderResponseReceived(result);
+                if (isConnected(&binanceapi::orderAckReceived)) {
+                    emit orderAckReceived(binancetypes::decodeOrderAck(result));
+                }
+            }
+        }
     }
     reply->deleteLater();
 }
+
+void binanceapi::setOrderBatchWindow(int microseconds) {
+    orderBatchWindowUs = qMax(0, microseconds);
+    if (orderBatchWindowUs == 0) {
+        flushOrderBatch();
+    }
+}
+
+void binanceapi::queueBatchedOrder(const QJsonObject& order, qint64 recvWindow) {
+    // One recvWindow per batch request: a different one starts a new batch.
+    if (!orderBatch.isEmpty() && recvWindow != orderBatchRecvWindow) {
+        qint64 enqueueNs = traceEnqueueNs;
+        flushOrderBatch();
+        traceEnqueueNs = enqueueNs;
+    }
+    if (orderBatch.isEmpty()) {
+        orderBatchRecvWindow = recvWindow;
+        // The batch window counts as queueing time of the batch request.
+        orderBatchEnqueueNs = traceEnqueueNs;
+        // Qt timers are millisecond based: windows under 1ms flush on the
+        // next event loop pass, which still coalesces a tight submit loop.
+        orderBatchTimer.start(orderBatchWindowUs / 1000);
+    }
+    orderBatch.append(order);
+    traceEnqueueNs = -1;
+    if (orderBatch.size() >= maxBatchOrders) {
+        flushOrderBatch();
+    }
+}
+
+void binanceapi::flushOrderBatch() {
+    orderBatchTimer.stop();
+    while (!orderBatch.isEmpty()) {
+        QJsonArray orderList;
+        while (!orderBatch.isEmpty() && orderList.size() < maxBatchOrders) {
+            orderList.append(orderBatch.takeFirst());
+        }
+        traceEnqueueNs = orderBatchEnqueueNs;
+        sendBatchOrders(orderList, orderBatchRecvWindow, QDateTime::currentMSecsSinceEpoch());
+    }
+}
 void binanceapi::batchModifyOrders(const QJsonArray& orderList, qint64 recvWindow, qint64 timestamp) {
-    QUrl url("https://fapi.binance.com/fapi/v1/batchOrders");
+    traceEnqueue();
+    QUrl url = endpointUrl<binanceendpointid::BatchModifyOrders>();
     QUrlQuery query;
 
-    query.addQueryItem("batchOrders", QJsonDocument(orderList).toJson());
+    query.addQueryItem("batchOrders", QJsonDocument(orderList).toJson(QJsonDocument::Compact));
     if (recvWindow >= 0) {
         query.addQueryItem("recvWindow", QString::number(recvWindow));
     }
@@ -1097,32 +1698,56 @@ void binanceapi::batchModifyOrders(const QJsonArray& orderList, qint64 recvWindo
         query.addQueryItem("timestamp", QString::number(timestamp));
     }
 
-    url.setQuery(query);
-
-    QByteArray payload = url.toEncoded(QUrl::RemoveScheme | QUrl::RemoveAuthority);
+    QByteArray payload = encodeParams<binanceendpointid::BatchModifyOrders>(query);
 
     QNetworkRequest request(url);
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
     request.setRawHeader("Content-Type", "application/x-www-form-urlencoded");
-    request.setRawHeader("signature", QMessageAuthenticationCode::hash(payload, apiSecret.toUtf8(), QCryptographicHash::Sha256).toHex());
 
-    QNetworkReply* reply = networkManager.put(request, payload);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleBatchModifyOrdersResponse(reply); });
+    QStringList clientOrderIds;
+    for (const QJsonValue& order : orderList) {
+        clientOrderIds.append(order.toObject().value("origClientOrderId").toString());
+    }
+
+    QNetworkReply* reply = networkManager->put(request, payload);
+    reply->setProperty("clientOrderIds", clientOrderIds);
+    watchReply(reply, "handleBatchModifyOrdersResponse", &binanceapi::handleBatchModifyOrdersResponse);
 }
 
 void binanceapi::handleBatchModifyOrdersResponse(QNetworkReply* reply) {
+    const QStringList clientOrderIds = reply->property("clientOrderIds").toStringList();
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
+        QJsonObject error = QJsonDocument::fromJson(reply->readAll()).object();
+        int code = error.contains("code") ? error.value("code").toInt() : -int(reply->error());
+        QString message = error.contains("msg") ? error.value("msg").toString() : reply->errorString();
+        for (const QString& clientOrderId : clientOrderIds) {
+            emit orderRequestFailed(clientOrderId, code, message);
+        }
     } else {
         QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Batch Modify Orders Response:" << jsonObject;
+        QJsonArray results = jsonResponse.array();
+        logReceived("Batch Modify Orders Response");
+        for (int i = 0; i < results.size(); ++i) {
+            QJsonObject result = results.at(i).toObject();
+            if (result.contains("code") && !result.contains("orderId")) {
+                emit orderRequestFailed(clientOrderIds.value(i), result.value("code").toInt(), result.value("msg").toString());
+            } else {
+                emit modifyOrderResponseReceived(result);
+                if (isConnected(&binanceapi::orderAckReceived)) {
+                    emit orderAckReceived(binancetypes::decodeOrderAck(result));
+                }
+            }
+        }
     }
     reply->deleteLater();
 }
 
 void binanceapi::getOrderAmendmentHistory(const QString& symbol, qint64 orderId, const QString& origClientOrderId, qint64 startTime, qint64 endTime, int limit, qint64 recvWindow, qint64 timestamp) {
-    QUrl url("https://fapi.binance.com/fapi/v1/orderAmendment");
+    if (limit > 0 && !checkLimit<binanceendpointid::OrderAmendmentHistory>(limit)) {
+        return;
+    }
+    QUrl url = endpointUrl<binanceendpointid::OrderAmendmentHistory>();
     QUrlQuery query;
 
     query.addQueryItem("symbol", symbol);
@@ -1148,27 +1773,26 @@ void binanceapi::getOrderAmendmentHistory(const QString& symbol, qint64 orderId,
         query.addQueryItem("timestamp", QString::number(timestamp));
     }
 
-    url.setQuery(query);
+    url.setQuery(QString::fromLatin1(encodeParams<binanceendpointid::OrderAmendmentHistory>(query)));
 
     QNetworkRequest request(url);
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
 
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleOrderAmendmentHistoryResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handleOrderAmendmentHistoryResponse", &binanceapi::handleOrderAmendmentHistoryResponse);
 }
 
 void binanceapi::handleOrderAmendmentHistoryResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Order Amendment History Response:" << jsonObject;
+        logReceived("Order Amendment History Response");
     }
     reply->deleteLater();
 }
 void binanceapi::cancelOrder(const QString& symbol, qint64 orderId, const QString& origClientOrderId, qint64 recvWindow, qint64 timestamp) {
-    QUrl url("https://fapi.binance.com/fapi/v1/order");
+    traceEnqueue();
+    QUrl url = endpointUrl<binanceendpointid::CancelOrder>();
     QUrlQuery query;
 
     query.addQueryItem("symbol", symbol);
@@ -1185,27 +1809,39 @@ void binanceapi::cancelOrder(const QString& symbol, qint64 orderId, const QStrin
         query.addQueryItem("timestamp", QString::number(timestamp));
     }
 
-    url.setQuery(query);
+    url.setQuery(QString::fromLatin1(encodeParams<binanceendpointid::CancelOrder>(query)));
 
     QNetworkRequest request(url);
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
 
-    QNetworkReply* reply = networkManager.deleteResource(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleCancelOrderResponse(reply); });
+    QNetworkReply* reply = networkManager->deleteResource(request);
+    reply->setProperty("clientOrderId", origClientOrderId);
+    watchReply(reply, "handleCancelOrderResponse", &binanceapi::handleCancelOrderResponse);
 }
 
 void binanceapi::handleCancelOrderResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
+        emitOrderFailure(reply, reply->readAll());
     } else {
         QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
         QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Cancel Order Response:" << jsonObject;
+        logReceived("Cancel Order Response");
+        binancetypes::OrderAckPtr ack;
+        if (isConnected(&binanceapi::orderAckReceived)) {
+            ack = binancetypes::decodeOrderAck(jsonObject);
+        }
+        traceDecoded();
+        emit cancelOrderResponseReceived(jsonObject);
+        if (ack) {
+            emit orderAckReceived(ack);
+        }
     }
     reply->deleteLater();
 }
 void binanceapi::cancelAllOpenOrders(const QString& symbol, qint64 recvWindow, qint64 timestamp) {
-    QUrl url("https://fapi.binance.com/fapi/v1/allOpenOrders");
+    traceEnqueue();
+    QUrl url = endpointUrl<binanceendpointid::CancelAllOpenOrders>();
     QUrlQuery query;
 
     query.addQueryItem("symbol", symbol);
@@ -1216,27 +1852,33 @@ void binanceapi::cancelAllOpenOrders(const QString& symbol, qint64 recvWindow, q
         query.addQueryItem("timestamp", QString::number(timestamp));
     }
 
-    url.setQuery(query);
+    url.setQuery(QString::fromLatin1(encodeParams<binanceendpointid::CancelAllOpenOrders>(query)));
 
     QNetworkRequest request(url);
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
 
-    QNetworkReply* reply = networkManager.deleteResource(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleCancelAllOpenOrdersResponse(reply); });
+    QNetworkReply* reply = networkManager->deleteResource(request);
+    reply->setProperty("symbol", symbol);
+    watchReply(reply, "handleCancelAllOpenOrdersResponse", &binanceapi::handleCancelAllOpenOrdersResponse);
 }
 
 void binanceapi::handleCancelAllOpenOrdersResponse(QNetworkReply* reply) {
+    QString symbol = reply->property("symbol").toString();
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
+        QJsonObject error = QJsonDocument::fromJson(reply->readAll()).object();
+        int code = error.contains("code") ? error.value("code").toInt() : -int(reply->error());
+        emit cancelAllOpenOrdersFailed(symbol, code, error.contains("msg") ? error.value("msg").toString() : reply->errorString());
     } else {
         QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
         QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Cancel All Open Orders Response:" << jsonObject;
+        logReceived("Cancel All Open Orders Response");
+        emit cancelAllOpenOrdersReceived(symbol, jsonObject);
     }
     reply->deleteLater();
 }
 void binanceapi::cancelBatchOrders(const QString& symbol, const QList<qint64>& orderIdList, const QList<QString>& origClientOrderIdList, qint64 recvWindow, qint64 timestamp) {
-    QUrl url("https://fapi.binance.com/fapi/v1/batchOrders");
+    QUrl url = endpointUrl<binanceendpointid::CancelBatchOrders>();
     QUrlQuery query;
 
     query.addQueryItem("symbol", symbol);
@@ -1264,27 +1906,25 @@ void binanceapi::cancelBatchOrders(const QString& symbol, const QList<qint64>& o
         query.addQueryItem("timestamp", QString::number(timestamp));
     }
 
-    url.setQuery(query);
+    url.setQuery(QString::fromLatin1(encodeParams<binanceendpointid::CancelBatchOrders>(query)));
 
     QNetworkRequest request(url);
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
 
-    QNetworkReply* reply = networkManager.deleteResource(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleCancelBatchOrdersResponse(reply); });
+    QNetworkReply* reply = networkManager->deleteResource(request);
+    watchReply(reply, "handleCancelBatchOrdersResponse", &binanceapi::handleCancelBatchOrdersResponse);
 }
 
 void binanceapi::handleCancelBatchOrdersResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Cancel Batch Orders Response:" << jsonObject;
+        logReceived("Cancel Batch Orders Response");
     }
     reply->deleteLater();
 }
 void binanceapi::countdownCancelAll(const QString& symbol, qint64 countdownTime, qint64 recvWindow, qint64 timestamp) {
-    QUrl url("https://fapi.binance.com/fapi/v1/countdownCancelAll");
+    QUrl url = endpointUrl<binanceendpointid::CountdownCancelAll>();
     QUrlQuery query;
 
     query.addQueryItem("symbol", symbol);
@@ -1299,23 +1939,30 @@ void binanceapi::countdownCancelAll(const QString& symbol, qint64 countdownTime,
 
     QNetworkRequest request(url);
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
+    request.setRawHeader("Content-Type", "application/x-www-form-urlencoded");
 
-    QNetworkReply* reply = networkManager.post(request, query.toString().toUtf8());
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleCountdownCancelAllResponse(reply); });
+    QNetworkReply* reply = networkManager->post(request, encodeParams<binanceendpointid::CountdownCancelAll>(query));
+    reply->setProperty("symbol", symbol);
+    watchReply(reply, "handleCountdownCancelAllResponse", &binanceapi::handleCountdownCancelAllResponse);
 }
 
 void binanceapi::handleCountdownCancelAllResponse(QNetworkReply* reply) {
+    QString symbol = reply->property("symbol").toString();
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
+        QJsonObject error = QJsonDocument::fromJson(reply->readAll()).object();
+        int code = error.contains("code") ? error.value("code").toInt() : -int(reply->error());
+        emit countdownCancelAllFailed(symbol, code, error.contains("msg") ? error.value("msg").toString() : reply->errorString());
     } else {
         QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
         QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Countdown Cancel All Response:" << jsonObject;
+        logReceived("Countdown Cancel All Response");
+        emit countdownCancelAllReceived(symbol, jsonObject);
     }
     reply->deleteLater();
 }
 void binanceapi::getOpenOrder(const QString& symbol, qint64 orderId, const QString& origClientOrderId, qint64 recvWindow, qint64 timestamp) {
-    QUrl url("https://fapi.binance.com/fapi/v1/openOrder");
+    QUrl url = endpointUrl<binanceendpointid::OpenOrder>();
     QUrlQuery query;
 
     query.addQueryItem("symbol", symbol);
@@ -1333,27 +1980,25 @@ void binanceapi::getOpenOrder(const QString& symbol, qint64 orderId, const QStri
         query.addQueryItem("timestamp", QString::number(timestamp));
     }
 
-    url.setQuery(query);
+    url.setQuery(QString::fromLatin1(encodeParams<binanceendpointid::OpenOrder>(query)));
 
     QNetworkRequest request(url);
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
 
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleOpenOrderResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handleOpenOrderResponse", &binanceapi::handleOpenOrderResponse);
 }
 
 void binanceapi::handleOpenOrderResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Open Order Response:" << jsonObject;
+        logReceived("Open Order Response");
     }
     reply->deleteLater();
 }
 void binanceapi::getOpenOrders(const QString& symbol, qint64 recvWindow, qint64 timestamp) {
-    QUrl url("https://fapi.binance.com/fapi/v1/openOrders");
+    QUrl url = endpointUrl<binanceendpointid::OpenOrders>(0, symbol.isEmpty());
     QUrlQuery query;
 
     if (!symbol.isEmpty()) {
@@ -1366,27 +2011,35 @@ void binanceapi::getOpenOrders(const QString& symbol, qint64 recvWindow, qint64
         query.addQueryItem("timestamp", QString::number(timestamp));
     }
 
-    url.setQuery(query);
+    url.setQuery(QString::fromLatin1(encodeParams<binanceendpointid::OpenOrders>(query)));
 
     QNetworkRequest request(url);
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
 
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleOpenOrdersResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handleOpenOrdersResponse", &binanceapi::handleOpenOrdersResponse);
 }
 
 void binanceapi::handleOpenOrdersResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
+        QJsonObject error = QJsonDocument::fromJson(reply->readAll()).object();
+        int code = error.contains("code") ? error.value("code").toInt() : -int(reply->error());
+        emit openOrdersFailed(QUrlQuery(reply->url()).queryItemValue("symbol"), code,
+                              error.contains("msg") ? error.value("msg").toString() : reply->errorString());
     } else {
         QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Open Orders Response:" << jsonObject;
+        QJsonArray orders = jsonResponse.array();
+        logReceived("Open Orders Response");
+        emit openOrdersReceived(QUrlQuery(reply->url()).queryItemValue("symbol"), orders);
     }
     reply->deleteLater();
 }
 void binanceapi::getAllOrders(const QString& symbol, qint64 orderId, qint64 startTime, qint64 endTime, int limit, qint64 recvWindow, qint64 timestamp) {
-    QUrl url("https://fapi.binance.com/fapi/v1/allOrders");
+    if (limit > 0 && !checkLimit<binanceendpointid::AllOrders>(limit)) {
+        return;
+    }
+    QUrl url = endpointUrl<binanceendpointid::AllOrders>();
     QUrlQuery query;
 
     query.addQueryItem("symbol", symbol);
@@ -1400,7 +2053,7 @@ void binanceapi::getAllOrders(const QString& symbol, qint64 orderId, qint64 star
     if (endTime >= 0) {
         query.addQueryItem("endTime", QString::number(endTime));
     }
-    if (limit >= 0) {
+    if (limit > 0) {
         query.addQueryItem("limit", QString::number(limit));
     }
     if (recvWindow >= 0) {
@@ -1410,28 +2063,26 @@ void binanceapi::getAllOrders(const QString& symbol, qint64 orderId, qint64 star
         query.addQueryItem("timestamp", QString::number(timestamp));
     }
 
-    url.setQuery(query);
+    url.setQuery(QString::fromLatin1(encodeParams<binanceendpointid::AllOrders>(query)));
 
     QNetworkRequest request(url);
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
 
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleAllOrdersResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handleAllOrdersResponse", &binanceapi::handleAllOrdersResponse);
 }
 
 void binanceapi::handleAllOrdersResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "All Orders Response:" << jsonObject;
+        logReceived("All Orders Response");
     }
     reply->deleteLater();
 }
 
 void binanceapi::getBalance(qint64 recvWindow, qint64 timestamp) {
-    QUrl url("https://fapi.binance.com/fapi/v2/balance");
+    QUrl url = endpointUrl<binanceendpointid::Balance>();
     QUrlQuery query;
 
     if (recvWindow >= 0) {
@@ -1441,27 +2092,28 @@ void binanceapi::getBalance(qint64 recvWindow, qint64 timestamp) {
         query.addQueryItem("timestamp", QString::number(timestamp));
     }
 
-    url.setQuery(query);
+    url.setQuery(QString::fromLatin1(encodeParams<binanceendpointid::Balance>(query)));
 
     QNetworkRequest request(url);
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
 
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleBalanceResponse(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handleBalanceResponse", &binanceapi::handleBalanceResponse);
 }
 
 void binanceapi::handleBalanceResponse(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Balance Response:" << jsonObject;
+        logReceived("Balance Response");
     }
     reply->deleteLater();
 }
 void binanceapi::getAccountInformation(qint64 recvWindow, qint64 timestamp) {
-    QUrl url("https://fapi.binance.com/fapi/v2/account");
+    if (joinInFlight(binanceendpointid::Account, QString())) {
+        return;
+    }
+    QUrl url = endpointUrl<binanceendpointid::Account>();
     QUrlQuery query;
 
     if (recvWindow >= 0) {
@@ -1471,27 +2123,30 @@ void binanceapi::getAccountInformation(qint64 recvWindow, qint64 timestamp) {
         query.addQueryItem("timestamp", QString::number(timestamp));
     }
 
-    url.setQuery(query);
+    url.setQuery(QString::fromLatin1(encodeParams<binanceendpointid::Account>(query)));
 
     QNetworkRequest request(url);
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
 
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleAccountInformation(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    trackInFlight(reply, binanceendpointid::Account, QString());
+    watchReply(reply, "handleAccountInformation", &binanceapi::handleAccountInformation);
 }
 
 void binanceapi::handleAccountInformation(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
+        QByteArray data = reply->readAll();
+        QJsonDocument jsonResponse = QJsonDocument::fromJson(data);
         QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Account Information:" << jsonObject;
+        logReceived("Account Information");
+        emit accountInformationReceived(data);
     }
     reply->deleteLater();
 }
 void binanceapi::changeLeverage(const QString& symbol, int leverage, qint64 recvWindow, qint64 timestamp) {
-    QUrl url("https://fapi.binance.com/fapi/v1/leverage");
+    QUrl url = endpointUrl<binanceendpointid::ChangeLeverage>();
     QUrlQuery query;
     query.addQueryItem("symbol", symbol);
     query.addQueryItem("leverage", QString::number(leverage));
@@ -1503,27 +2158,28 @@ void binanceapi::changeLeverage(const QString& symbol, int leverage, qint64 recv
         query.addQueryItem("timestamp", QString::number(timestamp));
     }
 
-    url.setQuery(query);
+    url.setQuery(QString::fromLatin1(encodeParams<binanceendpointid::ChangeLeverage>(query)));
 
     QNetworkRequest request(url);
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
 
-    QNetworkReply* reply = networkManager.post(request, QByteArray());
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleLeverageChange(reply); });
+    QNetworkReply* reply = networkManager->post(request, QByteArray());
+    watchReply(reply, "handleLeverageChange", &binanceapi::handleLeverageChange);
 }
 
 void binanceapi::handleLeverageChange(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
         QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
         QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Leverage Change Result:" << jsonObject;
+        logReceived("Leverage Change Result");
+        emit leverageChanged(jsonObject.value("symbol").toString(), jsonObject.value("leverage").toInt());
     }
     reply->deleteLater();
 }
 void binanceapi::changeMarginType(const QString& symbol, const QString& marginType, qint64 recvWindow, qint64 timestamp) {
-    QUrl url("https://fapi.binance.com/fapi/v1/marginType");
+    QUrl url = endpointUrl<binanceendpointid::ChangeMarginType>();
     QUrlQuery query;
     query.addQueryItem("symbol", symbol);
     query.addQueryItem("marginType", marginType);
@@ -1535,27 +2191,25 @@ void binanceapi::changeMarginType(const QString& symbol, const QString& marginTy
         query.addQueryItem("timestamp", QString::number(timestamp));
     }
 
-    url.setQuery(query);
+    url.setQuery(QString::fromLatin1(encodeParams<binanceendpointid::ChangeMarginType>(query)));
 
     QNetworkRequest request(url);
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
 
-    QNetworkReply* reply = networkManager.post(request, QByteArray());
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleMarginTypeChange(reply); });
+    QNetworkReply* reply = networkManager->post(request, QByteArray());
+    watchReply(reply, "handleMarginTypeChange", &binanceapi::handleMarginTypeChange);
 }
 
 void binanceapi::handleMarginTypeChange(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Margin Type Change Result:" << jsonObject;
+        logReceived("Margin Type Change Result");
     }
     reply->deleteLater();
 }
 void binanceapi::adjustPositionMargin(const QString& symbol, const QString& positionSide, double amount, int type, qint64 recvWindow, qint64 timestamp) {
-    QUrl url("https://fapi.binance.com/fapi/v1/positionMargin");
+    QUrl url = endpointUrl<binanceendpointid::PositionMargin>();
     QUrlQuery query;
     query.addQueryItem("symbol", symbol);
     if (!positionSide.isEmpty()) {
@@ -1571,27 +2225,28 @@ void binanceapi::adjustPositionMargin(const QString& symbol, const QString& posi
         query.addQueryItem("timestamp", QString::number(timestamp));
     }
 
-    url.setQuery(query);
+    url.setQuery(QString::fromLatin1(encodeParams<binanceendpointid::PositionMargin>(query)));
 
     QNetworkRequest request(url);
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
 
-    QNetworkReply* reply = networkManager.post(request, QByteArray());
-    connect(reply, &QNetworkReply::finished, this, [=]() { handlePositionMarginAdjustment(reply); });
+    QNetworkReply* reply = networkManager->post(request, QByteArray());
+    watchReply(reply, "handlePositionMarginAdjustment", &binanceapi::handlePositionMarginAdjustment);
 }
 
 void binanceapi::handlePositionMarginAdjustment(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Position Margin Adjustment Result:" << jsonObject;
+        logReceived("Position Margin Adjustment Result");
     }
     reply->deleteLater();
 }
 void binanceapi::getPositionMarginHistory(const QString& symbol, int type, qint64 startTime, qint64 endTime, int limit, qint64 recvWindow, qint64 timestamp) {
-    QUrl url("https://fapi.binance.com/fapi/v1/positionMargin/history");
+    if (limit > 0 && !checkLimit<binanceendpointid::PositionMarginHistory>(limit)) {
+        return;
+    }
+    QUrl url = endpointUrl<binanceendpointid::PositionMarginHistory>();
     QUrlQuery query;
     query.addQueryItem("symbol", symbol);
     if (type > 0) {
@@ -1613,27 +2268,25 @@ void binanceapi::getPositionMarginHistory(const QString& symbol, int type, qint6
         query.addQueryItem("timestamp", QString::number(timestamp));
     }
 
-    url.setQuery(query);
+    url.setQuery(QString::fromLatin1(encodeParams<binanceendpointid::PositionMarginHistory>(query)));
 
     QNetworkRequest request(url);
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
 
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handlePositionMarginHistory(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handlePositionMarginHistory", &binanceapi::handlePositionMarginHistory);
 }
 
 void binanceapi::handlePositionMarginHistory(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "Position Margin History Result:" << jsonObject;
+        logReceived("Position Margin History Result");
     }
     reply->deleteLater();
 }
 void binanceapi::getPositionRisk(const QString& symbol, qint64 recvWindow, qint64 timestamp) {
-    QUrl url("https://fapi.binance.com/fapi/v2/positionRisk");
+    QUrl url = endpointUrl<binanceendpointid::PositionRisk>();
     QUrlQuery query;
     if (!symbol.isEmpty()) {
         query.addQueryItem("symbol", symbol);
@@ -1645,34 +2298,44 @@ void binanceapi::getPositionRisk(const QString& symbol, qint64 recvWindow, qint6
         query.addQueryItem("timestamp", QString::number(timestamp));
     }
 
-    url.setQuery(query);
+    url.setQuery(QString::fromLatin1(encodeParams<binanceendpointid::PositionRisk>(query)));
 
     QNetworkRequest request(url);
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
 
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handlePositionRisk(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    reply->setProperty("symbol", symbol);
+    watchReply(reply, "handlePositionRisk", &binanceapi::handlePositionRisk);
 }
 
 void binanceapi::handlePositionRisk(QNetworkReply* reply) {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
+        QJsonObject error = QJsonDocument::fromJson(reply->readAll()).object();
+        int code = error.contains("code") ? error.value("code").toInt() : -int(reply->error());
+        emit positionRiskFailed(code, error.contains("msg") ? error.value("msg").toString() : reply->errorString());
     } else {
         QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        QJsonValue dataValue = jsonObject.value("data");
-        if (dataValue.isArray()) {
-            QJsonArray jsonArray = dataValue.toArray();
-            qDebug() << "Position Risk Result:" << jsonArray;
+        if (jsonResponse.isArray()) {
+            QJsonArray jsonArray = jsonResponse.array();
+            logReceived("Position Risk Result");
+            emit positionRiskReceived(jsonArray, reply->property("symbol").toString());
+            if (isConnected(&binanceapi::positionListReceived)) {
+                emit positionListReceived(binancetypes::decodePositions(jsonArray));
+            }
         } else {
-            qDebug() << "Invalid data format received.";
+            logMessage(binancelogger::Warning, "Invalid data format received.");
+            emit positionRiskFailed(0, "Invalid data format received.");
         }
     }
     reply->deleteLater();
 }
 void binanceapi::getUserTrades(const QString& symbol, qint64 orderId, qint64 startTime, qint64 endTime, qint64 fromId, int limit, qint64 recvWindow, qint64 timestamp)
 {
-    QUrl url("https://fapi.binance.com/fapi/v1/userTrades");
+    if (limit > 0 && !checkLimit<binanceendpointid::UserTrades>(limit)) {
+        return;
+    }
+    QUrl url = endpointUrl<binanceendpointid::UserTrades>();
 
     QUrlQuery query;
     query.addQueryItem("symbol", symbol);
@@ -1698,29 +2361,30 @@ void binanceapi::getUserTrades(const QString& symbol, qint64 orderId, qint64 sta
         query.addQueryItem("timestamp", QString::number(timestamp));
     }
 
-    url.setQuery(query);
+    url.setQuery(QString::fromLatin1(encodeParams<binanceendpointid::UserTrades>(query)));
 
     QNetworkRequest request(url);
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
 
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleUserTrades(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handleUserTrades", &binanceapi::handleUserTrades);
 }
 
 void binanceapi::handleUserTrades(QNetworkReply* reply)
 {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonArray tradesArray = jsonResponse.array();
-        qDebug() << "User Trades Result:" << tradesArray;
+        logReceived("User Trades Result");
     }
     reply->deleteLater();
 }
 void binanceapi::getIncome(const QString& symbol, const QString& incomeType, qint64 startTime, qint64 endTime, int limit, qint64 recvWindow, qint64 timestamp)
 {
-    QUrl url("https://fapi.binance.com/fapi/v1/income");
+    if (limit > 0 && !checkLimit<binanceendpointid::Income>(limit)) {
+        return;
+    }
+    QUrl url = endpointUrl<binanceendpointid::Income>();
 
     QUrlQuery query;
     if (!symbol.isEmpty()) {
@@ -1745,29 +2409,35 @@ void binanceapi::getIncome(const QString& symbol, const QString& incomeType, qin
         query.addQueryItem("timestamp", QString::number(timestamp));
     }
 
-    url.setQuery(query);
+    url.setQuery(QString::fromLatin1(encodeParams<binanceendpointid::Income>(query)));
 
     QNetworkRequest request(url);
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
 
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleIncome(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handleIncome", &binanceapi::handleIncome);
 }
 
 void binanceapi::handleIncome(QNetworkReply* reply)
 {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
         QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonArray incomeArray = jsonResponse.array();
-        qDebug() << "Income Result:" << incomeArray;
+        logReceived("Income Result");
+        if (jsonResponse.isArray() && isConnected(&binanceapi::incomeRecordsReceived)) {
+            emit incomeRecordsReceived(binancetypes::decodeIncome(jsonResponse.array()));
+        }
     }
     reply->deleteLater();
 }
 void binanceapi::getLeverageBracket(const QString& symbol, qint64 recvWindow, qint64 timestamp)
 {
-    QUrl url("https://fapi.binance.com/fapi/v1/leverageBracket");
+    if (answerFromCache(binanceendpointid::LeverageBracket, symbol, "handleLeverageBracket", &binanceapi::handleLeverageBracket,
+                        [=]() { getLeverageBracket(symbol, recvWindow, timestamp >= 0 ? QDateTime::currentMSecsSinceEpoch() : timestamp); })) {
+        return;
+    }
+    QUrl url = endpointUrl<binanceendpointid::LeverageBracket>();
 
     QUrlQuery query;
     if (!symbol.isEmpty()) {
@@ -1780,29 +2450,32 @@ void binanceapi::getLeverageBracket(const QString& symbol, qint64 recvWindow, qi
         query.addQueryItem("timestamp", QString::number(timestamp));
     }
 
-    url.setQuery(query);
+    url.setQuery(QString::fromLatin1(encodeParams<binanceendpointid::LeverageBracket>(query)));
 
     QNetworkRequest request(url);
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
 
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleLeverageBracket(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    if (!cacheReply(reply, binanceendpointid::LeverageBracket, symbol)) {
+        watchReply(reply, "handleLeverageBracket", &binanceapi::handleLeverageBracket);
+    }
 }
 
 void binanceapi::handleLeverageBracket(QNetworkReply* reply)
 {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonArray leverageBracketArray = jsonResponse.array();
-        qDebug() << "Leverage Bracket Result:" << leverageBracketArray;
+        QJsonDocument jsonResponse = replyDocument(reply);
+        QJsonArray leverageBracketArray = jsonResponse.isArray() ? jsonResponse.array() : QJsonArray{jsonResponse.object()};
+        logReceived("Leverage Bracket Result");
+        emit leverageBracketReceived(leverageBracketArray);
     }
     reply->deleteLater();
 }
 void binanceapi::getAdlQuantile(const QString& symbol, qint64 recvWindow, qint64 timestamp)
 {
-    QUrl url("https://fapi.binance.com/fapi/v1/adlQuantile");
+    QUrl url = endpointUrl<binanceendpointid::AdlQuantile>();
 
     QUrlQuery query;
     if (!symbol.isEmpty()) {
@@ -1815,29 +2488,30 @@ void binanceapi::getAdlQuantile(const QString& symbol, qint64 recvWindow, qint64
         query.addQueryItem("timestamp", QString::number(timestamp));
     }
 
-    url.setQuery(query);
+    url.setQuery(QString::fromLatin1(encodeParams<binanceendpointid::AdlQuantile>(query)));
 
     QNetworkRequest request(url);
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
 
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleAdlQuantile(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handleAdlQuantile", &binanceapi::handleAdlQuantile);
 }
 
 void binanceapi::handleAdlQuantile(QNetworkReply* reply)
 {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        qDebug() << "ADL Quantile Result:" << jsonObject;
+        logReceived("ADL Quantile Result");
     }
     reply->deleteLater();
 }
 void binanceapi::getForceOrders(const QString& symbol, const QString& autoCloseType, qint64 startTime, qint64 endTime, int limit, qint64 recvWindow, qint64 timestamp)
 {
-    QUrl url("https://fapi.binance.com/fapi/v1/forceOrders");
+    if (limit > 0 && !checkLimit<binanceendpointid::ForceOrders>(limit)) {
+        return;
+    }
+    QUrl url = endpointUrl<binanceendpointid::ForceOrders>(0, symbol.isEmpty());
 
     QUrlQuery query;
     if (!symbol.isEmpty()) {
@@ -1862,35 +2536,31 @@ void binanceapi::getForceOrders(const QString& symbol, const QString& autoCloseT
         query.addQueryItem("timestamp", QString::number(timestamp));
     }
 
-    url.setQuery(query);
+    url.setQuery(QString::fromLatin1(encodeParams<binanceendpointid::ForceOrders>(query)));
 
     QNetworkRequest request(url);
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
 
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleForceOrders(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    watchReply(reply, "handleForceOrders", &binanceapi::handleForceOrders);
 }
 
 void binanceapi::handleForceOrders(QNetworkReply* reply)
 {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        QJsonValue dataValue = jsonObject.value("data");
-        if (dataValue.isArray()) {
-            QJsonArray jsonArray = dataValue.toArray();
-            qDebug() << "Force Orders Result:" << jsonArray;
-        } else {
-            qDebug() << "Invalid data format received.";
-        }
+        logReceived("Force Orders Result");
     }
     reply->deleteLater();
 }
 void binanceapi::getApiTradingStatus(const QString& symbol, qint64 recvWindow, qint64 timestamp)
 {
-    QUrl url("https://fapi.binance.com/fapi/v1/apiTradingStatus");
+    if (answerFromCache(binanceendpointid::ApiTradingStatus, symbol, "handleApiTradingStatus", &binanceapi::handleApiTradingStatus,
+                        [=]() { getApiTradingStatus(symbol, recvWindow, timestamp >= 0 ? QDateTime::currentMSecsSinceEpoch() : timestamp); })) {
+        return;
+    }
+    QUrl url = endpointUrl<binanceendpointid::ApiTradingStatus>(0, symbol.isEmpty());
 
     QUrlQuery query;
     if (!symbol.isEmpty()) {
@@ -1903,66 +2573,60 @@ void binanceapi::getApiTradingStatus(const QString& symbol, qint64 recvWindow, q
         query.addQueryItem("timestamp", QString::number(timestamp));
     }
 
-    url.setQuery(query);
+    url.setQuery(QString::fromLatin1(encodeParams<binanceendpointid::ApiTradingStatus>(query)));
 
     QNetworkRequest request(url);
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
 
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleApiTradingStatus(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    if (!cacheReply(reply, binanceendpointid::ApiTradingStatus, symbol)) {
+        watchReply(reply, "handleApiTradingStatus", &binanceapi::handleApiTradingStatus);
+    }
 }
 
 void binanceapi::handleApiTradingStatus(QNetworkReply* reply)
 {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        QJsonValue dataValue = jsonObject.value("data");
-        if (dataValue.isArray()) {
-            QJsonArray jsonArray = dataValue.toArray();
-            qDebug() << "API Trading Status Result:" << jsonArray;
-        } else {
-            qDebug() << "Invalid data format received.";
-        }
+        logReceived("API Trading Status Result");
     }
     reply->deleteLater();
 }
 void binanceapi::getCommissionRate(const QString& symbol, qint64 recvWindow, qint64 timestamp)
 {
-    QUrl url("https://fapi.binance.com/fapi/v1/commissionRate");
+    if (answerFromCache(binanceendpointid::CommissionRate, symbol, "handleCommissionRate", &binanceapi::handleCommissionRate,
+                        [=]() { getCommissionRate(symbol, recvWindow, timestamp >= 0 ? QDateTime::currentMSecsSinceEpoch() : timestamp); })) {
+        return;
+    }
+    QUrl url = endpointUrl<binanceendpointid::CommissionRate>();
 
     QUrlQuery query;
     query.addQueryItem("symbol", symbol);
     if (recvWindow >= 0) {
         query.addQueryItem("recvWindow", QString::number(recvWindow));
     }
-    query.addQueryItem("timestamp", QString::number(timestamp));
+    if (timestamp >= 0) {
+        query.addQueryItem("timestamp", QString::number(timestamp));
+    }
 
-    url.setQuery(query);
+    url.setQuery(QString::fromLatin1(encodeParams<binanceendpointid::CommissionRate>(query)));
 
     QNetworkRequest request(url);
     request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
 
-    QNetworkReply* reply = networkManager.get(request);
-    connect(reply, &QNetworkReply::finished, this, [=]() { handleCommissionRate(reply); });
+    QNetworkReply* reply = networkManager->get(request);
+    if (!cacheReply(reply, binanceendpointid::CommissionRate, symbol)) {
+        watchReply(reply, "handleCommissionRate", &binanceapi::handleCommissionRate);
+    }
 }
 
 void binanceapi::handleCommissionRate(QNetworkReply* reply)
 {
     if (reply->error()) {
-        qDebug() << "There was an error with the request:" << reply->errorString();
+        logReplyError(reply);
     } else {
-        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject jsonObject = jsonResponse.object();
-        QJsonValue dataValue = jsonObject.value("data");
-        if (dataValue.isObject()) {
-            QJsonObject dataObject = dataValue.toObject();
-            qDebug() << "Commission Rate Result:" << dataObject;
-        } else {
-            qDebug() << "Invalid data format received.";
-        }
+        logReceived("Commission Rate Result");
     }
     reply->deleteLater();
 }
@@ -1970,81 +2634,505 @@ void binanceapi::handleCommissionRate(QNetworkReply* reply)
 
 void binanceapi::createUserDataStream()
 {
-    QNetworkRequest request(QUrl("https://fapi.binance.com/fapi/v1/listenKey"));
-    QNetworkReply *reply = networkManager.post(request, QByteArray());
-    connect(reply, &QNetworkReply::finished, this, &binanceapi::onCreateUserDataStreamFinished);
+    QNetworkRequest request(endpointUrl<binanceendpointid::CreateListenKey>());
+    request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
+    QNetworkReply *reply = networkManager->post(request, QByteArray());
+    watchReply(reply, "onCreateUserDataStreamFinished", &binanceapi::onCreateUserDataStreamFinished);
 }
 
 void binanceapi::extendUserDataStream(const QString &listenKey)
 {
-    QUrl url("https://fapi.binance.com/fapi/v1/listenKey");
+    QUrl url = endpointUrl<binanceendpointid::ExtendListenKey>();
     QUrlQuery query;
     query.addQueryItem("listenKey", listenKey);
     url.setQuery(query);
 
     QNetworkRequest request(url);
-    QNetworkReply *reply = networkManager.put(request, QByteArray());
-    connect(reply, &QNetworkReply::finished, this, &binanceapi::onExtendUserDataStreamFinished);
+    request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
+    QNetworkReply *reply = networkManager->put(request, QByteArray());
+    watchReply(reply, "onExtendUserDataStreamFinished", &binanceapi::onExtendUserDataStreamFinished);
 }
 
 void binanceapi::closeUserDataStream(const QString &listenKey)
 {
-    QUrl url("https://fapi.binance.com/fapi/v1/listenKey");
+    QUrl url = endpointUrl<binanceendpointid::CloseListenKey>();
     QUrlQuery query;
     query.addQueryItem("listenKey", listenKey);
     url.setQuery(query);
 
     QNetworkRequest request(url);
-    QNetworkReply *reply = networkManager.deleteResource(request);
-    connect(reply, &QNetworkReply::finished, this, &binanceapi::onCloseUserDataStreamFinished);
+    request.setRawHeader("X-MBX-APIKEY", apiKey.toUtf8());
+    QNetworkReply *reply = networkManager->deleteResource(request);
+    watchReply(reply, "onCloseUserDataStreamFinished", &binanceapi::onCloseUserDataStreamFinished);
 }
 
-void binanceapi::onCreateUserDataStreamFinished()
+void binanceapi::onCreateUserDataStreamFinished(QNetworkReply *reply)
 {
-    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
     if (reply->error() == QNetworkReply::NoError)
     {
         QByteArray responseData = reply->readAll();
         QJsonDocument jsonDoc = QJsonDocument::fromJson(responseData);
         QString listenKey = jsonDoc.object().value("listenKey").toString();
-        qDebug() << "User Data Stream created. Listen Key:" << listenKey;
+        logMessage(binancelogger::Info, "User Data Stream created. Listen Key:", 0, listenKey);
+        emit listenKeyReceived(listenKey);
+        if (userStreamRequested) {
+            openUserStream(listenKey);
+        }
     }
     else
     {
-        qDebug() << "Error creating User Data Stream:" << reply->errorString();
+        logMessage(binancelogger::Warning, "Error creating User Data Stream:", reply->error(), reply->errorString());
     }
     reply->deleteLater();
 }
 
-void binanceapi::onExtendUserDataStreamFinished()
+void binanceapi::onExtendUserDataStreamFinished(QNetworkReply *reply)
 {
-    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
     if (reply->error() == QNetworkReply::NoError)
     {
-        qDebug() << "User Data Stream extended successfully.";
+        logMessage(binancelogger::Info, "User Data Stream extended successfully.");
     }
     else
     {
-        qDebug() << "Error extending User Data Stream:" << reply->errorString();
+        logMessage(binancelogger::Warning, "Error extending User Data Stream:", reply->error(), reply->errorString());
     }
     reply->deleteLater();
 }
 
-void binanceapi::onCloseUserDataStreamFinished()
+void binanceapi::onCloseUserDataStreamFinished(QNetworkReply *reply)
 {
-    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
     if (reply->error() == QNetworkReply::NoError)
     {
-        qDebug() << "User Data Stream closed successfully.";
+        logMessage(binancelogger::Info, "User Data Stream closed successfully.");
     }
     else
     {
-        qDebug() << "Error closing User Data Stream:" << reply->errorString();
+        logMessage(binancelogger::Warning, "Error closing User Data Stream:", reply->error(), reply->errorString());
     }
     reply->deleteLater();
 }
 
 
+void binanceapi::openUserStream(const QString& listenKey)
+{
+    userStreamRequested = true;
+    if (listenKey.isEmpty()) {
+        createUserDataStream();
+        return;
+    }
+    userStreamListenKey = listenKey;
+    userStream.open(QUrl(streamBaseUrl + "/ws/" + listenKey));
+    // Listen keys expire after 60 minutes without a keepalive.
+    userStreamKeepAlive.start(30 * 60 * 1000);
+}
+
+void binanceapi::closeUserStream()
+{
+    userStreamRequested = false;
+    userStreamKeepAlive.stop();
+    userStream.close();
+    if (!userStreamListenKey.isEmpty()) {
+        closeUserDataStream(userStreamListenKey);
+        userStreamListenKey.clear();
+    }
+}
+
+void binanceapi::onUserStreamDisconnected()
+{
+    logMessage(binancelogger::Info, "User data stream disconnected:", 0, userStream.closeReason());
+    if (metrics) {
+        metrics->recordDisconnect(metricSeries(binancemetrics::UserStream, "user"));
+    }
+    emit userStreamDisconnected();
+}
+
+void binanceapi::handleUserStreamMessage(const QString& message)
+{
+    if (recorder) {
+        recorder->recordFrame("handleUserStreamMessage", message);
+    }
+    binancetracer* trace = tracer && tracer->sample() ? tracer : nullptr;
+    qint64 traceStartNs = trace ? trace->now() : 0;
+    qint64 receiveUs = latency ? binancelatency::nowUs() : 0;
+    QJsonObject event = QJsonDocument::fromJson(message.toUtf8()).object();
+    qint64 decodedNs = trace ? trace->now() : 0;
+    QString type = event.value("e").toString();
+    if (latency) {
+        binancelatency::recordStreamEvent(latencyStream(userStreamHistograms, "user/", type), event, receiveUs);
+    }
+    if (metrics) {
+        metrics->recordMessage(metricSeries(binancemetrics::UserStream, type), message.size());
+    }
+    if (type == "listenKeyExpired") {
+        logMessage(binancelogger::Warning, "User data stream listen key expired.");
+        userStreamKeepAlive.stop();
+        userStream.close();
+        createUserDataStream();
+        return;
+    }
+    emit userStreamEventReceived(event);
+    if (trace) {
+        traceMessage(trace, "handleUserStreamMessage", traceStartNs, traceStartNs, decodedNs);
+    }
+}
+
+void binanceapi::subscribeMarketStreams(const QStringList& streams)
+{
+    QStringList added;
+    for (const QString& stream : streams) {
+        if (!marketStreamSubscriptions.contains(stream)) {
+            marketStreamSubscriptions.append(stream);
+            added.append(stream);
+        }
+    }
+    if (marketStream.state() == QAbstractSocket::UnconnectedState) {
+        marketStream.open(QUrl(streamBaseUrl + "/stream"));
+    } else if (!added.isEmpty() && marketStream.state() == QAbstractSocket::ConnectedState) {
+        sendMarketStreamRequest("SUBSCRIBE", added);
+    }
+}
+
+void binanceapi::unsubscribeMarketStreams(const QStringList& streams)
+{
+    QStringList removed;
+    for (const QString& stream : streams) {
+        if (marketStreamSubscriptions.removeAll(stream) > 0) {
+            removed.append(stream);
+        }
+    }
+    if (marketStreamSubscriptions.isEmpty()) {
+        marketStreamReconnect.stop();
+        marketStream.close();
+    } else if (!removed.isEmpty() && marketStream.state() == QAbstractSocket::ConnectedState) {
+        sendMarketStreamRequest("UNSUBSCRIBE", removed);
+    }
+}
+
+void binanceapi::sendMarketStreamRequest(const QString& method, const QStringList& streams)
+{
+    QJsonObject request;
+    request.insert("method", method);
+    request.insert("params", QJsonArray::fromStringList(streams));
+    request.insert("id", qint64(++marketStreamNextId));
+    marketStream.sendTextMessage(QString::fromUtf8(QJsonDocument(request).toJson(QJsonDocument::Compact)));
+}
+
+void binanceapi::onMarketStreamConnected()
+{
+    logMessage(binancelogger::Info, "Market stream connected.");
+    marketStreamBackoffMs = 0;
+    if (!marketStreamSubscriptions.isEmpty()) {
+        sendMarketStreamRequest("SUBSCRIBE", marketStreamSubscriptions);
+    }
+    emit marketStreamConnected();
+}
+
+void binanceapi::onMarketStreamDisconnected()
+{
+    logMessage(binancelogger::Info, "Market stream disconnected:", 0, marketStream.closeReason());
+    if (metrics) {
+        metrics->recordDisconnect(metricSeries(binancemetrics::MarketStream, "stream"));
+    }
+    // A failed reconnect lands here too, so the backoff grows until one succeeds.
+    if (!marketStreamSubscriptions.isEmpty() && !marketStreamReconnect.isActive()) {
+        marketStreamBackoffMs = marketStreamBackoffMs > 0 ? qMin(marketStreamBackoffMs * 2, 60000) : 500;
+        marketStreamReconnect.start(marketStreamBackoffMs);
+    }
+    emit marketStreamDisconnected();
+}
+
+void binanceapi::reconnectMarketStream()
+{
+    if (!marketStreamSubscriptions.isEmpty() && marketStream.state() == QAbstractSocket::UnconnectedState) {
+        logMessage(binancelogger::Info, "Reconnecting market stream, backoff ms:", marketStreamBackoffMs);
+        marketStream.open(QUrl(streamBaseUrl + "/stream"));
+    }
+}
+
+void binanceapi::handleMarketStreamMessage(const QString& message)
+{
+    if (recorder) {
+        recorder->recordFrame("handleMarketStreamMessage", message);
+    }
+    binancetracer* trace = tracer && tracer->sample() ? tracer : nullptr;
+    qint64 traceStartNs = trace ? trace->now() : 0;
+    qint64 receiveUs = latency ? binancelatency::nowUs() : 0;
+    QJsonObject jsonObject = QJsonDocument::fromJson(message.toUtf8()).object();
+    qint64 decodedNs = trace ? trace->now() : 0;
+    if (jsonObject.contains("stream")) {
+        QString stream = jsonObject.value("stream").toString();
+        QJsonValue data = jsonObject.value("data");
+        if (latency) {
+            const binancelatency::Stream histograms = latencyStream(marketStreamHistograms, "", stream);
+            if (data.isArray()) {
+                for (const QJsonValue& event : data.toArray()) {
+                    binancelatency::recordStreamEvent(histograms, event.toObject(), receiveUs);
+                }
+            } else {
+                binancelatency::recordStreamEvent(histograms, data.toObject(), receiveUs);
+            }
+        }
+        if (metrics) {
+            metrics->recordMessage(metricSeries(binancemetrics::MarketStream, stream), message.size());
+        }
+        emit marketStreamEventReceived(stream, data);
+        if (trace) {
+            traceMessage(trace, "handleMarketStreamMessage", traceStartNs, traceStartNs, decodedNs);
+        }
+    } else if (jsonObject.contains("error")) {
+        logMessage(binancelogger::Warning, "Market stream error:", jsonObject.value("error").toObject().value("code").toInt(),
+                   QString::fromUtf8(QJsonDocument(jsonObject).toJson(QJsonDocument::Compact)));
+    }
+}
+
+void binanceapi::emitOrderFailure(QNetworkReply* reply, const QByteArray& data)
+{
+    QJsonObject error = QJsonDocument::fromJson(data).object();
+    int code = error.contains("code") ? error.value("code").toInt() : -int(reply->error());
+    QString message = error.contains("msg") ? error.value("msg").toString() : reply->errorString();
+    emit orderRequestFailed(reply->property("clientOrderId").toString(), code, message);
+}
+
+void binanceapi::openWebSocketApi()
+{
+    if (webSocketApi.state() != QAbstractSocket::UnconnectedState) {
+        return;
+    }
+    webSocketApi.open(QUrl(webSocketApiUrl));
+}
+
+void binanceapi::closeWebSocketApi()
+{
+    webSocketApi.close();
+}
+
+void binanceapi::setWebSocketApiTimeout(int ms)
+{
+    webSocketApiTimeoutMs = qMax(1, ms);
+}
+
+QString binanceapi::wsSendNewOrder(const QString& symbol, const QString& side, const QString& positionSide, const QString& type,
+                                   const QString& timeInForce, const QString& quantity, const QString& reduceOnly,
+                                   const QString& price, const QString& newClientOrderId, const QString& stopPrice,
+                                   const QString& closePosition, const QString& activationPrice, const QString& callbackRate,
+                                   const QString& workingType, const QString& priceProtect, const QString& newOrderRespType,
+                                   qint64 recvWindow, qint64 timestamp)
+{
+    if (validator && !validateOrder(symbol, side, type, price, quantity, reduceOnly, newClientOrderId)) {
+        return QString();
+    }
+    QJsonObject params;
+    const QList<QPair<QString, QString>> items = newOrderParams(symbol, side, positionSide, type, timeInForce, quantity, reduceOnly, price,
+                                                                newClientOrderId, stopPrice, closePosition, activationPrice, callbackRate,
+                                                                workingType, priceProtect, newOrderRespType);
+    for (const QPair<QString, QString>& item : items) {
+        params.insert(item.first, item.second);
+    }
+    if (recvWindow >= 0) {
+        params.insert("recvWindow", recvWindow);
+    }
+    if (timestamp >= 0) {
+        params.insert("timestamp", timestamp);
+    }
+    return sendWebSocketApiRequest("order.place", params, newClientOrderId);
+}
+
+QString binanceapi::wsModifyOrder(qint64 orderId, const QString& origClientOrderId, const QString& symbol, const QString& side,
+                                  const QString& quantity, const QString& price, qint64 recvWindow, qint64 timestamp)
+{
+    QJsonObject params;
+    if (orderId >= 0) {
+        params.insert("orderId", orderId);
+    }
+    if (!origClientOrderId.isEmpty()) {
+        params.insert("origClientOrderId", origClientOrderId);
+    }
+    params.insert("symbol", symbol);
+    params.insert("side", side);
+    params.insert("quantity", quantity);
+    params.insert("price", price);
+    if (recvWindow >= 0) {
+        params.insert("recvWindow", recvWindow);
+    }
+    if (timestamp >= 0) {
+        params.insert("timestamp", timestamp);
+    }
+    return sendWebSocketApiRequest("order.modify", params, origClientOrderId);
+}
+
+QString binanceapi::wsCancelOrder(const QString& symbol, qint64 orderId, const QString& origClientOrderId, qint64 recvWindow, qint64 timestamp)
+{
+    QJsonObject params;
+    params.insert("symbol", symbol);
+    if (orderId >= 0) {
+        params.insert("orderId", orderId);
+    }
+    if (!origClientOrderId.isEmpty()) {
+        params.insert("origClientOrderId", origClientOrderId);
+    }
+    if (recvWindow >= 0) {
+        params.insert("recvWindow", recvWindow);
+    }
+    if (timestamp >= 0) {
+        params.insert("timestamp", timestamp);
+    }
+    return sendWebSocketApiRequest("order.cancel", params, origClientOrderId);
+}
+
+QString binanceapi::sendWebSocketApiRequest(const QString& method, QJsonObject params, const QString& clientOrderId)
+{
+    // The websocket api signs the alphabetically sorted parameter list, which
+    // is the order QJsonObject already iterates its keys in.
+    params.insert("apiKey", apiKey);
+    if (!params.contains("timestamp")) {
+        params.insert("timestamp", QDateTime::currentMSecsSinceEpoch());
+    }
+
+    QStringList payload;
+    for (auto it = params.constBegin(); it != params.constEnd(); ++it) {
+        const QJsonValue value = it.value();
+        payload << it.key() + "=" + (value.isString() ? value.toString() : QString::number(value.toVariant().toLongLong()));
+    }
+    params.insert("signature", QString::fromLatin1(signature(payload.join("&").toUtf8(), apiSecret.toUtf8())));
+
+    QString id = QString::number(++webSocketApiNextId);
+    QJsonObject request;
+    request.insert("id", id);
+    request.insert("method", method);
+    request.insert("params", params);
+
+    WebSocketApiRequest pending{method, clientOrderId, binancelatency::nowUs(),
+                                tracer && tracer->sample() ? tracer->now() : -1, QString()};
+    QString message = QString::fromUtf8(QJsonDocument(request).toJson(QJsonDocument::Compact));
+    if (webSocketApi.state() == QAbstractSocket::ConnectedState) {
+        webSocketApi.sendTextMessage(message);
+    } else {
+        pending.message = message;
+        webSocketApiBacklog.append(id);
+        openWebSocketApi();
+    }
+    webSocketApiPending.insert(id, pending);
+    if (!webSocketApiTimer.isActive()) {
+        webSocketApiTimer.start(webSocketApiTimeoutMs);
+    }
+    return id;
+}
+
+void binanceapi::failWebSocketApiRequests(int code, const QString& message)
+{
+    // Queued requests go with the pending ones: a request reported as failed
+    // must not be placed by a later reconnect.
+    for (auto it = webSocketApiPending.constBegin(); it != webSocketApiPending.constEnd(); ++it) {
+        emit orderRequestFailed(it.value().clientOrderId, code, message);
+    }
+    webSocketApiPending.clear();
+    webSocketApiBacklog.clear();
+    webSocketApiTimer.stop();
+}
+
+void binanceapi::expireWebSocketApiRequests()
+{
+    qint64 now = binancelatency::nowUs();
+    qint64 timeoutUs = qint64(webSocketApiTimeoutMs) * 1000;
+    qint64 nextDeadlineUs = -1;
+    for (auto it = webSocketApiPending.begin(); it != webSocketApiPending.end();) {
+        qint64 deadlineUs = it.value().sentUs + timeoutUs;
+        if (deadlineUs > now) {
+            nextDeadlineUs = nextDeadlineUs < 0 ? deadlineUs : qMin(nextDeadlineUs, deadlineUs);
+            ++it;
+            continue;
+        }
+        // A late answer is then logged as unknown; a queued frame is never sent.
+        logMessage(binancelogger::Warning, "WebSocket API request timed out:", 0, it.value().method);
+        webSocketApiBacklog.removeOne(it.key());
+        QString clientOrderId = it.value().clientOrderId;
+        it = webSocketApiPending.erase(it);
+        emit orderRequestFailed(clientOrderId, -1007, "Timeout waiting for response");
+    }
+    if (nextDeadlineUs >= 0) {
+        webSocketApiTimer.start(int((nextDeadlineUs - now + 999) / 1000));
+    }
+}
+
+void binanceapi::onWebSocketApiConnected()
+{
+    logMessage(binancelogger::Info, "WebSocket API connected.");
+    for (const QString& id : qAsConst(webSocketApiBacklog)) {
+        auto it = webSocketApiPending.find(id);
+        if (it != webSocketApiPending.end()) {
+            webSocketApi.sendTextMessage(it.value().message);
+            it.value().message.clear();
+        }
+    }
+    webSocketApiBacklog.clear();
+    emit webSocketApiConnected();
+}
+
+void binanceapi::onWebSocketApiError(QAbstractSocket::SocketError error)
+{
+    logMessage(binancelogger::Warning, "WebSocket API error:", int(error), webSocketApi.errorString());
+    // A failed connect attempt emits no disconnected(); nothing queued would ever go out.
+    if (webSocketApi.state() != QAbstractSocket::ConnectedState) {
+        failWebSocketApiRequests(-1001, "Connect failed: " + webSocketApi.errorString());
+    }
+}
+
+void binanceapi::onWebSocketApiDisconnected()
+{
+    logMessage(binancelogger::Info, "WebSocket API disconnected:", 0, webSocketApi.closeReason());
+    if (metrics) {
+        metrics->recordDisconnect(metricSeries(binancemetrics::WebSocketApi, "ws-api"));
+    }
+    // Requests still waiting for an answer will never get one on this session.
+    failWebSocketApiRequests(-1001, "Disconnected before response");
+    emit webSocketApiDisconnected();
+}
 
+void binanceapi::handleWebSocketApiMessage(const QString& message)
+{
+    if (recorder) {
+        recorder->recordFrame("handleWebSocketApiMessage", message);
+    }
+    qint64 receivedNs = tracer ? tracer->now() : 0;
+    QJsonObject response = QJsonDocument::fromJson(message.toUtf8()).object();
+    qint64 decodedNs = tracer ? tracer->now() : 0;
+    QString id = response.value("id").isString() ? response.value("id").toString()
+                                                  : QString::number(response.value("id").toVariant().toLongLong());
+
+    auto it = webSocketApiPending.find(id);
+    if (it == webSocketApiPending.end()) {
+        logMessage(binancelogger::Warning, "WebSocket API response for unknown request:", 0, id);
+        return;
+    }
+    WebSocketApiRequest pending = it.value();
+    webSocketApiPending.erase(it);
+    if (metrics) {
+        int status = response.value("status").toInt();
+        int code = status != 200 ? response.value("error").toObject().value("code").toInt() : 0;
+        metrics->recordRequest(metricSeries(binancemetrics::WebSocketApi, pending.method), status, code,
+                               binancelatency::nowUs() - pending.sentUs);
+    }
 
+    if (response.value("status").toInt() != 200) {
+        QJsonObject error = response.value("error").toObject();
+        logMessage(binancelogger::Warning, "WebSocket API error:", error.value("code").toInt(),
+                   pending.method + " " + error.value("msg").toString());
+        emit orderRequestFailed(pending.clientOrderId, error.value("code").toInt(), error.value("msg").toString());
+        return;
+    }
 
+    QJsonObject result = response.value("result").toObject();
+    if (pending.method == "order.place") {
+        emit newOrderResponseReceived(result);
+    } else if (pending.method == "order.modify") {
+        emit modifyOrderResponseReceived(result);
+    } else if (pending.method == "order.cancel") {
+        emit cancelOrderResponseReceived(result);
+    }
+    if (isConnected(&binanceapi::orderAckReceived)) {
+        emit orderAckReceived(binancetypes::decodeOrderAck(result));
+    }
+    if (tracer && pending.traceSentNs >= 0) {
+        traceMessage(tracer, "handleWebSocketApiMessage", pending.traceSentNs, receivedNs, decodedNs);
+    }
+}
@@ -18,7 +18,25 @@
 #include <QDateTime>
 #include <QJsonDocument>
 #include <QJsonArray>
+#include <QWebSocket>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QMetaMethod>
+#include "binancetypes.h"
+#include "binanceendpoints.h"
+#include "binanceresponsecache.h"
+#include "binancelatency.h"
+#include "binanceclientid.h"
+#include <functional>
 
+class binancerecorder;
+class binancemetrics;
+class binancetracer;
+class binancelogger;
+struct binancelogendpoint;
+class binancevalidator;
 
 class binanceapi : public QObject {
     Q_OBJECT
@@ -53,15 +71,27 @@ public:
     void changePositionMode(bool dualSidePosition, qint64 recvWindow = -1, qint64 timestamp = -1);
     void getPositionMode(qint64 recvWindow = -1, qint64 timestamp = -1);
     void changeMultiAssetsMode(bool multiAssetsMargin, qint64 recvWindow = -1, qint64 timestamp = -1);
-    void sendNewOrder(const QString& symbol, const QString& side, const QString& positionSide, const QString& type,
-                      const QString& timeInForce, const QString& quantity, const QString& reduceOnly,
-                      const QString& price, const QString& newClientOrderId, const QString& stopPrice,
-                      const QString& closePosition, const QString& activationPrice, const QString& callbackRate,
-                      const QString& workingType, const QString& priceProtect, const QString& newOrderRespType,
-                      qint64 recvWindow = -1, qint64 timestamp = -1);
+    //returns the clientOrderId the order goes out with, generated for batched orders given none
+    QString sendNewOrder(const QString& symbol, const QString& side, const QString& positionSide, const QString& type,
+                         const QString& timeInForce, const QString& quantity, const QString& reduceOnly,
+                         const QString& price, const QString& newClientOrderId, const QString& stopPrice,
+                         const QString& closePosition, const QString& activationPrice, const QString& callbackRate,
+                         const QString& workingType, const QString& priceProtect, const QString& newOrderRespType,
+                         qint64 recvWindow = -1, qint64 timestamp = -1);
     void modifyOrder(qint64 orderId, const QString& origClientOrderId, const QString& symbol, const QString& side,
                      const QString& quantity, const QString& price, qint64 recvWindow = -1, qint64 timestamp = -1);
     void batchOrders(const QJsonArray& orderList, qint64 recvWindow = -1, qint64 timestamp = -1);
+    //payload is the complete signed form body, signature parameter included
+    void postSignedOrder(const QNetworkRequest& request, const QByteArray& payload, const QString& clientOrderId);
+    //request for a REST endpoint with the api key header set, for callers that build their own payload
+    QNetworkRequest endpointRequest(binanceendpointid endpoint) const;
+    //keys mac with the api secret, so a caller can sign without holding the secret itself
+    void keySigner(QMessageAuthenticationCode& mac) const;
+    //hex HMAC-SHA256 of payload, the value of the signature parameter
+    static QByteArray signature(const QByteArray& payload, const QByteArray& secret);
+    //coalesce sendNewOrder calls made within the window into /batchOrders, 0 disables
+    void setOrderBatchWindow(int microseconds);
+    void flushOrderBatch();
     void batchModifyOrders(const QJsonArray& orderList, qint64 recvWindow = -1, qint64 timestamp = -1);
     void getOrderAmendmentHistory(const QString& symbol, qint64 orderId = -1, const QString& origClientOrderId = QString(), qint64 startTime = -1, qint64 endTime = -1, int limit = 50, qint64 recvWindow = -1, qint64 timestamp = -1);
     void checkOrderStatus(const QString& symbol, qint64 orderId = -1, const QString& origClientOrderId = QString(), qint64 recvWindow = -1, qint64 timestamp = -1);
@@ -92,11 +122,100 @@ public:
     void createUserDataStream();
     void extendUserDataStream(const QString &listenKey);
     void closeUserDataStream(const QString &listenKey);
+    void openUserStream(const QString& listenKey = QString());
+    void closeUserStream();
+
+    //point at another deployment (testnet, local server); spotUrl defaults to restUrl
+    void setBaseUrls(const QString& restUrl, const QString& streamUrl, const QString& webSocketApiUrl,
+                     const QString& spotUrl = QString());
+    //route REST calls through another manager (mock exchange, shared pool); not owned
+    void setNetworkAccessManager(QNetworkAccessManager* manager);
+    //raw feed journal, nullptr to stop recording
+    void setRecorder(binancerecorder* recorder);
+    //exchange-to-client latency histograms, nullptr to disable
+    void setLatencyMonitor(binancelatency* latency);
+    //request/stream counters for the Prometheus export, lane label is objectName(); nullptr to disable
+    void setMetrics(binancemetrics* metrics);
+    //sampled request/message lifecycle spans, nullptr to disable
+    void setTracer(binancetracer* tracer);
+    //binary handler log written off-thread; nullptr falls back to qDebug without payloads
+    void setLogger(binancelogger* logger);
+    //logs through the handler log (qDebug without one); message must be a literal
+    void logMessage(int level, const char* message, qint64 value = 0, const QString& detail = QString());
+    //static-data GETs answer from memory for ttlMs (defaults in binanceresponsecache); 0 always fetches
+    void setCacheTtl(binanceendpointid endpoint, int ttlMs);
+    //fraction of the ttl after which a cached read also refetches in the background
+    void setCacheRefreshAhead(double fraction);
+    void invalidateCache(binanceendpointid endpoint);
+    void clearCache();
+    //summed table weight of every REST request built since construction; a lifetime total, not the 1m window
+    qint64 totalRequestWeight() const;
+    //getDepth/get24hrTicker/getAccountInformation calls answered by an identical request already in flight
+    qint64 coalescedRequests() const;
+    //local pre-trade checks in front of sendNewOrder/batchOrders, nullptr to disable
+    void setOrderValidator(binancevalidator* validator);
+
+    //market streams
+    void subscribeMarketStreams(const QStringList& streams);
+    void unsubscribeMarketStreams(const QStringList& streams);
+
+    //websocket api
+    void openWebSocketApi();
+    void closeWebSocketApi();
+    //requests without an answer after ms fail with -1007, queued ones are then never sent
+    void setWebSocketApiTimeout(int ms);
+    QString wsSendNewOrder(const QString& symbol, const QString& side, const QString& positionSide, const QString& type,
+                           const QString& timeInForce, const QString& quantity, const QString& reduceOnly,
+                           const QString& price, const QString& newClientOrderId, const QString& stopPrice,
+                           const QString& closePosition, const QString& activationPrice, const QString& callbackRate,
+                           const QString& workingType, const QString& priceProtect, const QString& newOrderRespType,
+                           qint64 recvWindow = -1, qint64 timestamp = -1);
+    QString wsModifyOrder(qint64 orderId, const QString& origClientOrderId, const QString& symbol, const QString& side,
+                          const QString& quantity, const QString& price, qint64 recvWindow = -1, qint64 timestamp = -1);
+    QString wsCancelOrder(const QString& symbol, qint64 orderId = -1, const QString& origClientOrderId = QString(), qint64 recvWindow = -1, qint64 timestamp = -1);
 
 signals:
     void accountInformationReceived(const QByteArray& data);
     void testConnectivityResultReceived(const QJsonObject& result);
     void snggetdatacandel(QJsonDocument);
+    //typed results, decoded only while something is connected; a queued delivery copies one shared pointer
+    void depthSnapshotReceived(const binancetypes::DepthSnapshotPtr& snapshot);
+    void klineBatchReceived(const binancetypes::KlineBatchPtr& batch);
+    void orderAckReceived(const binancetypes::OrderAckPtr& ack);
+    void positionListReceived(const binancetypes::PositionListPtr& positions);
+    void incomeRecordsReceived(const binancetypes::IncomeRecordsPtr& records);
+    void newOrderResponseReceived(const QJsonObject& result);
+    void modifyOrderResponseReceived(const QJsonObject& result);
+    void cancelOrderResponseReceived(const QJsonObject& result);
+    void orderRequestFailed(const QString& clientOrderId, int code, const QString& message);
+    void webSocketApiConnected();
+    void webSocketApiDisconnected();
+    void depthReceived(const QString& symbol, const QJsonObject& depth);
+    void premiumIndexReceived(const QJsonArray& entries);
+    void exchangeInfoReceived(const QJsonObject& exchangeInfo);
+    void leverageBracketReceived(const QJsonArray& brackets);
+    //symbol is the one queried, empty for the full account
+    void positionRiskReceived(const QJsonArray& positions, const QString& symbol);
+    void positionRiskFailed(int code, const QString& message);
+    void countdownCancelAllReceived(const QString& symbol, const QJsonObject& result);
+    void countdownCancelAllFailed(const QString& symbol, int code, const QString& message);
+    void cancelAllOpenOrdersReceived(const QString& symbol, const QJsonObject& result);
+    void cancelAllOpenOrdersFailed(const QString& symbol, int code, const QString& message);
+    void leverageChanged(const QString& symbol, int leverage);
+    void openOrdersReceived(const QString& symbol, const QJsonArray& orders);
+    void openOrdersFailed(const QString& symbol, int code, const QString& message);
+    void orderStatusReceived(const QJsonObject& order);
+    void orderStatusFailed(const QString& clientOrderId, int code, const QString& message);
+    void listenKeyReceived(const QString& listenKey);
+    void userStreamEventReceived(const QJsonObject& event);
+    void userStreamConnected();
+    void userStreamDisconnected();
+    void depthRequestFailed(const QString& symbol);
+    //background refresh-ahead of a cached endpoint failed; the cached body is still served until its ttl
+    void cacheRefreshFailed(const QString& path, int code, const QString& message);
+    void marketStreamEventReceived(const QString& stream, const QJsonValue& data);
+    void marketStreamConnected();
+    void marketStreamDisconnected();
 
 
 private slots:
@@ -158,17 +277,177 @@ private slots:
 
 
     //data stream
-    void onCreateUserDataStreamFinished();
-    void onExtendUserDataStreamFinished();
-    void onCloseUserDataStreamFinished();
+    void onCreateUserDataStreamFinished(QNetworkReply* reply);
+    void onExtendUserDataStreamFinished(QNetworkReply* reply);
+    void onCloseUserDataStreamFinished(QNetworkReply* reply);
+    void onUserStreamDisconnected();
+    void handleUserStreamMessage(const QString& message);
+
+    //market streams
+    void onMarketStreamConnected();
+    void onMarketStreamDisconnected();
+    void reconnectMarketStream();
+    void handleMarketStreamMessage(const QString& message);
+
+    //websocket api
+    void onWebSocketApiConnected();
+    void onWebSocketApiDisconnected();
+    void onWebSocketApiError(QAbstractSocket::SocketError error);
+    void expireWebSocketApiRequests();
+    void handleWebSocketApiMessage(const QString& message);
 
 private:
-    QString generateSignature(const QString& queryString) const;
+    struct WebSocketApiRequest {
+        QString method;
+        QString clientOrderId;
+        qint64 sentUs;
+        qint64 traceSentNs;
+        //frame kept only while the request waits in webSocketApiBacklog
+        QString message;
+    };
+
+    struct ReplyTiming {
+        QElapsedTimer sent;
+        bool firstByte = false;
+        qint64 enqueuedNs = -1;
+        qint64 dispatchNs = -1;
+        qint64 connectedNs = -1;
+        qint64 firstByteNs = -1;
+        qint64 lastByteNs = -1;
+    };
+
+    template <typename Signal>
+    bool isConnected(Signal signal) const {
+        return isSignalConnected(QMetaMethod::fromSignal(signal));
+    }
+    template <binanceendpointid Id>
+    QUrl endpointUrl(int limit = 0, bool allSymbols = false);
+    template <binanceendpointid Id>
+    bool checkLimit(int limit);
+    template <binanceendpointid Id>
+    void addLimit(QUrlQuery& query, int limit) const;
+    template <binanceendpointid Id>
+    QByteArray encodeParams(const QUrlQuery& query) const;
+    bool invalidLimit(const binanceendpoint& endpoint, int limit);
+    bool answerFromCache(binanceendpointid endpoint, const QString& key, const char* handler,
+                         void (binanceapi::*slot)(QNetworkReply*), const std::function<void()>& refresh);
+    bool cacheReply(QNetworkReply* reply, binanceendpointid endpoint, const QString& key);
+    QJsonDocument replyDocument(QNetworkReply* reply);
+    bool joinInFlight(binanceendpointid endpoint, const QString& key);
+    void trackInFlight(QNetworkReply* reply, binanceendpointid endpoint, const QString& key);
+    QByteArray signParams(QByteArray params) const;
+    void watchReply(QNetworkReply* reply, const char* handler, void (binanceapi::*slot)(QNetworkReply*));
+    QList<QPair<QString, QString>> newOrderParams(const QString& symbol, const QString& side, const QString& positionSide, const QString& type,
+                                                  const QString& timeInForce, const QString& quantity, const QString& reduceOnly,
+                                                  const QString& price, const QString& newClientOrderId, const QString& stopPrice,
+                                                  const QString& closePosition, const QString& activationPrice, const QString& callbackRate,
+                                                  const QString& workingType, const QString& priceProtect, const QString& newOrderRespType) const;
+    void emitOrderFailure(QNetworkReply* reply, const QByteArray& data);
+    void queueBatchedOrder(const QJsonObject& order, qint64 recvWindow);
+    void sendBatchOrders(const QJsonArray& orderList, qint64 recvWindow, qint64 timestamp);
+    bool validateOrder(const QString& symbol, const QString& side, const QString& type, const QString& price,
+                       const QString& quantity, const QString& reduceOnly, const QString& clientOrderId);
+    QString sendWebSocketApiRequest(const QString& method, QJsonObject params, const QString& clientOrderId);
+    void failWebSocketApiRequests(int code, const QString& message);
+    void sendMarketStreamRequest(const QString& method, const QStringList& streams);
+    int metricSeries(int kind, const QString& endpoint);
+    binancehistogram* latencyHistogram(QHash<const char*, binancehistogram*>& cache, const char* handler, bool decode);
+    binancelatency::Stream latencyStream(QHash<QString, binancelatency::Stream>& cache, const char* prefix, const QString& stream);
+    void recordReplyMetrics(const char* handler, QNetworkReply* reply, qint64 elapsedUs);
+    void traceEnqueue();
+    void traceDecoded();
+    void traceReply(binancetracer* trace, const char* handler, const ReplyTiming& timing);
+    void traceMessage(binancetracer* trace, const char* handler, qint64 startNs, qint64 receivedNs, qint64 decodedNs);
+    binancelogendpoint* logEndpoint(const char* handler);
+    void logReply(const char* handler, QNetworkReply* reply);
+    void logReplyError(QNetworkReply* reply);
+    void logReceived(const char* message);
     QString apiKey;
     QString apiSecret;
-    QNetworkAccessManager networkManager;
+    QString baseUrl;
+    QString spotBaseUrl;
+    QString streamBaseUrl;
+    QString webSocketApiUrl;
+    QNetworkAccessManager* networkManager;
     QNetworkAccessManager networkManagerstream;
+    binancerecorder* recorder;
+    binancelatency* latency;
+    QHash<const char*, binancehistogram*> firstByteHistograms;
+    QHash<const char*, binancehistogram*> decodeHistograms;
+    QHash<QString, binancelatency::Stream> marketStreamHistograms;
+    QHash<QString, binancelatency::Stream> userStreamHistograms;
+    binancemetrics* metrics;
+    QHash<const char*, int> replyMetricSeries;
+    QHash<QString, int> streamMetricSeries;
+    binancetracer* tracer;
+    qint64 traceEnqueueNs;
+    qint64 traceDecodedNs;
+    qint64 orderBatchEnqueueNs;
+    qint64 sentWeight;
+    binanceresponsecache responseCache;
+    bool cacheRefreshing;
+    QSet<QString> inFlight;
+    qint64 coalescedCount;
+    binancelogger* logger;
+    QHash<const char*, binancelogendpoint*> logEndpoints;
+    const char* logHandler;
+    qint64 logBytes;
+    QWebSocket userStream;
+    QTimer userStreamKeepAlive;
+    QString userStreamListenKey;
+    bool userStreamRequested;
+    binancevalidator* validator;
+    static const int maxBatchOrders = 5;
+    int orderBatchWindowUs;
+    qint64 orderBatchRecvWindow;
+    QList<QJsonObject> orderBatch;
+    QTimer orderBatchTimer;
+    //ids for batched orders sent without one, see binanceclientid::batchStrategy
+    binanceclientid batchClientIds;
+    QWebSocket marketStream;
+    QStringList marketStreamSubscriptions;
+    quint64 marketStreamNextId = 0;
+    //reopens the market stream after a drop, doubling up to a minute
+    QTimer marketStreamReconnect;
+    int marketStreamBackoffMs = 0;
+    QWebSocket webSocketApi;
+    QHash<QString, WebSocketApiRequest> webSocketApiPending;
+    //ids of pending requests not sent yet, in submission order
+    QStringList webSocketApiBacklog;
+    int webSocketApiTimeoutMs = 10000;
+    QTimer webSocketApiTimer;
+    quint64 webSocketApiNextId = 0;
 
 };
 
+// Path, base and weight come from the table at compile time; only limit and
+// the symbol-less case are looked at per call.
+template <binanceendpointid Id>
+QUrl binanceapi::endpointUrl(int limit, bool allSymbols) {
+    sentWeight += binanceendpointweight(binanceendpointspec(Id), limit, allSymbols);
+    return QUrl((binanceendpointspec(Id).spot ? spotBaseUrl : baseUrl) + QLatin1String(binanceendpointspec(Id).path));
+}
+
+template <binanceendpointid Id>
+bool binanceapi::checkLimit(int limit) {
+    static_assert(binanceendpointspec(Id).maxLimit > 0, "endpoint takes no limit");
+    return binanceendpointlimitvalid(binanceendpointspec(Id), limit) || invalidLimit(binanceendpointspec(Id), limit);
+}
+
+//optional limit: left out when the exchange would reject it
+template <binanceendpointid Id>
+void binanceapi::addLimit(QUrlQuery& query, int limit) const {
+    static_assert(binanceendpointspec(Id).maxLimit > 0, "endpoint takes no limit");
+    if (binanceendpointlimitvalid(binanceendpointspec(Id), limit)) {
+        query.addQueryItem("limit", QString::number(limit));
+    }
+}
+
+//query string or form body as sent; the table's signedRequest decides whether it is signed
+template <binanceendpointid Id>
+QByteArray binanceapi::encodeParams(const QUrlQuery& query) const {
+    const QByteArray params = query.toString(QUrl::FullyEncoded).toLatin1();
+    return binanceendpointspec(Id).signedRequest ? signParams(params) : params;
+}
+
 #endif // BINANCEAPI_H
@@ -0,0 +1,557 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#include "binancebacktest.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QDataStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QUrlQuery>
+#include <QSet>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDebug>
+
+struct binancebacktest::Source {
+    enum Kind {
+        Journal,
+        Klines,
+        AggTrades
+    };
+
+    Kind kind = Journal;
+    QFile file;
+    QDataStream in;
+    QString symbol;
+    QString stream;
+    QString interval;
+    bool hasHead = false;
+    qint64 timeNs = 0;
+    binancerecorder::Record head;
+};
+
+// One job per pool thread; everything the job touches is created here.
+class binancebacktestrunner : public QRunnable {
+public:
+    binancebacktestrunner(const binancebacktest::Job& job, binancebacktest::Result* result)
+        : job(job), result(result) {
+    }
+
+    void run() override {
+        binancebacktest backtest;
+        result->name = job.name;
+        if (job.setup) {
+            job.setup(&backtest);
+        }
+        result->ok = backtest.run();
+        result->stats = backtest.stats();
+    }
+
+private:
+    binancebacktest::Job job;
+    binancebacktest::Result* result;
+};
+
+binancebacktest::binancebacktest(QObject* parent)
+    : QObject(parent), client("backtest", "backtest"), nowMs(0), latencyMs(0), makerRate(0.0002), takerRate(0.0005),
+      fillOnTouch(false), running(false), pendingReplies(0), nextTradeId(1) {
+    // Streams are fed from the sources; keep the client off the real endpoints.
+    client.setObjectName("backtest");
+    client.setBaseUrls("http://backtest.invalid", "ws://127.0.0.1:1", "ws://127.0.0.1:1/ws-fapi/v1");
+    client.setNetworkAccessManager(&mock);
+    replayer.addTarget(&client);
+
+    connect(&client, &binanceapi::marketStreamEventReceived, this, &binancebacktest::handleMarketEvent);
+    connect(&client, &binanceapi::depthReceived, this, &binancebacktest::handleDepth);
+    connect(&mock, &binancemockexchange::orderChanged, this, &binancebacktest::handleOrderChanged);
+    connect(&mock, &binancemockexchange::requestReceived, this, [this](const QString& path, const QByteArray& payload) {
+        ++pendingReplies;
+        if (path.endsWith("/v1/allOpenOrders")) {
+            QString symbol = QUrlQuery(QString::fromUtf8(payload)).queryItemValue("symbol");
+            const QStringList ids = working.keys();
+            for (const QString& clientOrderId : ids) {
+                if (working.value(clientOrderId).symbol == symbol) {
+                    finishOrder(clientOrderId, "CANCELED", "CANCELED");
+                    counters.cancels++;
+                }
+            }
+        }
+    });
+    connect(&mock, &binancemockexchange::responseDelivered, this, [this](const QString&) { --pendingReplies; });
+}
+
+binancebacktest::~binancebacktest() {
+    qDeleteAll(sources);
+}
+
+binanceapi* binancebacktest::api() {
+    return &client;
+}
+
+binancemockexchange* binancebacktest::exchange() {
+    return &mock;
+}
+
+bool binancebacktest::addJournal(const QString& fileName) {
+    Source* source = new Source;
+    source->kind = Source::Journal;
+    source->file.setFileName(fileName);
+    if (!source->file.open(QIODevice::ReadOnly)) {
+        qDebug() << "Could not open journal:" << fileName << source->file.errorString();
+        delete source;
+        return false;
+    }
+    source->in.setDevice(&source->file);
+    if (!binancerecorder::readHeader(source->in)) {
+        qDebug() << "Not a binance journal:" << fileName;
+        delete source;
+        return false;
+    }
+    sources.append(source);
+    return true;
+}
+
+bool binancebacktest::addKlinesCsv(const QString& fileName, const QString& symbol, const QString& interval) {
+    Source* source = new Source;
+    source->kind = Source::Klines;
+    source->file.setFileName(fileName);
+    if (!source->file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qDebug() << "Could not open klines:" << fileName << source->file.errorString();
+        delete source;
+        return false;
+    }
+    source->symbol = symbol.toUpper();
+    source->interval = interval;
+    source->stream = symbol.toLower() + "@kline_" + interval;
+    sources.append(source);
+    return true;
+}
+
+bool binancebacktest::addAggTradesCsv(const QString& fileName, const QString& symbol) {
+    Source* source = new Source;
+    source->kind = Source::AggTrades;
+    source->file.setFileName(fileName);
+    if (!source->file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qDebug() << "Could not open aggTrades:" << fileName << source->file.errorString();
+        delete source;
+        return false;
+    }
+    source->symbol = symbol.toUpper();
+    source->stream = symbol.toLower() + "@aggTrade";
+    sources.append(source);
+    return true;
+}
+
+void binancebacktest::setOrderLatency(qint64 msecs) {
+    latencyMs = qMax<qint64>(0, msecs);
+}
+
+void binancebacktest::setCommission(double makerRate, double takerRate) {
+    this->makerRate = makerRate;
+    this->takerRate = takerRate;
+}
+
+void binancebacktest::setFillOnTouch(bool enabled) {
+    fillOnTouch = enabled;
+}
+
+qint64 binancebacktest::time() const {
+    return nowMs;
+}
+
+binancebacktest::Stats binancebacktest::stats() const {
+    return counters;
+}
+
+void binancebacktest::stop() {
+    running = false;
+}
+
+bool binancebacktest::advance(Source* source) {
+    if (source->kind == Source::Journal) {
+        // Only market data; recorded order traffic would duplicate the simulated one.
+        static const QSet<QByteArray> marketReplies = {
+            "handleExchangeInfoResponse", "handleDepthResponse", "handleRecentTradesResponse",
+            "handleAggregateTradesResponse", "handleKlinesResponse", "handleContinuousKlinesResponse",
+            "handleIndexPriceKlinesResponse", "handleMarkPriceKlinesResponse", "handlePremiumIndexResponse",
+            "handleFundingRateResponse", "handle24hrTickerResponse", "handleLatestPriceResponse",
+            "handleBookTickerResponse", "handleOpenInterestResponse"
+        };
+        while (binancerecorder::readRecord(source->in, source->head)) {
+            const binancerecorder::Record& record = source->head;
+            if (record.kind == binancerecorder::Frame ? record.handler == "handleMarketStreamMessage"
+                                                      : marketReplies.contains(record.handler)) {
+                source->timeNs = record.receiveNs;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Public data dumps: one row per kline or aggregate trade, optional header.
+    while (!source->file.atEnd()) {
+        const QList<QByteArray> fields = source->file.readLine().trimmed().split(',');
+        bool numeric = false;
+        fields.value(0).toLongLong(&numeric);
+        if (!numeric) {
+            continue;
+        }
+
+        QJsonObject event;
+        qint64 timeMs = 0;
+        if (source->kind == Source::Klines) {
+            if (fields.size() < 11) {
+                continue;
+            }
+            timeMs = fields.at(6).toLongLong();
+            QJsonObject kline;
+            kline.insert("t", fields.at(0).toLongLong());
+            kline.insert("T", timeMs);
+            kline.insert("s", source->symbol);
+            kline.insert("i", source->interval);
+            kline.insert("f", -1);
+            kline.insert("L", -1);
+            kline.insert("o", QString::fromLatin1(fields.at(1)));
+            kline.insert("h", QString::fromLatin1(fields.at(2)));
+            kline.insert("l", QString::fromLatin1(fields.at(3)));
+            kline.insert("c", QString::fromLatin1(fields.at(4)));
+            kline.insert("v", QString::fromLatin1(fields.at(5)));
+            kline.insert("q", QString::fromLatin1(fields.at(7)));
+            kline.insert("n", fields.at(8).toLongLong());
+            kline.insert("x", true);
+            kline.insert("V", QString::fromLatin1(fields.at(9)));
+            kline.insert("Q", QString::fromLatin1(fields.at(10)));
+            kline.insert("B", "0");
+            event.insert("e", "kline");
+            event.insert("k", kline);
+        } else {
+            if (fields.size() < 7) {
+                continue;
+            }
+            timeMs = fields.at(5).toLongLong();
+            // Some dumps carry microseconds.
+            if (timeMs > 100000000000000LL) {
+                timeMs /= 1000;
+            }
+            event.insert("e", "aggTrade");
+            event.insert("a", fields.at(0).toLongLong());
+            event.insert("p", QString::fromLatin1(fields.at(1)));
+            event.insert("q", QString::fromLatin1(fields.at(2)));
+            event.insert("f", fields.at(3).toLongLong());
+            event.insert("l", fields.at(4).toLongLong());
+            event.insert("T", timeMs);
+            event.insert("m", fields.at(6).toLower() == "true");
+        }
+        event.insert("E", timeMs);
+        event.insert("s", source->symbol);
+
+        QJsonObject frame;
+        frame.insert("stream", source->stream);
+        frame.insert("data", event);
+        source->head.kind = binancerecorder::Frame;
+        source->head.handler = "handleMarketStreamMessage";
+        source->head.receiveNs = timeMs * 1000000;
+        source->head.payload = QJsonDocument(frame).toJson(QJsonDocument::Compact);
+        source->timeNs = source->head.receiveNs;
+        return true;
+    }
+    return false;
+}
+
+bool binancebacktest::run() {
+    if (sources.isEmpty()) {
+        qDebug() << "Backtest has no sources.";
+        return false;
+    }
+    QElapsedTimer clock;
+    clock.start();
+    running = true;
+    for (Source* source : qAsConst(sources)) {
+        source->hasHead = advance(source);
+    }
+
+    while (running) {
+        // k-way merge by time; there are only ever a handful of sources.
+        Source* next = nullptr;
+        for (Source* source : qAsConst(sources)) {
+            if (source->hasHead && (!next || source->timeNs < next->timeNs)) {
+                next = source;
+            }
+        }
+        if (!next) {
+            break;
+        }
+        nowMs = qMax(nowMs, next->timeNs / 1000000);
+        mock.setTime(nowMs);
+        replayer.dispatch(next->head);
+        counters.records++;
+        next->hasHead = advance(next);
+        drain();
+        if ((counters.records & 1023) == 0) {
+            QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+        }
+    }
+    drain();
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+
+    running = false;
+    counters.elapsedNs = clock.nsecsElapsed();
+    emit finished(counters);
+    return true;
+}
+
+void binancebacktest::drain() {
+    // Order acks and simulated fills settle before the next market record.
+    while (pendingReplies > 0 || !userEvents.isEmpty()) {
+        if (pendingReplies > 0) {
+            QCoreApplication::processEvents(QEventLoop::AllEvents);
+        }
+        while (!userEvents.isEmpty()) {
+            binancerecorder::Record record;
+            record.kind = binancerecorder::Frame;
+            record.handler = "handleUserStreamMessage";
+            record.receiveNs = nowMs * 1000000;
+            record.payload = userEvents.takeFirst();
+            replayer.dispatch(record);
+        }
+    }
+}
+
+void binancebacktest::handleMarketEvent(const QString& stream, const QJsonValue& data) {
+    const QJsonArray events = data.isArray() ? data.toArray() : QJsonArray{data};
+    for (const QJsonValue& value : events) {
+        QJsonObject event = value.toObject();
+        QString type = event.value("e").toString();
+        QString symbol = event.value("s").toString();
+        Market& market = markets[symbol];
+
+        if (type == "aggTrade" || type == "trade") {
+            double price = event.value("p").toString().toDouble();
+            market.last = price;
+            matchSymbol(symbol, price, event.value("q").toString().toDouble(), 0.0, 0.0);
+        } else if (type == "kline") {
+            QJsonObject kline = event.value("k").toObject();
+            market.last = kline.value("c").toString().toDouble();
+            matchSymbol(symbol, 0.0, 0.0, kline.value("l").toString().toDouble(), kline.value("h").toString().toDouble());
+        } else if (type == "bookTicker") {
+            market.bid = event.value("b").toString().toDouble();
+            market.ask = event.value("a").toString().toDouble();
+            matchSymbol(symbol, 0.0, 0.0, 0.0, 0.0);
+        } else if (type == "depthUpdate" && !stream.endsWith("@depth") && !stream.contains("@depth@")) {
+            // Partial depth streams (@depth5/10/20) carry the top of book; diffs do not.
+            QJsonArray bids = event.value("b").toArray();
+            QJsonArray asks = event.value("a").toArray();
+            if (!bids.isEmpty()) {
+                market.bid = bids.at(0).toArray().at(0).toString().toDouble();
+            }
+            if (!asks.isEmpty()) {
+                market.ask = asks.at(0).toArray().at(0).toString().toDouble();
+            }
+            matchSymbol(symbol, 0.0, 0.0, 0.0, 0.0);
+        }
+    }
+}
+
+void binancebacktest::handleDepth(const QString& symbol, const QJsonObject& depth) {
+    Market& market = markets[symbol];
+    QJsonArray bids = depth.value("bids").toArray();
+    QJsonArray asks = depth.value("asks").toArray();
+    if (!bids.isEmpty()) {
+        market.bid = bids.at(0).toArray().at(0).toString().toDouble();
+    }
+    if (!asks.isEmpty()) {
+        market.ask = asks.at(0).toArray().at(0).toString().toDouble();
+    }
+}
+
+void binancebacktest::handleOrderChanged(const QJsonObject& order) {
+    QString clientOrderId = order.value("clientOrderId").toString();
+    qint64 orderId = order.value("orderId").toVariant().toLongLong();
+    if (clientOrderId.isEmpty()) {
+        for (auto it = working.constBegin(); it != working.constEnd(); ++it) {
+            if (it.value().orderId == orderId) {
+                clientOrderId = it.key();
+                break;
+            }
+        }
+    }
+
+    if (order.value("status").toString() == "CANCELED") {
+        if (working.contains(clientOrderId)) {
+            finishOrder(clientOrderId, "CANCELED", "CANCELED");
+            counters.cancels++;
+        }
+        return;
+    }
+
+    auto it = working.find(clientOrderId);
+    if (it != working.end()) {
+        it.value().price = order.value("price").toString().toDouble();
+        it.value().quantity = order.value("origQty").toString().toDouble();
+        queueUpdate(it.value(), "AMENDMENT", it.value().executed > 0 ? "PARTIALLY_FILLED" : "NEW");
+        return;
+    }
+
+    SimOrder entry;
+    entry.symbol = order.value("symbol").toString();
+    entry.clientOrderId = clientOrderId;
+    entry.orderId = orderId;
+    entry.side = order.value("side").toString();
+    entry.type = order.value("type").toString();
+    entry.timeInForce = order.value("timeInForce").toString();
+    entry.positionSide = order.value("positionSide").toString();
+    entry.reduceOnly = order.value("reduceOnly").toBool();
+    entry.price = order.value("price").toString().toDouble();
+    entry.quantity = order.value("origQty").toString().toDouble();
+    entry.activeFromMs = nowMs + latencyMs;
+    working.insert(clientOrderId, entry);
+    counters.orders++;
+    queueUpdate(entry, "NEW", "NEW");
+}
+
+void binancebacktest::matchSymbol(const QString& symbol, double tradePrice, double tradeQty, double low, double high) {
+    const Market market = markets.value(symbol);
+    for (auto it = working.begin(); it != working.end();) {
+        SimOrder& order = it.value();
+        if (order.symbol != symbol || order.activeFromMs > nowMs) {
+            ++it;
+            continue;
+        }
+        bool buy = order.side == "BUY";
+        double opposite = buy ? market.ask : market.bid;
+        if (opposite <= 0.0) {
+            opposite = market.last;
+        }
+        bool expired = false;
+
+        if (!order.resting) {
+            bool marketable = order.type == "MARKET" || (opposite > 0.0 && (buy ? order.price >= opposite : order.price <= opposite));
+            if (order.type != "MARKET" && order.type != "LIMIT") {
+                qDebug() << "Backtest does not simulate" << order.type << "orders:" << order.clientOrderId;
+                expired = true;
+            } else if (marketable && order.timeInForce == "GTX") {
+                expired = true;
+            } else if (marketable && opposite > 0.0) {
+                fill(order, opposite, order.quantity - order.executed, false);
+            } else if (marketable) {
+                // Market order before the first price of the symbol; wait for one.
+                ++it;
+                continue;
+            } else if (order.timeInForce == "IOC" || order.timeInForce == "FOK") {
+                expired = true;
+            } else {
+                order.resting = true;
+            }
+        } else {
+            double remaining = order.quantity - order.executed;
+            bool crossed = false;
+            double quantity = remaining;
+            if (tradePrice > 0.0) {
+                crossed = buy ? tradePrice < order.price || (fillOnTouch && tradePrice == order.price)
+                              : tradePrice > order.price || (fillOnTouch && tradePrice == order.price);
+                quantity = qMin(remaining, tradeQty);
+            } else if (low > 0.0 && high > 0.0) {
+                crossed = buy ? low < order.price : high > order.price;
+            } else {
+                crossed = buy ? market.ask > 0.0 && market.ask < order.price : market.bid > 0.0 && market.bid > order.price;
+            }
+            if (crossed) {
+                fill(order, order.price, quantity, true);
+            }
+        }
+
+        if (expired) {
+            queueUpdate(order, "EXPIRED", "EXPIRED");
+            counters.expired++;
+            it = working.erase(it);
+        } else if (order.executed >= order.quantity - 1e-12) {
+            it = working.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void binancebacktest::fill(SimOrder& order, double price, double quantity, bool maker) {
+    if (quantity <= 0.0) {
+        return;
+    }
+    order.executed += quantity;
+    order.cumQuote += price * quantity;
+    double commission = price * quantity * (maker ? makerRate : takerRate);
+    counters.fills++;
+    counters.volume += quantity;
+    counters.notional += price * quantity;
+    counters.commission += commission;
+    queueUpdate(order, "TRADE", order.executed >= order.quantity - 1e-12 ? "FILLED" : "PARTIALLY_FILLED",
+                price, quantity, commission, maker);
+}
+
+void binancebacktest::finishOrder(const QString& clientOrderId, const QString& execution, const QString& status) {
+    auto it = working.find(clientOrderId);
+    if (it == working.end()) {
+        return;
+    }
+    queueUpdate(it.value(), execution, status);
+    working.erase(it);
+}
+
+void binancebacktest::queueUpdate(const SimOrder& order, const QString& execution, const QString& status,
+                                  double lastPrice, double lastQty, double commission, bool maker) {
+    QJsonObject update;
+    update.insert("s", order.symbol);
+    update.insert("c", order.clientOrderId);
+    update.insert("S", order.side);
+    update.insert("o", order.type);
+    update.insert("f", order.timeInForce);
+    update.insert("q", number(order.quantity));
+    update.insert("p", number(order.price));
+    update.insert("ap", number(order.executed > 0.0 ? order.cumQuote / order.executed : 0.0));
+    update.insert("sp", "0");
+    update.insert("x", execution);
+    update.insert("X", status);
+    update.insert("i", order.orderId);
+    update.insert("l", number(lastQty));
+    update.insert("z", number(order.executed));
+    update.insert("L", number(lastPrice));
+    update.insert("n", number(commission));
+    update.insert("N", "USDT");
+    update.insert("T", nowMs);
+    update.insert("t", execution == "TRADE" ? nextTradeId++ : 0);
+    update.insert("b", "0");
+    update.insert("a", "0");
+    update.insert("m", maker);
+    update.insert("R", order.reduceOnly);
+    update.insert("wt", "CONTRACT_PRICE");
+    update.insert("ot", order.type);
+    update.insert("ps", order.positionSide);
+    update.insert("cp", false);
+    update.insert("rp", "0");
+
+    QJsonObject event;
+    event.insert("e", "ORDER_TRADE_UPDATE");
+    event.insert("E", nowMs);
+    event.insert("T", nowMs);
+    event.insert("o", update);
+    userEvents.append(QJsonDocument(event).toJson(QJsonDocument::Compact));
+}
+
+QString binancebacktest::number(double value) {
+    return QString::number(value, 'f', 8);
+}
+
+QVector<binancebacktest::Result> binancebacktest::runParallel(const QList<Job>& jobs, int threads) {
+    QVector<Result> results(jobs.size());
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads > 0 ? threads : QThread::idealThreadCount());
+    for (int i = 0; i < jobs.size(); ++i) {
+        pool.start(new binancebacktestrunner(jobs.at(i), &results[i]));
+    }
+    pool.waitForDone();
+    return results;
+}
@@ -0,0 +1,149 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#ifndef BINANCEBACKTEST_H
+#define BINANCEBACKTEST_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QList>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QElapsedTimer>
+#include <functional>
+#include "binanceapi.h"
+#include "binancemockexchange.h"
+#include "binancereplayer.h"
+
+// Backtest driver on the live handler stack. Stored market data is merged by
+// time and pushed through binanceapi's own decode path (handleMarketStreamMessage
+// and the recorded REST handlers) as fast as the handlers allow, so strategies
+// connect to api() exactly as they do live. Orders go to an in-process
+// binancemockexchange and are matched against the replayed market:
+//   - marketable on arrival: taker fill at the opposite best, or last price
+//   - resting limits: maker fill at the limit price once trades, klines or
+//     the best bid/ask trade through it
+// Fills and state changes come back as ORDER_TRADE_UPDATE events through
+// handleUserStreamMessage, so binanceorders/binancepositions work unchanged.
+//
+// Sources: binancerecorder journals and Binance public data CSV dumps
+// (klines, aggTrades). Independent symbols or days run in parallel with
+// runParallel(), one driver, client and exchange per worker thread.
+class binancebacktest : public QObject {
+    Q_OBJECT
+public:
+    struct Stats {
+        qint64 records = 0;
+        qint64 orders = 0;
+        qint64 fills = 0;
+        qint64 cancels = 0;
+        qint64 expired = 0;
+        double volume = 0.0;
+        double notional = 0.0;
+        double commission = 0.0;
+        qint64 elapsedNs = 0;
+    };
+
+    struct Result {
+        QString name;
+        bool ok = false;
+        Stats stats;
+    };
+
+    //called on the worker thread; add sources and create the strategy (parented to the backtest)
+    typedef std::function<void(binancebacktest* backtest)> Setup;
+
+    struct Job {
+        QString name;
+        Setup setup;
+    };
+
+    explicit binancebacktest(QObject* parent = nullptr);
+    ~binancebacktest();
+
+    binanceapi* api();
+    binancemockexchange* exchange();
+
+    bool addJournal(const QString& fileName);
+    bool addKlinesCsv(const QString& fileName, const QString& symbol, const QString& interval);
+    bool addAggTradesCsv(const QString& fileName, const QString& symbol);
+
+    //simulated time between an order reaching the exchange and it becoming matchable
+    void setOrderLatency(qint64 msecs);
+    void setCommission(double makerRate, double takerRate);
+    //resting limits also fill when a trade prints exactly at their price
+    void setFillOnTouch(bool enabled);
+
+    bool run();
+    void stop();
+    qint64 time() const;
+    Stats stats() const;
+
+    static QVector<Result> runParallel(const QList<Job>& jobs, int threads = -1);
+
+signals:
+    void finished(const binancebacktest::Stats& stats);
+
+private slots:
+    void handleMarketEvent(const QString& stream, const QJsonValue& data);
+    void handleDepth(const QString& symbol, const QJsonObject& depth);
+    void handleOrderChanged(const QJsonObject& order);
+
+private:
+    struct Source;
+
+    struct Market {
+        double bid = 0.0;
+        double ask = 0.0;
+        double last = 0.0;
+    };
+
+    struct SimOrder {
+        QString symbol;
+        QString clientOrderId;
+        qint64 orderId = 0;
+        QString side;
+        QString type;
+        QString timeInForce;
+        QString positionSide;
+        bool reduceOnly = false;
+        double price = 0.0;
+        double quantity = 0.0;
+        double executed = 0.0;
+        double cumQuote = 0.0;
+        qint64 activeFromMs = 0;
+        bool resting = false;
+    };
+
+    bool advance(Source* source);
+    void drain();
+    void matchSymbol(const QString& symbol, double tradePrice, double tradeQty, double low, double high);
+    void fill(SimOrder& order, double price, double quantity, bool maker);
+    void finishOrder(const QString& clientOrderId, const QString& execution, const QString& status);
+    void queueUpdate(const SimOrder& order, const QString& execution, const QString& status,
+                     double lastPrice = 0.0, double lastQty = 0.0, double commission = 0.0, bool maker = false);
+    static QString number(double value);
+
+    binancemockexchange mock;
+    binanceapi client;
+    binancereplayer replayer;
+    QList<Source*> sources;
+    QHash<QString, Market> markets;
+    QHash<QString, SimOrder> working;
+    QList<QByteArray> userEvents;
+    qint64 nowMs;
+    qint64 latencyMs;
+    double makerRate;
+    double takerRate;
+    bool fillOnTouch;
+    bool running;
+    int pendingReplies;
+    qint64 nextTradeId;
+    Stats counters;
+};
+
+#endif // BINANCEBACKTEST_H
@@ -0,0 +1,130 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#include "binanceclientid.h"
+#include <QDateTime>
+#include <cstring>
+
+static const char base36Digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+binanceclientid::binanceclientid(int strategy, qint64 session)
+    : strategyId(0), sessionId(session < 0 ? QDateTime::currentMSecsSinceEpoch() : session), counter(0) {
+    setStrategy(strategy);
+}
+
+void binanceclientid::setStrategy(int strategy) {
+    strategyId = qBound(0, strategy, 36 * 36 - 1);
+    writeBase36(quint64(strategyId), prefix, strategyDigits);
+    writeBase36(quint64(sessionId), prefix + strategyDigits, sessionDigits);
+}
+
+int binanceclientid::strategy() const {
+    return strategyId;
+}
+
+qint64 binanceclientid::session() const {
+    return sessionId;
+}
+
+quint64 binanceclientid::nextSequence() {
+    return counter.fetch_add(1, std::memory_order_relaxed);
+}
+
+QByteArray binanceclientid::next() {
+    return encode(nextSequence());
+}
+
+QByteArray binanceclientid::encode(quint64 sequence) const {
+    char out[maxLength];
+    int length = encode(sequence, out);
+    return QByteArray(out, length);
+}
+
+int binanceclientid::encode(quint64 sequence, char* out) const {
+    memcpy(out, prefix, sizeof(prefix));
+    char digits[13];
+    int count = 0;
+    do {
+        digits[count++] = base36Digits[sequence % 36];
+        sequence /= 36;
+    } while (sequence);
+    int length = int(sizeof(prefix));
+    while (count) {
+        out[length++] = digits[--count];
+    }
+    return length;
+}
+
+qint64 binanceclientid::sequenceOf(const QString& clientOrderId) const {
+    const int fixed = int(sizeof(prefix));
+    int length = clientOrderId.size();
+    if (length <= fixed || length > maxLength) {
+        return -1;
+    }
+    const QChar* data = clientOrderId.constData();
+    for (int i = 0; i < fixed; ++i) {
+        if (data[i].unicode() != ushort(prefix[i])) {
+            return -1;
+        }
+    }
+    quint64 sequence = 0;
+    for (int i = fixed; i < length; ++i) {
+        int digit = digitValue(data[i].unicode());
+        if (digit < 0) {
+            return -1;
+        }
+        sequence = sequence * 36 + quint64(digit);
+    }
+    return qint64(sequence);
+}
+
+bool binanceclientid::decode(const QString& clientOrderId, int* strategy, qint64* session, quint64* sequence) {
+    const int fixed = strategyDigits + sessionDigits;
+    int length = clientOrderId.size();
+    if (length <= fixed || length > maxLength) {
+        return false;
+    }
+    quint64 values[3] = {0, 0, 0};
+    const int ends[3] = {strategyDigits, fixed, length};
+    int field = 0;
+    for (int i = 0; i < length; ++i) {
+        if (i == ends[field]) {
+            ++field;
+        }
+        int digit = digitValue(clientOrderId.at(i).unicode());
+        if (digit < 0) {
+            return false;
+        }
+        values[field] = values[field] * 36 + quint64(digit);
+    }
+    if (strategy) {
+        *strategy = int(values[0]);
+    }
+    if (session) {
+        *session = qint64(values[1]);
+    }
+    if (sequence) {
+        *sequence = values[2];
+    }
+    return true;
+}
+
+void binanceclientid::writeBase36(quint64 value, char* out, int width) {
+    for (int i = width - 1; i >= 0; --i) {
+        out[i] = base36Digits[value % 36];
+        value /= 36;
+    }
+}
+
+int binanceclientid::digitValue(ushort c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'z') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
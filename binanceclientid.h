@@ -0,0 +1,57 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#ifndef BINANCECLIENTID_H
+#define BINANCECLIENTID_H
+
+#include <QByteArray>
+#include <QString>
+#include <atomic>
+
+// clientOrderId generator. An id is the strategy (2 base36 digits), the
+// session (8 base36 digits, the start time in ms, so ids stay unique across
+// restarts) and a per session counter in base36. next() is a single atomic
+// increment and may be called from any thread; sequenceOf() turns one of our
+// ids back into its counter with a fixed-width parse, no hashing.
+class binanceclientid {
+public:
+    static const int strategyDigits = 2;
+    static const int sessionDigits = 8;
+    static const int maxLength = strategyDigits + sessionDigits + 13;
+    // Strategy ids reserved for the library's own generators. Generators
+    // built in the same millisecond share a session, so each needs its own.
+    //binancepanic kill switch orders
+    static const int panicStrategy = 36 * 36 - 1;
+    //binanceapi batched orders sent without a clientOrderId
+    static const int batchStrategy = 36 * 36 - 2;
+
+    explicit binanceclientid(int strategy = 0, qint64 session = -1);
+    binanceclientid(const binanceclientid&) = delete;
+    binanceclientid& operator=(const binanceclientid&) = delete;
+
+    //only while no ids are being generated
+    void setStrategy(int strategy);
+    int strategy() const;
+    qint64 session() const;
+
+    quint64 nextSequence();
+    QByteArray next();
+    QByteArray encode(quint64 sequence) const;
+    int encode(quint64 sequence, char* out) const;
+    qint64 sequenceOf(const QString& clientOrderId) const;
+    static bool decode(const QString& clientOrderId, int* strategy, qint64* session, quint64* sequence);
+
+private:
+    static void writeBase36(quint64 value, char* out, int width);
+    static int digitValue(ushort c);
+
+    char prefix[strategyDigits + sessionDigits];
+    int strategyId;
+    qint64 sessionId;
+    std::atomic<quint64> counter;
+};
+
+#endif // BINANCECLIENTID_H
@@ -0,0 +1,209 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#ifndef BINANCEENDPOINTS_H
+#define BINANCEENDPOINTS_H
+
+// Compile-time description of every REST endpoint binanceapi calls: path,
+// method, request weight, signing and the accepted limit values. Request
+// builders take the id as a template argument, so the path, the limit
+// bounds and the weight tier are constants at the call site and only the
+// caller's own parameters are checked at run time.
+//
+// Weights follow the exchange documentation; weightTiers overrides weight
+// for endpoints whose cost grows with limit, allSymbolsWeight applies when
+// the symbol is omitted. The table is ordered by id, which a static_assert
+// below enforces.
+enum class binanceendpointid {
+    Ping,
+    Time,
+    ExchangeInfo,
+    Depth,
+    RecentTrades,
+    HistoricalTrades,
+    AggregateTrades,
+    Klines,
+    ContinuousKlines,
+    IndexPriceKlines,
+    MarkPriceKlines,
+    PremiumIndex,
+    FundingRate,
+    Ticker24hr,
+    LatestPrice,
+    BookTicker,
+    OpenInterest,
+    OpenInterestHist,
+    TopLongShortAccountRatio,
+    TopLongShortPositionRatio,
+    GlobalLongShortAccountRatio,
+    TakerLongShortRatio,
+    LvtKlines,
+    IndexInfo,
+    AssetIndex,
+    ChangePositionMode,
+    PositionMode,
+    ChangeMultiAssetsMode,
+    NewOrder,
+    ModifyOrder,
+    QueryOrder,
+    CancelOrder,
+    BatchOrders,
+    BatchModifyOrders,
+    CancelBatchOrders,
+    OrderAmendmentHistory,
+    CancelAllOpenOrders,
+    CountdownCancelAll,
+    OpenOrder,
+    OpenOrders,
+    AllOrders,
+    Balance,
+    Account,
+    ChangeLeverage,
+    ChangeMarginType,
+    PositionMargin,
+    PositionMarginHistory,
+    PositionRisk,
+    UserTrades,
+    Income,
+    LeverageBracket,
+    AdlQuantile,
+    ForceOrders,
+    ApiTradingStatus,
+    CommissionRate,
+    CreateListenKey,
+    ExtendListenKey,
+    CloseListenKey,
+    SpotAccount,
+    Count
+};
+
+struct binanceendpoint {
+    binanceendpointid id;
+    const char* path;
+    const char* method;
+    //spotBaseUrl instead of the futures base
+    bool spot;
+    //timestamp and signature required
+    bool signedRequest;
+    int weight;
+    //without a symbol, 0 for the same as weight
+    int allSymbolsWeight;
+    //maxLimit 0: no limit parameter
+    int minLimit;
+    int maxLimit;
+    //accepted values when limit is a set rather than a range, 0 terminated
+    int limits[8];
+    //{up to limit, weight} ascending, 0 terminated
+    int weightTiers[4][2];
+};
+
+constexpr binanceendpoint binanceendpoints[] = {
+    {binanceendpointid::Ping, "/fapi/v1/ping", "GET", false, false, 1, 0, 0, 0, {}, {}},
+    {binanceendpointid::Time, "/fapi/v1/time", "GET", false, false, 1, 0, 0, 0, {}, {}},
+    {binanceendpointid::ExchangeInfo, "/fapi/v1/exchangeInfo", "GET", false, false, 1, 0, 0, 0, {}, {}},
+    {binanceendpointid::Depth, "/fapi/v1/depth", "GET", false, false, 20, 0, 5, 1000,
+     {5, 10, 20, 50, 100, 500, 1000}, {{50, 2}, {100, 5}, {500, 10}, {1000, 20}}},
+    {binanceendpointid::RecentTrades, "/fapi/v1/trades", "GET", false, false, 5, 0, 1, 1000, {}, {}},
+    {binanceendpointid::HistoricalTrades, "/fapi/v1/historicalTrades", "GET", false, false, 20, 0, 1, 1000, {}, {}},
+    {binanceendpointid::AggregateTrades, "/fapi/v1/aggTrades", "GET", false, false, 20, 0, 1, 1000, {}, {}},
+    {binanceendpointid::Klines, "/fapi/v1/klines", "GET", false, false, 10, 0, 1, 1500,
+     {}, {{99, 1}, {499, 2}, {1000, 5}, {1500, 10}}},
+    {binanceendpointid::ContinuousKlines, "/fapi/v1/continuousKlines", "GET", false, false, 10, 0, 1, 1500,
+     {}, {{99, 1}, {499, 2}, {1000, 5}, {1500, 10}}},
+    {binanceendpointid::IndexPriceKlines, "/fapi/v1/indexPriceKlines", "GET", false, false, 10, 0, 1, 1500,
+     {}, {{99, 1}, {499, 2}, {1000, 5}, {1500, 10}}},
+    {binanceendpointid::MarkPriceKlines, "/fapi/v1/markPriceKlines", "GET", false, false, 10, 0, 1, 1500,
+     {}, {{99, 1}, {499, 2}, {1000, 5}, {1500, 10}}},
+    {binanceendpointid::PremiumIndex, "/fapi/v1/premiumIndex", "GET", false, false, 1, 10, 0, 0, {}, {}},
+    {binanceendpointid::FundingRate, "/fapi/v1/fundingRate", "GET", false, false, 1, 0, 1, 1000, {}, {}},
+    {binanceendpointid::Ticker24hr, "/fapi/v1/ticker/24hr", "GET", false, false, 1, 40, 0, 0, {}, {}},
+    {binanceendpointid::LatestPrice, "/fapi/v1/ticker/price", "GET", false, false, 1, 2, 0, 0, {}, {}},
+    {binanceendpointid::BookTicker, "/fapi/v1/ticker/bookTicker", "GET", false, false, 2, 5, 0, 0, {}, {}},
+    {binanceendpointid::OpenInterest, "/fapi/v1/openInterest", "GET", false, false, 1, 0, 0, 0, {}, {}},
+    {binanceendpointid::OpenInterestHist, "/futures/data/openInterestHist", "GET", false, false, 1, 0, 1, 500, {}, {}},
+    {binanceendpointid::TopLongShortAccountRatio, "/futures/data/topLongShortAccountRatio", "GET", false, false, 1, 0, 1, 500, {}, {}},
+    {binanceendpointid::TopLongShortPositionRatio, "/futures/data/topLongShortPositionRatio", "GET", false, false, 1, 0, 1, 500, {}, {}},
+    {binanceendpointid::GlobalLongShortAccountRatio, "/futures/data/globalLongShortAccountRatio", "GET", false, false, 1, 0, 1, 500, {}, {}},
+    {binanceendpointid::TakerLongShortRatio, "/futures/data/takerlongshortRatio", "GET", false, false, 1, 0, 1, 500, {}, {}},
+    {binanceendpointid::LvtKlines, "/fapi/v1/lvtKlines", "GET", false, false, 1, 0, 1, 1000, {}, {}},
+    {binanceendpointid::IndexInfo, "/fapi/v1/indexInfo", "GET", false, false, 1, 0, 0, 0, {}, {}},
+    {binanceendpointid::AssetIndex, "/fapi/v1/assetIndex", "GET", false, false, 1, 10, 0, 0, {}, {}},
+    {binanceendpointid::ChangePositionMode, "/fapi/v1/positionSide/dual", "POST", false, true, 1, 0, 0, 0, {}, {}},
+    {binanceendpointid::PositionMode, "/fapi/v1/positionSide/dual", "GET", false, true, 30, 0, 0, 0, {}, {}},
+    {binanceendpointid::ChangeMultiAssetsMode, "/fapi/v1/multiAssetsMargin", "POST", false, true, 1, 0, 0, 0, {}, {}},
+    {binanceendpointid::NewOrder, "/fapi/v1/order", "POST", false, true, 0, 0, 0, 0, {}, {}},
+    {binanceendpointid::ModifyOrder, "/fapi/v1/order", "PUT", false, true, 1, 0, 0, 0, {}, {}},
+    {binanceendpointid::QueryOrder, "/fapi/v1/order", "GET", false, true, 1, 0, 0, 0, {}, {}},
+    {binanceendpointid::CancelOrder, "/fapi/v1/order", "DELETE", false, true, 1, 0, 0, 0, {}, {}},
+    {binanceendpointid::BatchOrders, "/fapi/v1/batchOrders", "POST", false, true, 5, 0, 0, 0, {}, {}},
+    {binanceendpointid::BatchModifyOrders, "/fapi/v1/batchOrders", "PUT", false, true, 5, 0, 0, 0, {}, {}},
+    {binanceendpointid::CancelBatchOrders, "/fapi/v1/batchOrders", "DELETE", false, true, 1, 0, 0, 0, {}, {}},
+    {binanceendpointid::OrderAmendmentHistory, "/fapi/v1/orderAmendment", "GET", false, true, 1, 0, 1, 100, {}, {}},
+    {binanceendpointid::CancelAllOpenOrders, "/fapi/v1/allOpenOrders", "DELETE", false, true, 1, 0, 0, 0, {}, {}},
+    {binanceendpointid::CountdownCancelAll, "/fapi/v1/countdownCancelAll", "POST", false, true, 10, 0, 0, 0, {}, {}},
+    {binanceendpointid::OpenOrder, "/fapi/v1/openOrder", "GET", false, true, 1, 0, 0, 0, {}, {}},
+    {binanceendpointid::OpenOrders, "/fapi/v1/openOrders", "GET", false, true, 1, 40, 0, 0, {}, {}},
+    {binanceendpointid::AllOrders, "/fapi/v1/allOrders", "GET", false, true, 5, 0, 1, 1000, {}, {}},
+    {binanceendpointid::Balance, "/fapi/v2/balance", "GET", false, true, 5, 0, 0, 0, {}, {}},
+    {binanceendpointid::Account, "/fapi/v2/account", "GET", false, true, 5, 0, 0, 0, {}, {}},
+    {binanceendpointid::ChangeLeverage, "/fapi/v1/leverage", "POST", false, true, 1, 0, 0, 0, {}, {}},
+    {binanceendpointid::ChangeMarginType, "/fapi/v1/marginType", "POST", false, true, 1, 0, 0, 0, {}, {}},
+    {binanceendpointid::PositionMargin, "/fapi/v1/positionMargin", "POST", false, true, 1, 0, 0, 0, {}, {}},
+    {binanceendpointid::PositionMarginHistory, "/fapi/v1/positionMargin/history", "GET", false, true, 1, 0, 1, 500, {}, {}},
+    {binanceendpointid::PositionRisk, "/fapi/v2/positionRisk", "GET", false, true, 5, 0, 0, 0, {}, {}},
+    {binanceendpointid::UserTrades, "/fapi/v1/userTrades", "GET", false, true, 5, 0, 1, 1000, {}, {}},
+    {binanceendpointid::Income, "/fapi/v1/income", "GET", false, true, 30, 0, 1, 1000, {}, {}},
+    {binanceendpointid::LeverageBracket, "/fapi/v1/leverageBracket", "GET", false, true, 1, 0, 0, 0, {}, {}},
+    {binanceendpointid::AdlQuantile, "/fapi/v1/adlQuantile", "GET", false, true, 5, 0, 0, 0, {}, {}},
+    {binanceendpointid::ForceOrders, "/fapi/v1/forceOrders", "GET", false, true, 20, 50, 1, 100, {}, {}},
+    {binanceendpointid::ApiTradingStatus, "/fapi/v1/apiTradingStatus", "GET", false, true, 1, 10, 0, 0, {}, {}},
+    {binanceendpointid::CommissionRate, "/fapi/v1/commissionRate", "GET", false, true, 20, 0, 0, 0, {}, {}},
+    {binanceendpointid::CreateListenKey, "/fapi/v1/listenKey", "POST", false, false, 1, 0, 0, 0, {}, {}},
+    {binanceendpointid::ExtendListenKey, "/fapi/v1/listenKey", "PUT", false, false, 1, 0, 0, 0, {}, {}},
+    {binanceendpointid::CloseListenKey, "/fapi/v1/listenKey", "DELETE", false, false, 1, 0, 0, 0, {}, {}},
+    {binanceendpointid::SpotAccount, "/api/v3/account", "GET", true, true, 20, 0, 0, 0, {}, {}},
+};
+
+constexpr const binanceendpoint& binanceendpointspec(binanceendpointid id) {
+    return binanceendpoints[int(id)];
+}
+
+// Single-return recursions so the helpers stay constexpr under C++11.
+constexpr bool binanceendpointsordered(int at = 0) {
+    return at == int(binanceendpointid::Count) ||
+           (int(binanceendpoints[at].id) == at && binanceendpointsordered(at + 1));
+}
+
+static_assert(int(sizeof(binanceendpoints) / sizeof(binanceendpoint)) == int(binanceendpointid::Count),
+              "binanceendpoints needs one entry per binanceendpointid");
+static_assert(binanceendpointsordered(), "binanceendpoints must be ordered by id");
+
+constexpr bool binanceendpointlimitlisted(const binanceendpoint& endpoint, int limit, int at = 0) {
+    return at < 8 && endpoint.limits[at] != 0 &&
+           (endpoint.limits[at] == limit || binanceendpointlimitlisted(endpoint, limit, at + 1));
+}
+
+constexpr bool binanceendpointlimitvalid(const binanceendpoint& endpoint, int limit) {
+    return endpoint.limits[0] != 0 ? binanceendpointlimitlisted(endpoint, limit)
+                                   : limit >= endpoint.minLimit && limit <= endpoint.maxLimit;
+}
+
+constexpr int binanceendpointweight(const binanceendpoint& endpoint, int limit, bool allSymbols = false, int at = 0) {
+    return allSymbols && endpoint.allSymbolsWeight > 0 ? endpoint.allSymbolsWeight
+         : at < 4 && endpoint.weightTiers[at][0] != 0
+               ? (limit <= endpoint.weightTiers[at][0] ? endpoint.weightTiers[at][1]
+                                                       : binanceendpointweight(endpoint, limit, false, at + 1))
+               : endpoint.weight;
+}
+
+static_assert(binanceendpointlimitvalid(binanceendpointspec(binanceendpointid::Depth), 500) &&
+              !binanceendpointlimitvalid(binanceendpointspec(binanceendpointid::Depth), 30),
+              "depth limits are a set");
+static_assert(binanceendpointweight(binanceendpointspec(binanceendpointid::Klines), 1500) == 10 &&
+              binanceendpointweight(binanceendpointspec(binanceendpointid::Depth), 5) == 2,
+              "weight tiers");
+
+#endif // BINANCEENDPOINTS_H
@@ -0,0 +1,216 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#include "binanceheartbeat.h"
+#include "binanceapi.h"
+#include "binanceorders.h"
+#include "binancemetrics.h"
+#include "binancetracer.h"
+#include "binancelogger.h"
+#include <QDateTime>
+
+binanceheartbeatlane::binanceheartbeatlane(const QString& apiKey, const QString& apiSecret, qint64 countdownMs, int intervalMs)
+    : apiKey(apiKey), apiSecret(apiSecret), countdownMs(countdownMs), intervalNs(qint64(intervalMs) * 1000000),
+      api(nullptr), metrics(nullptr), tracer(nullptr), logger(nullptr), timer(nullptr), nextDeadlineNs(0) {
+}
+
+void binanceheartbeatlane::start() {
+    // Created here so the network manager and sockets belong to this thread.
+    if (!api) {
+        api = new binanceapi(apiKey, apiSecret, this);
+        api->setObjectName("heartbeat");
+        api->setMetrics(metrics);
+        api->setTracer(tracer);
+        api->setLogger(logger);
+        connect(api, &binanceapi::countdownCancelAllReceived, this, &binanceheartbeatlane::handleAcknowledged);
+        connect(api, &binanceapi::countdownCancelAllFailed, this, &binanceheartbeatlane::handleFailed);
+        timer = new QTimer(this);
+        timer->setSingleShot(true);
+        timer->setTimerType(Qt::PreciseTimer);
+        connect(timer, &QTimer::timeout, this, &binanceheartbeatlane::tick);
+    }
+    clock.start();
+    nextDeadlineNs = 0;
+    tick();
+}
+
+void binanceheartbeatlane::stop() {
+    if (timer) {
+        timer->stop();
+    }
+}
+
+void binanceheartbeatlane::addSymbol(const QString& symbol) {
+    if (symbols.contains(symbol)) {
+        return;
+    }
+    Entry& entry = symbols[symbol];
+    // Arm the countdown right away, new orders should not wait for the next tick.
+    if (timer && timer->isActive()) {
+        refresh(symbol, entry);
+    }
+}
+
+void binanceheartbeatlane::removeSymbol(const QString& symbol) {
+    if (symbols.remove(symbol) && api) {
+        api->countdownCancelAll(symbol, 0, -1, QDateTime::currentMSecsSinceEpoch());
+    }
+}
+
+void binanceheartbeatlane::setMetrics(binancemetrics* metrics) {
+    this->metrics = metrics;
+    if (api) {
+        api->setMetrics(metrics);
+    }
+}
+
+void binanceheartbeatlane::setTracer(binancetracer* tracer) {
+    this->tracer = tracer;
+    if (api) {
+        api->setTracer(tracer);
+    }
+}
+
+void binanceheartbeatlane::setLogger(binancelogger* logger) {
+    this->logger = logger;
+    if (api) {
+        api->setLogger(logger);
+    }
+}
+
+void binanceheartbeatlane::tick() {
+    qint64 now = clock.nsecsElapsed();
+    if (now - nextDeadlineNs >= intervalNs) {
+        qint64 skipped = (now - nextDeadlineNs) / intervalNs;
+        for (auto it = symbols.constBegin(); it != symbols.constEnd(); ++it) {
+            miss(it.key(), QString("timer late, %1 refresh(es) skipped").arg(skipped));
+        }
+        nextDeadlineNs += skipped * intervalNs;
+    }
+
+    for (auto it = symbols.begin(); it != symbols.end(); ++it) {
+        if (it.value().pending) {
+            miss(it.key(), "no response before the next refresh");
+        }
+        refresh(it.key(), it.value());
+    }
+
+    nextDeadlineNs += intervalNs;
+    qint64 wait = nextDeadlineNs - clock.nsecsElapsed();
+    timer->start(int(qMax<qint64>(0, (wait + 999999) / 1000000)));
+}
+
+void binanceheartbeatlane::refresh(const QString& symbol, Entry& entry) {
+    entry.pending = true;
+    entry.sentNs = clock.nsecsElapsed();
+    api->countdownCancelAll(symbol, countdownMs, -1, QDateTime::currentMSecsSinceEpoch());
+}
+
+void binanceheartbeatlane::handleAcknowledged(const QString& symbol, const QJsonObject& result) {
+    Q_UNUSED(result);
+    auto it = symbols.find(symbol);
+    if (it == symbols.end() || !it.value().pending) {
+        return;
+    }
+    it.value().pending = false;
+    emit acknowledged(symbol, (clock.nsecsElapsed() - it.value().sentNs) / 1000);
+}
+
+void binanceheartbeatlane::handleFailed(const QString& symbol, int code, const QString& message) {
+    auto it = symbols.find(symbol);
+    if (it == symbols.end()) {
+        return;
+    }
+    it.value().pending = false;
+    miss(symbol, QString("%1 %2").arg(code).arg(message));
+}
+
+void binanceheartbeatlane::miss(const QString& symbol, const QString& reason) {
+    if (api) {
+        api->logMessage(binancelogger::Warning, "Heartbeat missed:", 0, symbol + ' ' + reason);
+    }
+    emit missed(symbol, reason);
+}
+
+binanceheartbeat::binanceheartbeat(const QString& apiKey, const QString& apiSecret, qint64 countdownMs, int intervalMs,
+                                   QObject* parent)
+    : QObject(parent),
+      lane(new binanceheartbeatlane(apiKey, apiSecret, countdownMs, intervalMs > 0 ? intervalMs : int(qMax<qint64>(1, countdownMs / 4)))) {
+    lane->moveToThread(&thread);
+    connect(&thread, &QThread::finished, lane, &QObject::deleteLater);
+    connect(lane, &binanceheartbeatlane::acknowledged, this, &binanceheartbeat::handleAcknowledged);
+    connect(lane, &binanceheartbeatlane::missed, this, &binanceheartbeat::handleMissed);
+    thread.setObjectName("heartbeat");
+    thread.start(QThread::TimeCriticalPriority);
+}
+
+binanceheartbeat::~binanceheartbeat() {
+    thread.quit();
+    thread.wait();
+}
+
+void binanceheartbeat::setOrders(binanceorders* orders) {
+    connect(orders, &binanceorders::exposureChanged, this, &binanceheartbeat::handleExposureChanged);
+    for (const QString& symbol : orders->symbolsWithOpenOrders()) {
+        addSymbol(symbol);
+    }
+}
+
+void binanceheartbeat::setMetrics(binancemetrics* metrics) {
+    qRegisterMetaType<binancemetrics*>("binancemetrics*");
+    QMetaObject::invokeMethod(lane, "setMetrics", Qt::QueuedConnection, Q_ARG(binancemetrics*, metrics));
+}
+
+void binanceheartbeat::setTracer(binancetracer* tracer) {
+    qRegisterMetaType<binancetracer*>("binancetracer*");
+    QMetaObject::invokeMethod(lane, "setTracer", Qt::QueuedConnection, Q_ARG(binancetracer*, tracer));
+}
+
+void binanceheartbeat::setLogger(binancelogger* logger) {
+    qRegisterMetaType<binancelogger*>("binancelogger*");
+    QMetaObject::invokeMethod(lane, "setLogger", Qt::QueuedConnection, Q_ARG(binancelogger*, logger));
+}
+
+void binanceheartbeat::start() {
+    QMetaObject::invokeMethod(lane, "start", Qt::QueuedConnection);
+}
+
+void binanceheartbeat::stop() {
+    QMetaObject::invokeMethod(lane, "stop", Qt::QueuedConnection);
+}
+
+void binanceheartbeat::addSymbol(const QString& symbol) {
+    QMetaObject::invokeMethod(lane, "addSymbol", Qt::QueuedConnection, Q_ARG(QString, symbol));
+}
+
+void binanceheartbeat::removeSymbol(const QString& symbol) {
+    QMetaObject::invokeMethod(lane, "removeSymbol", Qt::QueuedConnection, Q_ARG(QString, symbol));
+}
+
+binanceheartbeat::Stats binanceheartbeat::stats(const QString& symbol) const {
+    return counters.value(symbol);
+}
+
+void binanceheartbeat::handleExposureChanged(const QString& symbol, bool hasOpenOrders) {
+    if (hasOpenOrders) {
+        addSymbol(symbol);
+    } else {
+        removeSymbol(symbol);
+    }
+}
+
+void binanceheartbeat::handleAcknowledged(const QString& symbol, qint64 rttUs) {
+    Stats& stat = counters[symbol];
+    ++stat.acknowledged;
+    stat.lastRttUs = rttUs;
+    stat.maxRttUs = qMax(stat.maxRttUs, rttUs);
+    emit heartbeatAcknowledged(symbol, rttUs);
+}
+
+void binanceheartbeat::handleMissed(const QString& symbol, const QString& reason) {
+    ++counters[symbol].missed;
+    emit heartbeatMissed(symbol, reason);
+}
@@ -0,0 +1,119 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#ifndef BINANCEHEARTBEAT_H
+#define BINANCEHEARTBEAT_H
+
+#include <QObject>
+#include <QHash>
+#include <QThread>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QJsonObject>
+
+class binanceapi;
+class binanceorders;
+class binancemetrics;
+class binancetracer;
+class binancelogger;
+
+// Runs on the heartbeat thread with its own binanceapi, so refreshes never
+// queue behind market data or order traffic. Deadlines are absolute
+// (start + n * interval); a late timer does not push later refreshes out.
+class binanceheartbeatlane : public QObject {
+    Q_OBJECT
+public:
+    binanceheartbeatlane(const QString& apiKey, const QString& apiSecret, qint64 countdownMs, int intervalMs);
+
+public slots:
+    void start();
+    void stop();
+    void addSymbol(const QString& symbol);
+    void removeSymbol(const QString& symbol);
+    void setMetrics(binancemetrics* metrics);
+    void setTracer(binancetracer* tracer);
+    void setLogger(binancelogger* logger);
+
+signals:
+    void acknowledged(const QString& symbol, qint64 rttUs);
+    void missed(const QString& symbol, const QString& reason);
+
+private slots:
+    void tick();
+    void handleAcknowledged(const QString& symbol, const QJsonObject& result);
+    void handleFailed(const QString& symbol, int code, const QString& message);
+
+private:
+    struct Entry {
+        qint64 sentNs = 0;
+        bool pending = false;
+    };
+
+    void refresh(const QString& symbol, Entry& entry);
+    void miss(const QString& symbol, const QString& reason);
+
+    QString apiKey;
+    QString apiSecret;
+    qint64 countdownMs;
+    qint64 intervalNs;
+    binanceapi* api;
+    binancemetrics* metrics;
+    binancetracer* tracer;
+    binancelogger* logger;
+    QTimer* timer;
+    QElapsedTimer clock;
+    qint64 nextDeadlineNs;
+    QHash<QString, Entry> symbols;
+};
+
+// Dead man's switch on countdownCancelAll. Every symbol with live orders has
+// its countdown refreshed well inside countdownMs; if this process hangs or
+// loses the network the exchange cancels those orders on its own. With
+// setOrders() the symbol list follows the order manager's exposure.
+class binanceheartbeat : public QObject {
+    Q_OBJECT
+public:
+    struct Stats {
+        qint64 acknowledged = 0;
+        qint64 missed = 0;
+        qint64 lastRttUs = 0;
+        qint64 maxRttUs = 0;
+    };
+
+    //intervalMs defaults to a quarter of the countdown
+    binanceheartbeat(const QString& apiKey, const QString& apiSecret, qint64 countdownMs = 10000,
+                     int intervalMs = -1, QObject* parent = nullptr);
+    ~binanceheartbeat();
+
+    void setOrders(binanceorders* orders);
+    //lane "heartbeat", recorded from the heartbeat thread
+    void setMetrics(binancemetrics* metrics);
+    void setTracer(binancetracer* tracer);
+    //misses are logged from the heartbeat thread
+    void setLogger(binancelogger* logger);
+    void start();
+    //stops refreshing; countdowns already armed still fire
+    void stop();
+    void addSymbol(const QString& symbol);
+    void removeSymbol(const QString& symbol);
+    Stats stats(const QString& symbol) const;
+
+signals:
+    void heartbeatAcknowledged(const QString& symbol, qint64 rttUs);
+    void heartbeatMissed(const QString& symbol, const QString& reason);
+
+private slots:
+    void handleExposureChanged(const QString& symbol, bool hasOpenOrders);
+    void handleAcknowledged(const QString& symbol, qint64 rttUs);
+    void handleMissed(const QString& symbol, const QString& reason);
+
+private:
+    QThread thread;
+    binanceheartbeatlane* lane;
+    QHash<QString, Stats> counters;
+};
+
+#endif // BINANCEHEARTBEAT_H
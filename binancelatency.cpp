@@ -0,0 +1,195 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#include "binancelatency.h"
+#include <QMutexLocker>
+#include <QJsonArray>
+#include <QtAlgorithms>
+#include <chrono>
+#include <limits>
+
+binancehistogram::binancehistogram() {
+    reset();
+}
+
+int binancehistogram::indexOf(qint64 valueUs) {
+    if (valueUs < 0) {
+        valueUs = 0;
+    }
+    if (valueUs < 2 * subBucketHalf) {
+        return int(valueUs);
+    }
+    int exponent = 63 - int(qCountLeadingZeroBits(quint64(valueUs))) - 6;
+    int index = exponent * subBucketHalf + int(valueUs >> exponent);
+    return index < bucketCount ? index : bucketCount - 1;
+}
+
+qint64 binancehistogram::valueAt(int index) {
+    if (index < subBucketHalf) {
+        return index;
+    }
+    int exponent = (index - subBucketHalf) / subBucketHalf;
+    return qint64(index - exponent * subBucketHalf) << exponent;
+}
+
+void binancehistogram::record(qint64 valueUs) {
+    if (valueUs < 0) {
+        valueUs = 0;
+    }
+    counts[indexOf(valueUs)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(quint64(valueUs), std::memory_order_relaxed);
+
+    qint64 current = minimum.load(std::memory_order_relaxed);
+    while (valueUs < current && !minimum.compare_exchange_weak(current, valueUs, std::memory_order_relaxed)) {
+    }
+    current = maximum.load(std::memory_order_relaxed);
+    while (valueUs > current && !maximum.compare_exchange_weak(current, valueUs, std::memory_order_relaxed)) {
+    }
+}
+
+void binancehistogram::reset() {
+    for (int i = 0; i < bucketCount; ++i) {
+        counts[i].store(0, std::memory_order_relaxed);
+    }
+    total.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    minimum.store(std::numeric_limits<qint64>::max(), std::memory_order_relaxed);
+    maximum.store(0, std::memory_order_relaxed);
+}
+
+qint64 binancehistogram::count() const {
+    return qint64(total.load(std::memory_order_relaxed));
+}
+
+qint64 binancehistogram::min() const {
+    return count() ? minimum.load(std::memory_order_relaxed) : 0;
+}
+
+qint64 binancehistogram::max() const {
+    return maximum.load(std::memory_order_relaxed);
+}
+
+double binancehistogram::mean() const {
+    qint64 n = count();
+    return n ? double(sum.load(std::memory_order_relaxed)) / n : 0.0;
+}
+
+qint64 binancehistogram::percentile(double percent) const {
+    quint64 n = total.load(std::memory_order_relaxed);
+    if (n == 0) {
+        return 0;
+    }
+    quint64 rank = quint64(percent / 100.0 * n + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+    quint64 seen = 0;
+    for (int i = 0; i < bucketCount; ++i) {
+        seen += counts[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return qMin(valueAt(i), max());
+        }
+    }
+    return max();
+}
+
+QJsonObject binancehistogram::toJson() const {
+    QJsonObject json;
+    json.insert("count", count());
+    json.insert("min", min());
+    json.insert("mean", mean());
+    json.insert("p50", percentile(50.0));
+    json.insert("p90", percentile(90.0));
+    json.insert("p99", percentile(99.0));
+    json.insert("p999", percentile(99.9));
+    json.insert("max", max());
+    return json;
+}
+
+binancelatency::binancelatency(QObject* parent)
+    : QObject(parent) {
+}
+
+binancelatency::~binancelatency() {
+    qDeleteAll(histograms);
+}
+
+binancehistogram* binancelatency::histogram(const QString& name) {
+    QMutexLocker locker(&mutex);
+    binancehistogram*& histogram = histograms[name];
+    if (!histogram) {
+        histogram = new binancehistogram;
+    }
+    return histogram;
+}
+
+QStringList binancelatency::names() const {
+    QMutexLocker locker(&mutex);
+    QStringList list = histograms.keys();
+    list.sort();
+    return list;
+}
+
+void binancelatency::reset() {
+    QMutexLocker locker(&mutex);
+    for (binancehistogram* histogram : qAsConst(histograms)) {
+        histogram->reset();
+    }
+}
+
+binancelatency::Stream binancelatency::stream(const QString& name) {
+    Stream stream;
+    stream.event = histogram("stream/" + name + "/event");
+    stream.transaction = histogram("stream/" + name + "/transaction");
+    return stream;
+}
+
+binancehistogram* binancelatency::firstByte(const char* handler) {
+    return histogram(QLatin1String("rest/") + QLatin1String(handler) + QLatin1String("/firstByte"));
+}
+
+binancehistogram* binancelatency::decode(const char* handler) {
+    return histogram(QLatin1String("rest/") + QLatin1String(handler) + QLatin1String("/decode"));
+}
+
+void binancelatency::recordStreamEvent(const Stream& stream, const QJsonObject& event, qint64 receiveUs) {
+    auto time = event.constFind("E");
+    if (time != event.constEnd()) {
+        stream.event->record(receiveUs - qint64(time.value().toDouble()) * 1000);
+    }
+    time = event.constFind("T");
+    if (time != event.constEnd()) {
+        stream.transaction->record(receiveUs - qint64(time.value().toDouble()) * 1000);
+    }
+}
+
+QJsonObject binancelatency::toJson() const {
+    QMutexLocker locker(&mutex);
+    QJsonObject json;
+    for (auto it = histograms.constBegin(); it != histograms.constEnd(); ++it) {
+        json.insert(it.key(), it.value()->toJson());
+    }
+    return json;
+}
+
+QString binancelatency::toText() const {
+    QString text = QString("%1 %2 %3 %4 %5 %6 %7\n").arg("name", -64).arg("count", 10).arg("p50us", 10)
+                       .arg("p90us", 10).arg("p99us", 10).arg("p999us", 10).arg("maxus", 10);
+    QMutexLocker locker(&mutex);
+    QStringList keys = histograms.keys();
+    keys.sort();
+    for (const QString& key : qAsConst(keys)) {
+        const binancehistogram* h = histograms.value(key);
+        text += QString("%1 %2 %3 %4 %5 %6 %7\n").arg(key, -64).arg(h->count(), 10).arg(h->percentile(50.0), 10)
+                    .arg(h->percentile(90.0), 10).arg(h->percentile(99.0), 10).arg(h->percentile(99.9), 10).arg(h->max(), 10);
+    }
+    return text;
+}
+
+qint64 binancelatency::nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
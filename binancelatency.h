@@ -0,0 +1,87 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#ifndef BINANCELATENCY_H
+#define BINANCELATENCY_H
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QJsonObject>
+#include <atomic>
+
+// Log-linear (HDR style) histogram of microsecond values with 64 linear
+// sub-buckets per power of two, i.e. better than 1.6% relative precision.
+// record() is lock-free (min/max are CAS loops) and may be called from any thread.
+class binancehistogram {
+public:
+    binancehistogram();
+
+    void record(qint64 valueUs);
+    void reset();
+
+    qint64 count() const;
+    qint64 min() const;
+    qint64 max() const;
+    double mean() const;
+    qint64 percentile(double percent) const;
+    QJsonObject toJson() const;
+
+private:
+    static const int subBucketHalf = 64;
+    static const int bucketCount = 64 * 36;
+
+    static int indexOf(qint64 valueUs);
+    static qint64 valueAt(int index);
+
+    std::atomic<quint64> counts[bucketCount];
+    std::atomic<quint64> total;
+    std::atomic<quint64> sum;
+    std::atomic<qint64> minimum;
+    std::atomic<qint64> maximum;
+};
+
+// Named latency histograms per stream and endpoint:
+//   stream/<name>/event        local receive time - exchange event time (E)
+//   stream/<name>/transaction  local receive time - transaction time (T)
+//   rest/<handler>/firstByte   request sent - response headers received
+//   rest/<handler>/decode      time spent in the response handler
+//
+// Lookups by name take the mutex and build the name; callers resolve a
+// histogram once per stream or handler and record into the pointer, which
+// stays valid for the lifetime of the object.
+class binancelatency : public QObject {
+    Q_OBJECT
+public:
+    struct Stream {
+        binancehistogram* event = nullptr;
+        binancehistogram* transaction = nullptr;
+    };
+
+    explicit binancelatency(QObject* parent = nullptr);
+    ~binancelatency();
+
+    binancehistogram* histogram(const QString& name);
+    QStringList names() const;
+    void reset();
+
+    Stream stream(const QString& name);
+    binancehistogram* firstByte(const char* handler);
+    binancehistogram* decode(const char* handler);
+    //E and T of the event against receiveUs; no lock
+    static void recordStreamEvent(const Stream& stream, const QJsonObject& event, qint64 receiveUs);
+
+    QJsonObject toJson() const;
+    QString toText() const;
+
+    static qint64 nowUs();
+
+private:
+    mutable QMutex mutex;
+    QHash<QString, binancehistogram*> histograms;
+};
+
+#endif // BINANCELATENCY_H
@@ -0,0 +1,421 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#include "binancelocalserver.h"
+#include <QPointer>
+#include <QUrlQuery>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QRandomGenerator>
+#include <QDebug>
+
+binancelocalserver::binancelocalserver(QObject* parent)
+    : QObject(parent), streams("binancelocalserver", QWebSocketServer::NonSecureMode) {
+    connect(&http, &QTcpServer::newConnection, this, &binancelocalserver::acceptHttp);
+    connect(&streams, &QWebSocketServer::newConnection, this, &binancelocalserver::acceptStream);
+    connect(&mock, &binancemockexchange::orderChanged, this, &binancelocalserver::publishOrder);
+    publisher.setInterval(100);
+    connect(&publisher, &QTimer::timeout, this, &binancelocalserver::publish);
+}
+
+bool binancelocalserver::listen(quint16 httpPort, quint16 streamPort, const QHostAddress& address) {
+    if (!http.listen(address, httpPort)) {
+        qDebug() << "Local server: cannot listen for HTTP:" << http.errorString();
+        return false;
+    }
+    if (!streams.listen(address, streamPort)) {
+        qDebug() << "Local server: cannot listen for streams:" << streams.errorString();
+        http.close();
+        return false;
+    }
+    publisher.start();
+    qDebug() << "Local server:" << restUrl() << streamUrl();
+    return true;
+}
+
+void binancelocalserver::close() {
+    publisher.stop();
+    disconnectStreams();
+    streams.close();
+    http.close();
+}
+
+QString binancelocalserver::restUrl() const {
+    return QString("http://%1:%2").arg(http.serverAddress().toString()).arg(http.serverPort());
+}
+
+QString binancelocalserver::streamUrl() const {
+    return QString("ws://%1:%2").arg(streams.serverAddress().toString()).arg(streams.serverPort());
+}
+
+QString binancelocalserver::webSocketApiUrl() const {
+    return streamUrl() + "/ws-fapi/v1";
+}
+
+void binancelocalserver::setFaults(const Faults& faults) {
+    config = faults;
+}
+
+binancelocalserver::Faults binancelocalserver::faults() const {
+    return config;
+}
+
+void binancelocalserver::setStreamInterval(int msec) {
+    publisher.setInterval(msec);
+}
+
+void binancelocalserver::disconnectStreams() {
+    const QList<QWebSocket*> sockets = kinds.keys();
+    for (QWebSocket* socket : sockets) {
+        socket->abort();
+    }
+}
+
+binancemockexchange* binancelocalserver::exchange() {
+    return &mock;
+}
+
+bool binancelocalserver::roll(double rate) const {
+    return rate > 0.0 && QRandomGenerator::global()->generateDouble() < rate;
+}
+
+int binancelocalserver::latency() const {
+    if (config.maxLatencyMs <= config.minLatencyMs) {
+        return config.minLatencyMs;
+    }
+    return QRandomGenerator::global()->bounded(config.minLatencyMs, config.maxLatencyMs + 1);
+}
+
+QByteArray binancelocalserver::injectedFault(int* httpStatus) const {
+    if (roll(config.rateLimitRate)) {
+        *httpStatus = 429;
+        return "{\"code\":-1003,\"msg\":\"Too many requests; current limit is 2400 request weight per 1 MINUTE.\"}";
+    }
+    if (roll(config.errorRate)) {
+        *httpStatus = 500;
+        return "{\"code\":-1001,\"msg\":\"Internal error; unable to process your request. Please try again.\"}";
+    }
+    return QByteArray();
+}
+
+void binancelocalserver::acceptHttp() {
+    while (http.hasPendingConnections()) {
+        QTcpSocket* socket = http.nextPendingConnection();
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { readHttp(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            buffers.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void binancelocalserver::readHttp(QTcpSocket* socket) {
+    buffers[socket] += socket->readAll();
+    for (;;) {
+        QByteArray& buffer = buffers[socket];
+        int headerEnd = buffer.indexOf("\r\n\r\n");
+        if (headerEnd < 0) {
+            return;
+        }
+        const QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+        const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+        if (requestLine.size() < 2) {
+            socket->abort();
+            return;
+        }
+        int contentLength = 0;
+        for (int i = 1; i < lines.size(); ++i) {
+            int colon = lines.at(i).indexOf(':');
+            if (colon > 0 && lines.at(i).left(colon).trimmed().toLower() == "content-length") {
+                contentLength = lines.at(i).mid(colon + 1).trimmed().toInt();
+            }
+        }
+        if (buffer.size() < headerEnd + 4 + contentLength) {
+            return;
+        }
+        QByteArray body = buffer.mid(headerEnd + 4, contentLength);
+        buffer.remove(0, headerEnd + 4 + contentLength);
+        if (!serve(socket, requestLine.at(0), requestLine.at(1), body)) {
+            return;
+        }
+    }
+}
+
+bool binancelocalserver::serve(QTcpSocket* socket, const QByteArray& method, const QByteArray& target, const QByteArray& body) {
+    QUrl url = QUrl::fromEncoded("http://localhost" + target);
+    const QString path = url.path();
+    if (roll(config.disconnectRate)) {
+        emit requestServed(QString::fromLatin1(method), path, 0);
+        socket->abort();
+        return false;
+    }
+
+    int httpStatus = 200;
+    QByteArray response = injectedFault(&httpStatus);
+    if (response.isEmpty()) {
+        QNetworkAccessManager::Operation operation = QNetworkAccessManager::GetOperation;
+        if (method == "POST") {
+            operation = QNetworkAccessManager::PostOperation;
+        } else if (method == "PUT") {
+            operation = QNetworkAccessManager::PutOperation;
+        } else if (method == "DELETE") {
+            operation = QNetworkAccessManager::DeleteOperation;
+        }
+        response = mock.respond(operation, path, binancemockexchange::parameters(url, body), &httpStatus);
+    }
+    emit requestServed(QString::fromLatin1(method), path, httpStatus);
+
+    int delay = latency();
+    if (delay > 0) {
+        QPointer<QTcpSocket> guard(socket);
+        QTimer::singleShot(delay, this, [this, guard, httpStatus, response]() {
+            if (guard) {
+                writeResponse(guard, httpStatus, response);
+            }
+        });
+    } else {
+        writeResponse(socket, httpStatus, response);
+    }
+    return true;
+}
+
+void binancelocalserver::writeResponse(QTcpSocket* socket, int httpStatus, const QByteArray& body) {
+    const char* reason = "OK";
+    switch (httpStatus) {
+    case 400: reason = "Bad Request"; break;
+    case 401: reason = "Unauthorized"; break;
+    case 403: reason = "Forbidden"; break;
+    case 404: reason = "Not Found"; break;
+    case 418: reason = "I'm a teapot"; break;
+    case 429: reason = "Too Many Requests"; break;
+    case 500: reason = "Internal Server Error"; break;
+    case 503: reason = "Service Unavailable"; break;
+    default: break;
+    }
+    QByteArray head = "HTTP/1.1 " + QByteArray::number(httpStatus) + ' ' + reason + "\r\n"
+                      "Content-Type: application/json\r\n"
+                      "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    if (httpStatus == 429) {
+        head += "Retry-After: 1\r\n";
+    }
+    head += "Connection: keep-alive\r\n\r\n";
+    socket->write(head + body);
+}
+
+void binancelocalserver::acceptStream() {
+    while (streams.hasPendingConnections()) {
+        QWebSocket* socket = streams.nextPendingConnection();
+        const QUrl url = socket->requestUrl();
+        const QString path = url.path();
+        StreamKind kind = MarketStream;
+        if (path.startsWith("/ws-fapi")) {
+            kind = ApiStream;
+        } else if (path.startsWith("/ws/")) {
+            kind = UserStream;
+        }
+        kinds.insert(socket, kind);
+
+        // Combined stream URLs may name streams up front: /stream?streams=a/b
+        QString named = QUrlQuery(url).queryItemValue("streams");
+        if (kind == MarketStream && !named.isEmpty()) {
+            const QStringList names = named.split('/');
+            for (const QString& name : names) {
+                if (!name.isEmpty()) {
+                    subscriptions[socket].insert(name);
+                }
+            }
+        }
+
+        connect(socket, &QWebSocket::textMessageReceived, this, [this, socket](const QString& message) {
+            handleStreamMessage(socket, message);
+        });
+        connect(socket, &QWebSocket::disconnected, this, [this, socket]() {
+            kinds.remove(socket);
+            subscriptions.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void binancelocalserver::handleStreamMessage(QWebSocket* socket, const QString& message) {
+    QJsonObject request = QJsonDocument::fromJson(message.toUtf8()).object();
+    StreamKind kind = kinds.value(socket, MarketStream);
+    if (kind == ApiStream) {
+        handleApiRequest(socket, request);
+        return;
+    }
+    if (kind != MarketStream) {
+        return;
+    }
+
+    QString method = request.value("method").toString();
+    QJsonObject reply;
+    reply.insert("id", request.value("id"));
+    if (method == "SUBSCRIBE" || method == "UNSUBSCRIBE") {
+        for (const QJsonValue& name : request.value("params").toArray()) {
+            if (method == "SUBSCRIBE") {
+                subscriptions[socket].insert(name.toString());
+            } else {
+                subscriptions[socket].remove(name.toString());
+            }
+        }
+        reply.insert("result", QJsonValue::Null);
+    } else if (method == "LIST_SUBSCRIPTIONS") {
+        QJsonArray names;
+        for (const QString& name : subscriptions.value(socket)) {
+            names.append(name);
+        }
+        reply.insert("result", names);
+    } else {
+        QJsonObject error;
+        error.insert("code", 2);
+        error.insert("msg", "Invalid request: unknown method");
+        reply.insert("error", error);
+    }
+    socket->sendTextMessage(QString::fromUtf8(QJsonDocument(reply).toJson(QJsonDocument::Compact)));
+}
+
+void binancelocalserver::handleApiRequest(QWebSocket* socket, const QJsonObject& request) {
+    QString method = request.value("method").toString();
+    QNetworkAccessManager::Operation operation = QNetworkAccessManager::GetOperation;
+    if (method == "order.place") {
+        operation = QNetworkAccessManager::PostOperation;
+    } else if (method == "order.modify") {
+        operation = QNetworkAccessManager::PutOperation;
+    } else if (method == "order.cancel") {
+        operation = QNetworkAccessManager::DeleteOperation;
+    }
+
+    int httpStatus = 200;
+    QByteArray body = injectedFault(&httpStatus);
+    if (body.isEmpty()) {
+        if (method.startsWith("order.")) {
+            QUrlQuery params;
+            QJsonObject values = request.value("params").toObject();
+            for (auto it = values.constBegin(); it != values.constEnd(); ++it) {
+                params.addQueryItem(it.key(), it.value().toVariant().toString());
+            }
+            body = mock.respond(operation, "/fapi/v1/order", params, &httpStatus);
+        } else {
+            httpStatus = 400;
+            body = "{\"code\":-1100,\"msg\":\"Unknown method.\"}";
+        }
+    }
+
+    QJsonObject reply;
+    reply.insert("id", request.value("id"));
+    reply.insert("status", httpStatus);
+    QJsonValue result = QJsonDocument::fromJson(body).isArray() ? QJsonValue(QJsonDocument::fromJson(body).array())
+                                                                 : QJsonValue(QJsonDocument::fromJson(body).object());
+    reply.insert(httpStatus == 200 ? "result" : "error", result);
+    emit requestServed(method, "/ws-fapi/v1", httpStatus);
+
+    QByteArray frame = QJsonDocument(reply).toJson(QJsonDocument::Compact);
+    QPointer<QWebSocket> guard(socket);
+    QTimer::singleShot(latency(), this, [guard, frame]() {
+        if (guard) {
+            guard->sendTextMessage(QString::fromUtf8(frame));
+        }
+    });
+}
+
+void binancelocalserver::publish() {
+    // One update per stream and tick, shared by every subscriber, so each of
+    // them sees the same unbroken U/u/pu chain.
+    QHash<QString, QByteArray> frames;
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const QList<QWebSocket*> sockets = subscriptions.keys();
+    for (QWebSocket* socket : sockets) {
+        if (roll(config.disconnectRate)) {
+            socket->abort();
+            continue;
+        }
+        for (const QString& name : subscriptions.value(socket)) {
+            if (!frames.contains(name)) {
+                QString symbol = name.section('@', 0, 0).toUpper();
+                QString type = name.section('@', 1, 1);
+                QJsonValue data;
+                if (type.startsWith("depth")) {
+                    data = mock.nextDepthUpdate(symbol);
+                } else if (name.startsWith("!markPrice@arr")) {
+                    QJsonObject mark;
+                    mark.insert("e", "markPriceUpdate");
+                    mark.insert("E", now);
+                    mark.insert("s", "BTCUSDT");
+                    mark.insert("p", "30000.00");
+                    mark.insert("i", "30000.00");
+                    mark.insert("P", "30000.00");
+                    mark.insert("r", "0.00010000");
+                    mark.insert("T", now - now % (8 * 3600 * 1000) + 8 * 3600 * 1000);
+                    data = QJsonArray{mark};
+                } else if (type == "bookTicker") {
+                    QJsonObject depth = mock.depthSnapshot(symbol, 1);
+                    QJsonArray bid = depth.value("bids").toArray().first().toArray();
+                    QJsonArray ask = depth.value("asks").toArray().first().toArray();
+                    QJsonObject ticker;
+                    ticker.insert("e", "bookTicker");
+                    ticker.insert("u", depth.value("lastUpdateId"));
+                    ticker.insert("E", now);
+                    ticker.insert("T", now);
+                    ticker.insert("s", symbol);
+                    ticker.insert("b", bid.at(0));
+                    ticker.insert("B", bid.at(1));
+                    ticker.insert("a", ask.at(0));
+                    ticker.insert("A", ask.at(1));
+                    data = ticker;
+                } else {
+                    frames.insert(name, QByteArray());
+                    continue;
+                }
+                QJsonObject frame;
+                frame.insert("stream", name);
+                frame.insert("data", data);
+                frames.insert(name, QJsonDocument(frame).toJson(QJsonDocument::Compact));
+            }
+            const QByteArray& frame = frames[name];
+            if (!frame.isEmpty()) {
+                socket->sendTextMessage(QString::fromUtf8(frame));
+            }
+        }
+    }
+}
+
+void binancelocalserver::publishOrder(const QJsonObject& order) {
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QString status = order.value("status").toString();
+    QJsonObject update;
+    update.insert("s", order.value("symbol"));
+    update.insert("c", order.value("clientOrderId"));
+    update.insert("S", order.value("side"));
+    update.insert("o", order.value("type"));
+    update.insert("f", order.value("timeInForce"));
+    update.insert("q", order.value("origQty"));
+    update.insert("p", order.value("price"));
+    update.insert("ap", order.value("avgPrice"));
+    update.insert("x", status == "CANCELED" ? "CANCELED" : "NEW");
+    update.insert("X", status);
+    update.insert("i", order.value("orderId"));
+    update.insert("l", "0");
+    update.insert("z", order.value("executedQty"));
+    update.insert("L", "0");
+    update.insert("T", now);
+    update.insert("t", 0);
+    update.insert("R", order.value("reduceOnly"));
+    update.insert("ps", order.value("positionSide"));
+
+    QJsonObject event;
+    event.insert("e", "ORDER_TRADE_UPDATE");
+    event.insert("E", now);
+    event.insert("T", now);
+    event.insert("o", update);
+    QString frame = QString::fromUtf8(QJsonDocument(event).toJson(QJsonDocument::Compact));
+    for (auto it = kinds.constBegin(); it != kinds.constEnd(); ++it) {
+        if (it.value() == UserStream) {
+            it.key()->sendTextMessage(frame);
+        }
+    }
+}
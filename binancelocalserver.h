@@ -0,0 +1,86 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#ifndef BINANCELOCALSERVER_H
+#define BINANCELOCALSERVER_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QWebSocket>
+#include <QWebSocketServer>
+#include <QHostAddress>
+#include "binancemockexchange.h"
+
+// Local fapi stand-in on real sockets: plain HTTP for REST, a websocket
+// server for the market streams (/stream), user streams (/ws/<key>) and the
+// websocket API (/ws-fapi/v1). Responses come from binancemockexchange.
+// Point a client at it with binanceapi::setBaseUrls(restUrl(), streamUrl(),
+// webSocketApiUrl()). Faults are drawn per request and per stream tick.
+class binancelocalserver : public QObject {
+    Q_OBJECT
+public:
+    struct Faults {
+        int minLatencyMs = 0;
+        int maxLatencyMs = 0;
+        double errorRate = 0.0;
+        double rateLimitRate = 0.0;
+        double disconnectRate = 0.0;
+    };
+
+    explicit binancelocalserver(QObject* parent = nullptr);
+
+    bool listen(quint16 httpPort = 0, quint16 streamPort = 0, const QHostAddress& address = QHostAddress::LocalHost);
+    void close();
+    QString restUrl() const;
+    QString streamUrl() const;
+    QString webSocketApiUrl() const;
+
+    void setFaults(const Faults& faults);
+    Faults faults() const;
+    void setStreamInterval(int msec);
+    void disconnectStreams();
+    binancemockexchange* exchange();
+
+signals:
+    void requestServed(const QString& method, const QString& path, int httpStatus);
+
+private slots:
+    void acceptHttp();
+    void acceptStream();
+    void publish();
+    void publishOrder(const QJsonObject& order);
+
+private:
+    enum StreamKind {
+        MarketStream,
+        UserStream,
+        ApiStream
+    };
+
+    void readHttp(QTcpSocket* socket);
+    bool serve(QTcpSocket* socket, const QByteArray& method, const QByteArray& target, const QByteArray& body);
+    void writeResponse(QTcpSocket* socket, int httpStatus, const QByteArray& body);
+    void handleStreamMessage(QWebSocket* socket, const QString& message);
+    void handleApiRequest(QWebSocket* socket, const QJsonObject& request);
+    QByteArray injectedFault(int* httpStatus) const;
+    bool roll(double rate) const;
+    int latency() const;
+
+    QTcpServer http;
+    QWebSocketServer streams;
+    binancemockexchange mock;
+    Faults config;
+    QTimer publisher;
+    QHash<QTcpSocket*, QByteArray> buffers;
+    QHash<QWebSocket*, StreamKind> kinds;
+    QHash<QWebSocket*, QSet<QString>> subscriptions;
+};
+
+#endif // BINANCELOCALSERVER_H
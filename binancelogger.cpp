@@ -0,0 +1,379 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#include "binancelogger.h"
+#include <QDateTime>
+#include <QtEndian>
+#include <QDebug>
+#include <chrono>
+
+// File layout, little endian after the "BNLG" magic and a quint32 version:
+//   'S' id:u32 len:u16 bytes        message literal
+//   'E' id:u32 len:u16 bytes        endpoint name
+//   'T' id:u32 len:u16 bytes        thread name
+//   'R' level:u8 thread:u32 endpoint:u32 message:u32 timeNs:i64 value:i64 len:u32 detail
+// Names are written once, before the first record that refers to them.
+static const char logMagic[4] = {'B', 'N', 'L', 'G'};
+static const quint32 logVersion = 1;
+
+static std::atomic<quint64> nextGeneration(1);
+
+template <typename T>
+static void appendValue(QByteArray& out, T value) {
+    char bytes[sizeof(T)];
+    qToLittleEndian(value, bytes);
+    out.append(bytes, int(sizeof(T)));
+}
+
+static void appendName(QByteArray& out, char tag, quint32 id, const QByteArray& name) {
+    QByteArray clipped = name.left(0xffff);
+    out.append(tag);
+    appendValue<quint32>(out, id);
+    appendValue<quint16>(out, quint16(clipped.size()));
+    out.append(clipped);
+}
+
+template <typename T>
+static bool readValue(const QByteArray& data, int& at, T& value) {
+    if (at + int(sizeof(T)) > data.size()) {
+        return false;
+    }
+    value = qFromLittleEndian<T>(data.constData() + at);
+    at += int(sizeof(T));
+    return true;
+}
+
+binanceloggerwriter::binanceloggerwriter(binancelogger* owner) : owner(owner) {
+    setObjectName("binancelogger");
+}
+
+void binanceloggerwriter::run() {
+    owner->writerLoop();
+}
+
+binancelogger::Ring::Ring(int capacity)
+    : threadId(0), records(new Record[capacity]), capacity(quint32(capacity)), head(0), tail(0), dropped(0) {
+}
+
+binancelogger::Ring::~Ring() {
+    delete[] records;
+}
+
+binancelogger::binancelogger(int recordsPerThread, QObject* parent)
+    : QObject(parent), generation(nextGeneration.fetch_add(1)), recordsPerThread(qMax(2, recordsPerThread)),
+      defaultLevel(Info), allPayloads(false), active(false), stopping(false), writtenRecords(0), writer(this) {
+}
+
+binancelogger::~binancelogger() {
+    close();
+    qDeleteAll(rings);
+    qDeleteAll(endpoints);
+}
+
+bool binancelogger::open(const QString& fileName) {
+    close();
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << "binancelogger: cannot write" << fileName << file.errorString();
+        return false;
+    }
+    QByteArray header(logMagic, 4);
+    appendValue<quint32>(header, logVersion);
+    file.write(header);
+    messageIds.clear();
+    describedEndpoints.clear();
+    describedThreads.clear();
+    stopping.store(false);
+    writer.start(QThread::LowPriority);
+    active.store(true);
+    return true;
+}
+
+void binancelogger::close() {
+    active.store(false);
+    if (writer.isRunning()) {
+        stopping.store(true);
+        {
+            QMutexLocker lock(&mutex);
+            wake.wakeAll();
+        }
+        writer.wait();
+    }
+    if (file.isOpen()) {
+        file.close();
+    }
+}
+
+void binancelogger::setLevel(Level level) {
+    defaultLevel.store(level, std::memory_order_relaxed);
+    QMutexLocker lock(&mutex);
+    for (binancelogendpoint* each : qAsConst(endpoints)) {
+        if (!each->overridden) {
+            each->level.store(level, std::memory_order_relaxed);
+        }
+    }
+}
+
+void binancelogger::setLevel(const QString& endpoint, Level level) {
+    QMutexLocker lock(&mutex);
+    QByteArray name = endpoint.toLatin1();
+    settings[name].level = level;
+    if (binancelogendpoint* found = endpoints.value(name)) {
+        apply(found);
+    }
+}
+
+void binancelogger::setSampling(const QString& endpoint, int everyN) {
+    QMutexLocker lock(&mutex);
+    QByteArray name = endpoint.toLatin1();
+    settings[name].sampleEvery = qMax(1, everyN);
+    if (binancelogendpoint* found = endpoints.value(name)) {
+        apply(found);
+    }
+}
+
+void binancelogger::setPayloads(const QString& endpoint, bool enabled) {
+    if (endpoint == "*") {
+        allPayloads.store(enabled, std::memory_order_relaxed);
+        return;
+    }
+    QMutexLocker lock(&mutex);
+    QByteArray name = endpoint.toLatin1();
+    settings[name].payloads = enabled;
+    if (binancelogendpoint* found = endpoints.value(name)) {
+        apply(found);
+    }
+}
+
+void binancelogger::apply(binancelogendpoint* endpoint) {
+    Settings own = settings.value(endpoint->name);
+    endpoint->overridden = own.level >= 0;
+    endpoint->level.store(own.level >= 0 ? own.level : defaultLevel.load(std::memory_order_relaxed),
+                          std::memory_order_relaxed);
+    endpoint->sampleEvery.store(own.sampleEvery, std::memory_order_relaxed);
+    endpoint->payloads.store(own.payloads, std::memory_order_relaxed);
+}
+
+binancelogendpoint* binancelogger::endpoint(const char* name) {
+    QMutexLocker lock(&mutex);
+    QByteArray key(name);
+    binancelogendpoint*& found = endpoints[key];
+    if (!found) {
+        found = new binancelogendpoint;
+        found->name = key;
+        found->id = quint32(endpoints.size());
+        found->calls.store(0, std::memory_order_relaxed);
+        apply(found);
+    }
+    return found;
+}
+
+bool binancelogger::enabled(binancelogendpoint* endpoint, Level level) {
+    if (!active.load(std::memory_order_relaxed) || level < endpoint->level.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    int every = endpoint->sampleEvery.load(std::memory_order_relaxed);
+    // Warnings and errors are never sampled away.
+    if (every <= 1 || level >= Warning) {
+        return true;
+    }
+    return endpoint->calls.fetch_add(1, std::memory_order_relaxed) % quint64(every) == 0;
+}
+
+bool binancelogger::payloads(const binancelogendpoint* endpoint) const {
+    return active.load(std::memory_order_relaxed) &&
+           (endpoint->payloads.load(std::memory_order_relaxed) || allPayloads.load(std::memory_order_relaxed));
+}
+
+binancelogger::Ring* binancelogger::ring() {
+    thread_local quint64 cachedGeneration = 0;
+    thread_local Ring* cached = nullptr;
+    if (cachedGeneration == generation) {
+        return cached;
+    }
+    QMutexLocker lock(&mutex);
+    Ring*& found = ringByThread[QThread::currentThreadId()];
+    if (!found) {
+        found = new Ring(recordsPerThread);
+        found->threadId = quint32(rings.size() + 1);
+        QString name = QThread::currentThread()->objectName();
+        found->threadName = (name.isEmpty() ? QString("thread-%1").arg(found->threadId) : name).toUtf8();
+        rings.append(found);
+    }
+    cachedGeneration = generation;
+    cached = found;
+    return found;
+}
+
+void binancelogger::write(binancelogendpoint* endpoint, Level level, const char* message, qint64 value, const QByteArray& detail) {
+    Ring* own = ring();
+    quint32 head = own->head.load(std::memory_order_relaxed);
+    if (head - own->tail.load(std::memory_order_acquire) >= own->capacity) {
+        own->dropped.store(own->dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return;
+    }
+    Record& record = own->records[head % own->capacity];
+    record.timeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    record.endpoint = endpoint;
+    record.message = message;
+    record.value = value;
+    record.detail = detail;
+    record.level = level;
+    own->head.store(head + 1, std::memory_order_release);
+}
+
+int binancelogger::drain(QByteArray& out) {
+    QList<Ring*> sources;
+    {
+        QMutexLocker lock(&mutex);
+        sources = rings;
+    }
+    int count = 0;
+    for (Ring* source : qAsConst(sources)) {
+        quint32 tail = source->tail.load(std::memory_order_relaxed);
+        quint32 head = source->head.load(std::memory_order_acquire);
+        if (tail != head && !describedThreads.contains(source->threadId)) {
+            appendName(out, 'T', source->threadId, source->threadName);
+            describedThreads.insert(source->threadId, true);
+        }
+        for (; tail != head; ++tail) {
+            Record& record = source->records[tail % source->capacity];
+            if (!describedEndpoints.contains(record.endpoint->id)) {
+                appendName(out, 'E', record.endpoint->id, record.endpoint->name);
+                describedEndpoints.insert(record.endpoint->id, true);
+            }
+            quint32 message = messageIds.value(record.message);
+            if (message == 0) {
+                message = quint32(messageIds.size() + 1);
+                messageIds.insert(record.message, message);
+                appendName(out, 'S', message, QByteArray(record.message));
+            }
+            out.append('R');
+            appendValue<quint8>(out, quint8(record.level));
+            appendValue<quint32>(out, source->threadId);
+            appendValue<quint32>(out, record.endpoint->id);
+            appendValue<quint32>(out, message);
+            appendValue<qint64>(out, record.timeNs);
+            appendValue<qint64>(out, record.value);
+            appendValue<quint32>(out, quint32(record.detail.size()));
+            out.append(record.detail);
+            record.detail = QByteArray();
+            ++count;
+        }
+        source->tail.store(tail, std::memory_order_release);
+    }
+    writtenRecords.fetch_add(count, std::memory_order_relaxed);
+    return count;
+}
+
+void binancelogger::writerLoop() {
+    QByteArray out;
+    forever {
+        bool last = stopping.load();
+        out.clear();
+        int count = drain(out);
+        if (!out.isEmpty()) {
+            file.write(out);
+        }
+        if (last) {
+            file.flush();
+            return;
+        }
+        if (count == 0) {
+            // Producers never signal; the writer polls so a log call stays a few stores.
+            file.flush();
+            QMutexLocker lock(&mutex);
+            if (!stopping.load()) {
+                wake.wait(&mutex, 5);
+            }
+        }
+    }
+}
+
+qint64 binancelogger::written() const {
+    return writtenRecords.load(std::memory_order_relaxed);
+}
+
+qint64 binancelogger::dropped() const {
+    QMutexLocker lock(&mutex);
+    qint64 total = 0;
+    for (const Ring* source : rings) {
+        total += qint64(source->dropped.load(std::memory_order_relaxed));
+    }
+    return total;
+}
+
+const char* binancelogger::levelName(Level level) {
+    switch (level) {
+    case Trace: return "TRACE";
+    case Debug: return "DEBUG";
+    case Info: return "INFO";
+    case Warning: return "WARN";
+    case Error: return "ERROR";
+    default: return "OFF";
+    }
+}
+
+QStringList binancelogger::decode(const QString& fileName) {
+    QStringList lines;
+    QFile input(fileName);
+    if (!input.open(QIODevice::ReadOnly)) {
+        qDebug() << "binancelogger: cannot read" << fileName << input.errorString();
+        return lines;
+    }
+    QByteArray data = input.readAll();
+    quint32 version = 0;
+    int at = 4;
+    if (!data.startsWith(QByteArray(logMagic, 4)) || !readValue(data, at, version) || version != logVersion) {
+        qDebug() << "binancelogger: not a log file" << fileName;
+        return lines;
+    }
+
+    QHash<quint32, QString> messages;
+    QHash<quint32, QString> names;
+    QHash<quint32, QString> threads;
+    while (at < data.size()) {
+        char tag = data.at(at++);
+        if (tag == 'S' || tag == 'E' || tag == 'T') {
+            quint32 id = 0;
+            quint16 size = 0;
+            if (!readValue(data, at, id) || !readValue(data, at, size) || at + size > data.size()) {
+                break;
+            }
+            QString name = QString::fromUtf8(data.constData() + at, size);
+            at += size;
+            (tag == 'S' ? messages : tag == 'E' ? names : threads).insert(id, name);
+        } else if (tag == 'R') {
+            quint8 level = 0;
+            quint32 thread = 0, endpoint = 0, message = 0, size = 0;
+            qint64 timeNs = 0, value = 0;
+            if (!readValue(data, at, level) || !readValue(data, at, thread) || !readValue(data, at, endpoint) ||
+                !readValue(data, at, message) || !readValue(data, at, timeNs) || !readValue(data, at, value) ||
+                !readValue(data, at, size) || at + qint64(size) > data.size()) {
+                break;
+            }
+            QByteArray detail = data.mid(at, int(size));
+            at += int(size);
+            QString line = QString("%1.%2 %3 [%4] %5 %6 value=%7")
+                               .arg(QDateTime::fromMSecsSinceEpoch(timeNs / 1000000).toUTC().toString("yyyy-MM-dd hh:mm:ss"))
+                               .arg(timeNs % 1000000000, 9, 10, QChar('0'))
+                               .arg(levelName(Level(level)))
+                               .arg(threads.value(thread))
+                               .arg(names.value(endpoint))
+                               .arg(messages.value(message))
+                               .arg(value);
+            if (!detail.isEmpty()) {
+                line += " " + QString::fromUtf8(detail);
+            }
+            lines.append(line);
+        } else {
+            qDebug() << "binancelogger: corrupt record at" << at - 1 << "in" << fileName;
+            break;
+        }
+    }
+    return lines;
+}
@@ -0,0 +1,145 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#ifndef BINANCELOGGER_H
+#define BINANCELOGGER_H
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QList>
+#include <QFile>
+#include <QThread>
+#include <QStringList>
+#include <atomic>
+
+class binancelogger;
+
+// Per endpoint settings, interned once by binancelogger::endpoint() and read
+// lock free on every log call.
+struct binancelogendpoint {
+    QByteArray name;
+    quint32 id;
+    std::atomic<int> level;
+    std::atomic<int> sampleEvery;
+    std::atomic<bool> payloads;
+    std::atomic<quint64> calls;
+    bool overridden;
+};
+
+class binanceloggerwriter : public QThread {
+public:
+    explicit binanceloggerwriter(binancelogger* owner);
+
+protected:
+    void run() override;
+
+private:
+    binancelogger* owner;
+};
+
+// Structured binary log for the network thread. A log call stores a fixed
+// record (time, level, endpoint, message literal, value) in the calling
+// thread's own ring buffer without locking or formatting; a background
+// writer thread drains the rings into a compact binary file. Nothing is
+// rendered as text until decode() (or tools/logdump) reads the file back.
+//
+// Levels and sampling (1 in N) are set per endpoint. Raw payloads are only
+// captured for endpoints switched on with setPayloads(). A full ring drops
+// records and counts them rather than blocking the caller.
+//
+// message must be a string literal or otherwise outlive the logger.
+class binancelogger : public QObject {
+    Q_OBJECT
+public:
+    enum Level { Trace, Debug, Info, Warning, Error, Off };
+
+    explicit binancelogger(int recordsPerThread = 8192, QObject* parent = nullptr);
+    ~binancelogger();
+
+    bool open(const QString& fileName);
+    //drains every ring, stops the writer and closes the file
+    void close();
+
+    //default for endpoints without their own level
+    void setLevel(Level level);
+    void setLevel(const QString& endpoint, Level level);
+    //keeps 1 in everyN records of the endpoint, 1 keeps all
+    void setSampling(const QString& endpoint, int everyN);
+    //raw response bodies for the endpoint, "*" for all
+    void setPayloads(const QString& endpoint, bool enabled);
+
+    binancelogendpoint* endpoint(const char* name);
+    bool enabled(binancelogendpoint* endpoint, Level level);
+    bool payloads(const binancelogendpoint* endpoint) const;
+    void write(binancelogendpoint* endpoint, Level level, const char* message,
+               qint64 value = 0, const QByteArray& detail = QByteArray());
+
+    qint64 written() const;
+    qint64 dropped() const;
+
+    static const char* levelName(Level level);
+    //one text line per record
+    static QStringList decode(const QString& fileName);
+
+private:
+    friend class binanceloggerwriter;
+
+    struct Record {
+        qint64 timeNs;
+        binancelogendpoint* endpoint;
+        const char* message;
+        qint64 value;
+        QByteArray detail;
+        int level;
+    };
+
+    struct Ring {
+        explicit Ring(int capacity);
+        ~Ring();
+        QByteArray threadName;
+        quint32 threadId;
+        Record* records;
+        quint32 capacity;
+        std::atomic<quint32> head;
+        std::atomic<quint32> tail;
+        std::atomic<quint64> dropped;
+    };
+
+    struct Settings {
+        int level = -1;
+        int sampleEvery = 1;
+        bool payloads = false;
+    };
+
+    Ring* ring();
+    void apply(binancelogendpoint* endpoint);
+    void writerLoop();
+    int drain(QByteArray& out);
+
+    const quint64 generation;
+    const int recordsPerThread;
+    std::atomic<int> defaultLevel;
+    std::atomic<bool> allPayloads;
+    std::atomic<bool> active;
+    std::atomic<bool> stopping;
+    std::atomic<qint64> writtenRecords;
+    mutable QMutex mutex;
+    QWaitCondition wake;
+    QHash<Qt::HANDLE, Ring*> ringByThread;
+    QList<Ring*> rings;
+    QHash<QByteArray, binancelogendpoint*> endpoints;
+    QHash<QByteArray, Settings> settings;
+    QFile file;
+    binanceloggerwriter writer;
+    // writer thread only
+    QHash<const char*, quint32> messageIds;
+    QHash<quint32, bool> describedEndpoints;
+    QHash<quint32, bool> describedThreads;
+};
+
+#endif // BINANCELOGGER_H
@@ -0,0 +1,179 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#include "binancemarkprices.h"
+#include "binanceapi.h"
+#include "binancelogger.h"
+#include <cstring>
+
+binancemarkprices::binancemarkprices(binanceapi* api, QObject* parent)
+    : QObject(parent), api(api), sequence(0), used(0) {
+    memset(index, 0, sizeof(index));
+    memset(entries, 0, sizeof(entries));
+    connect(api, &binanceapi::marketStreamEventReceived, this, &binancemarkprices::handleStreamEvent);
+    connect(api, &binanceapi::premiumIndexReceived, this, &binancemarkprices::handlePremiumIndex);
+}
+
+void binancemarkprices::start(const QString& speed) {
+    stop();
+    stream = "!markPrice@arr" + (speed.isEmpty() ? QString() : "@" + speed);
+    api->subscribeMarketStreams(QStringList() << stream);
+    api->getPremiumIndex();
+}
+
+void binancemarkprices::stop() {
+    if (!stream.isEmpty()) {
+        api->unsubscribeMarketStreams(QStringList() << stream);
+        stream.clear();
+    }
+}
+
+quint32 binancemarkprices::hash(const char* symbol) {
+    quint32 value = 2166136261u;
+    for (; *symbol; ++symbol) {
+        value = (value ^ quint8(*symbol)) * 16777619u;
+    }
+    return value;
+}
+
+int binancemarkprices::find(const char* symbol) const {
+    for (quint32 slot = hash(symbol) % indexSize;; slot = (slot + 1) % indexSize) {
+        int entry = index[slot] - 1;
+        if (entry < 0) {
+            return -1;
+        }
+        if (strncmp(entries[entry].symbol, symbol, sizeof(entries[entry].symbol)) == 0) {
+            return entry;
+        }
+    }
+}
+
+void binancemarkprices::upsert(const MarkPrice& markPrice) {
+    quint32 slot = hash(markPrice.symbol) % indexSize;
+    for (;; slot = (slot + 1) % indexSize) {
+        int entry = index[slot] - 1;
+        if (entry < 0) {
+            break;
+        }
+        if (strncmp(entries[entry].symbol, markPrice.symbol, sizeof(markPrice.symbol)) == 0) {
+            entries[entry] = markPrice;
+            return;
+        }
+    }
+    int count = used.load(std::memory_order_relaxed);
+    if (count >= capacity) {
+        api->logMessage(binancelogger::Warning, "Mark price table is full, dropping", 0, QString::fromLatin1(markPrice.symbol, int(qstrnlen(markPrice.symbol, sizeof(markPrice.symbol)))));
+        return;
+    }
+    entries[count] = markPrice;
+    index[slot] = qint16(count + 1);
+    used.store(count + 1, std::memory_order_relaxed);
+}
+
+void binancemarkprices::beginWrite() {
+    sequence.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void binancemarkprices::endWrite() {
+    sequence.fetch_add(1, std::memory_order_release);
+}
+
+bool binancemarkprices::get(const QString& symbol, MarkPrice* markPrice) const {
+    QByteArray key = symbol.toLatin1();
+    if (key.size() >= int(sizeof(markPrice->symbol))) {
+        return false;
+    }
+    for (;;) {
+        quint64 before = sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+        int entry = find(key.constData());
+        if (entry >= 0) {
+            memcpy(markPrice, &entries[entry], sizeof(MarkPrice));
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == before) {
+            return entry >= 0;
+        }
+    }
+}
+
+double binancemarkprices::markPrice(const QString& symbol) const {
+    MarkPrice entry;
+    return get(symbol, &entry) ? entry.markPrice : 0.0;
+}
+
+QVector<binancemarkprices::MarkPrice> binancemarkprices::snapshot() const {
+    QVector<MarkPrice> copy;
+    for (;;) {
+        quint64 before = sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+        int count = used.load(std::memory_order_relaxed);
+        copy.resize(count);
+        memcpy(copy.data(), entries, sizeof(MarkPrice) * size_t(count));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == before) {
+            return copy;
+        }
+    }
+}
+
+int binancemarkprices::size() const {
+    return used.load(std::memory_order_relaxed);
+}
+
+void binancemarkprices::handleStreamEvent(const QString& stream, const QJsonValue& data) {
+    if (stream != this->stream) {
+        return;
+    }
+    const QJsonArray events = data.toArray();
+    beginWrite();
+    for (const QJsonValue& value : events) {
+        QJsonObject event = value.toObject();
+        QByteArray symbol = event.value("s").toString().toLatin1();
+        MarkPrice entry;
+        memset(&entry, 0, sizeof(entry));
+        strncpy(entry.symbol, symbol.constData(), sizeof(entry.symbol) - 1);
+        entry.markPrice = event.value("p").toString().toDouble();
+        entry.indexPrice = event.value("i").toString().toDouble();
+        entry.estimatedSettlePrice = event.value("P").toString().toDouble();
+        entry.fundingRate = event.value("r").toString().toDouble();
+        entry.nextFundingTime = event.value("T").toVariant().toLongLong();
+        entry.eventTime = event.value("E").toVariant().toLongLong();
+        upsert(entry);
+    }
+    endWrite();
+    emit updated();
+}
+
+void binancemarkprices::handlePremiumIndex(const QJsonArray& entries) {
+    beginWrite();
+    for (const QJsonValue& value : entries) {
+        QJsonObject object = value.toObject();
+        QByteArray symbol = object.value("symbol").toString().toLatin1();
+        MarkPrice entry;
+        memset(&entry, 0, sizeof(entry));
+        strncpy(entry.symbol, symbol.constData(), sizeof(entry.symbol) - 1);
+        entry.markPrice = object.value("markPrice").toString().toDouble();
+        entry.indexPrice = object.value("indexPrice").toString().toDouble();
+        entry.estimatedSettlePrice = object.value("estimatedSettlePrice").toString().toDouble();
+        entry.fundingRate = object.value("lastFundingRate").toString().toDouble();
+        entry.nextFundingTime = object.value("nextFundingTime").toVariant().toLongLong();
+        entry.eventTime = object.value("time").toVariant().toLongLong();
+
+        // The stream is authoritative once it runs; never roll a newer entry back.
+        int existing = find(entry.symbol);
+        if (existing < 0 || this->entries[existing].eventTime < entry.eventTime) {
+            upsert(entry);
+        }
+    }
+    endWrite();
+    emit updated();
+}
@@ -0,0 +1,69 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#ifndef BINANCEMARKPRICES_H
+#define BINANCEMARKPRICES_H
+
+#include <QObject>
+#include <QVector>
+#include <QJsonArray>
+#include <atomic>
+
+class binanceapi;
+
+// All-market mark price / funding table. Seeded once from /premiumIndex and
+// then kept current by the !markPrice@arr stream. The owning thread is the
+// only writer; readers on any thread get a consistent copy without locking
+// (seqlock: a read that overlaps a write is simply retried).
+class binancemarkprices : public QObject {
+    Q_OBJECT
+public:
+    struct MarkPrice {
+        char symbol[24];
+        double markPrice;
+        double indexPrice;
+        double estimatedSettlePrice;
+        double fundingRate;
+        qint64 nextFundingTime;
+        qint64 eventTime;
+    };
+
+    explicit binancemarkprices(binanceapi* api, QObject* parent = nullptr);
+
+    void start(const QString& speed = "1s");
+    void stop();
+
+    bool get(const QString& symbol, MarkPrice* markPrice) const;
+    double markPrice(const QString& symbol) const;
+    QVector<MarkPrice> snapshot() const;
+    int size() const;
+
+signals:
+    void updated();
+
+private slots:
+    void handleStreamEvent(const QString& stream, const QJsonValue& data);
+    void handlePremiumIndex(const QJsonArray& entries);
+
+private:
+    static const int capacity = 2048;
+    static const int indexSize = capacity * 2;
+
+    static quint32 hash(const char* symbol);
+    int find(const char* symbol) const;
+    void upsert(const MarkPrice& markPrice);
+    void beginWrite();
+    void endWrite();
+
+    binanceapi* api;
+    QString stream;
+    std::atomic<quint64> sequence;
+    std::atomic<int> used;
+    qint16 index[indexSize];
+    MarkPrice entries[capacity];
+};
+
+#endif // BINANCEMARKPRICES_H
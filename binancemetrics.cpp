@@ -0,0 +1,368 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#include "binancemetrics.h"
+#include <QThread>
+#include <QTcpSocket>
+#include <QMap>
+#include <QDebug>
+#include <limits>
+
+static const int emptyCode = std::numeric_limits<int>::min();
+static std::atomic<quint64> nextGeneration(1);
+
+const qint64 binancemetrics::bucketBoundsUs[bucketCount - 1] = {
+    500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000
+};
+
+binancemetrics::Codes::Codes() : other(0) {
+    for (int i = 0; i < codeSlots; ++i) {
+        code[i].store(emptyCode, std::memory_order_relaxed);
+        count[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+binancemetrics::Cell::Cell()
+    : requests(0), messages(0), bytes(0), disconnects(0), latencySumUs(0) {
+    for (int i = 0; i < bucketCount; ++i) {
+        buckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+binancemetrics::Shard::Shard() {
+    for (int i = 0; i < maxSeries; ++i) {
+        cells[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+binancemetrics::Shard::~Shard() {
+    for (int i = 0; i < maxSeries; ++i) {
+        delete cells[i].load(std::memory_order_relaxed);
+    }
+}
+
+binancemetrics::Usage::Usage() : usedWeight1m(-1), orderCount10s(-1), orderCount1m(-1) {
+}
+
+binancemetrics::binancemetrics(QObject* parent)
+    : QObject(parent), generation(nextGeneration.fetch_add(1)) {
+    for (int i = 0; i < maxSeries; ++i) {
+        laneOf[i] = 0;
+    }
+    connect(&server, &QTcpServer::newConnection, this, &binancemetrics::acceptScrape);
+}
+
+binancemetrics::~binancemetrics() {
+    qDeleteAll(shards);
+}
+
+int binancemetrics::series(Kind kind, const QString& endpoint, const QString& lane) {
+    QString key = QString::number(kind) + '\n' + endpoint + '\n' + lane;
+    QMutexLocker lock(&mutex);
+    auto it = seriesIds.constFind(key);
+    if (it != seriesIds.constEnd()) {
+        return it.value();
+    }
+    int laneIndex = lanes.indexOf(lane);
+    if (laneIndex < 0) {
+        if (lanes.size() >= maxLanes) {
+            qDebug() << "binancemetrics: lane limit reached, not tracking" << lane;
+            return -1;
+        }
+        lanes.append(lane);
+        laneIndex = lanes.size() - 1;
+    }
+    if (descriptors.size() >= maxSeries) {
+        qDebug() << "binancemetrics: series limit reached, not tracking" << endpoint << lane;
+        return -1;
+    }
+    int id = descriptors.size();
+    descriptors.append(Descriptor{kind, endpoint, laneIndex});
+    laneOf[id] = laneIndex;
+    seriesIds.insert(key, id);
+    return id;
+}
+
+binancemetrics::Shard* binancemetrics::shard() {
+    // One cached shard per thread; a thread alternating between registries
+    // falls back to the locked lookup.
+    thread_local quint64 cachedGeneration = 0;
+    thread_local Shard* cached = nullptr;
+    if (cachedGeneration == generation) {
+        return cached;
+    }
+    QMutexLocker lock(&mutex);
+    Shard*& found = shardByThread[QThread::currentThreadId()];
+    if (!found) {
+        found = new Shard;
+        shards.append(found);
+    }
+    cachedGeneration = generation;
+    cached = found;
+    return found;
+}
+
+binancemetrics::Cell* binancemetrics::cell(int series) {
+    if (series < 0 || series >= maxSeries) {
+        return nullptr;
+    }
+    Shard* owned = shard();
+    Cell* found = owned->cells[series].load(std::memory_order_relaxed);
+    if (!found) {
+        found = new Cell;
+        owned->cells[series].store(found, std::memory_order_release);
+    }
+    return found;
+}
+
+void binancemetrics::bump(std::atomic<quint64>& counter, quint64 by) {
+    // Only the owning thread writes a shard, so no read-modify-write is needed.
+    counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+}
+
+void binancemetrics::bump(Codes& codes, int code) {
+    for (int i = 0; i < codeSlots; ++i) {
+        int slot = codes.code[i].load(std::memory_order_relaxed);
+        if (slot == emptyCode) {
+            codes.code[i].store(code, std::memory_order_release);
+            slot = code;
+        }
+        if (slot == code) {
+            bump(codes.count[i]);
+            return;
+        }
+    }
+    bump(codes.other);
+}
+
+void binancemetrics::recordRequest(int series, int httpStatus, int errorCode, qint64 elapsedUs) {
+    Cell* target = cell(series);
+    if (!target) {
+        return;
+    }
+    bump(target->requests);
+    bump(target->statuses, httpStatus);
+    if (errorCode != 0) {
+        bump(target->errors, errorCode);
+    }
+    int bucket = 0;
+    while (bucket < bucketCount - 1 && elapsedUs > bucketBoundsUs[bucket]) {
+        ++bucket;
+    }
+    bump(target->buckets[bucket]);
+    bump(target->latencySumUs, quint64(qMax<qint64>(0, elapsedUs)));
+}
+
+void binancemetrics::recordMessage(int series, qint64 bytes) {
+    Cell* target = cell(series);
+    if (!target) {
+        return;
+    }
+    bump(target->messages);
+    bump(target->bytes, quint64(bytes));
+}
+
+void binancemetrics::recordDisconnect(int series) {
+    Cell* target = cell(series);
+    if (target) {
+        bump(target->disconnects);
+    }
+}
+
+void binancemetrics::recordUsage(int series, qint64 usedWeight1m, qint64 orderCount10s, qint64 orderCount1m) {
+    if (series < 0 || series >= maxSeries) {
+        return;
+    }
+    Usage& lane = usage[laneOf[series]];
+    if (usedWeight1m >= 0) {
+        lane.usedWeight1m.store(usedWeight1m, std::memory_order_relaxed);
+    }
+    if (orderCount10s >= 0) {
+        lane.orderCount10s.store(orderCount10s, std::memory_order_relaxed);
+    }
+    if (orderCount1m >= 0) {
+        lane.orderCount1m.store(orderCount1m, std::memory_order_relaxed);
+    }
+}
+
+QString binancemetrics::label(const QString& value) {
+    QString escaped = value;
+    escaped.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+    return escaped;
+}
+
+QByteArray binancemetrics::prometheus() const {
+    static const char* kindNames[] = {"rest", "market", "user", "ws-api"};
+
+    struct Merged {
+        quint64 requests = 0;
+        quint64 messages = 0;
+        quint64 bytes = 0;
+        quint64 disconnects = 0;
+        quint64 latencySumUs = 0;
+        quint64 buckets[bucketCount] = {};
+        QMap<int, quint64> statuses;
+        QMap<int, quint64> errors;
+        quint64 otherStatuses = 0;
+        quint64 otherErrors = 0;
+    };
+    auto mergeCodes = [](const Codes& codes, QMap<int, quint64>& into, quint64& other) {
+        for (int i = 0; i < codeSlots; ++i) {
+            int code = codes.code[i].load(std::memory_order_acquire);
+            if (code != emptyCode) {
+                into[code] += codes.count[i].load(std::memory_order_relaxed);
+            }
+        }
+        other += codes.other.load(std::memory_order_relaxed);
+    };
+
+    QMutexLocker lock(&mutex);
+    QVector<Merged> merged(descriptors.size());
+    for (const Shard* source : shards) {
+        for (int id = 0; id < descriptors.size(); ++id) {
+            const Cell* from = source->cells[id].load(std::memory_order_acquire);
+            if (!from) {
+                continue;
+            }
+            Merged& to = merged[id];
+            to.requests += from->requests.load(std::memory_order_relaxed);
+            to.messages += from->messages.load(std::memory_order_relaxed);
+            to.bytes += from->bytes.load(std::memory_order_relaxed);
+            to.disconnects += from->disconnects.load(std::memory_order_relaxed);
+            to.latencySumUs += from->latencySumUs.load(std::memory_order_relaxed);
+            for (int b = 0; b < bucketCount; ++b) {
+                to.buckets[b] += from->buckets[b].load(std::memory_order_relaxed);
+            }
+            mergeCodes(from->statuses, to.statuses, to.otherStatuses);
+            mergeCodes(from->errors, to.errors, to.otherErrors);
+        }
+    }
+
+    QByteArray out;
+    auto labels = [this](int id) {
+        const Descriptor& d = descriptors.at(id);
+        return QString("kind=\"%1\",endpoint=\"%2\",lane=\"%3\"")
+            .arg(kindNames[d.kind], label(d.endpoint), label(lanes.at(d.lane))).toUtf8();
+    };
+    auto family = [&out](const char* name, const char* type, const char* help) {
+        out += QByteArray("# HELP ") + name + ' ' + help + "\n# TYPE " + name + ' ' + type + '\n';
+    };
+    auto sample = [&out](const char* name, const QByteArray& labels, quint64 value) {
+        out += QByteArray(name) + '{' + labels + "} " + QByteArray::number(value) + '\n';
+    };
+
+    family("binance_requests_total", "counter", "Requests answered, by HTTP status (0 = transport failure).");
+    for (int id = 0; id < merged.size(); ++id) {
+        const Merged& m = merged.at(id);
+        for (auto it = m.statuses.constBegin(); it != m.statuses.constEnd(); ++it) {
+            sample("binance_requests_total", labels(id) + ",status=\"" + QByteArray::number(it.key()) + '"', it.value());
+        }
+        if (m.otherStatuses > 0) {
+            sample("binance_requests_total", labels(id) + ",status=\"other\"", m.otherStatuses);
+        }
+    }
+
+    family("binance_request_errors_total", "counter", "Requests rejected by the exchange, by Binance error code.");
+    for (int id = 0; id < merged.size(); ++id) {
+        const Merged& m = merged.at(id);
+        for (auto it = m.errors.constBegin(); it != m.errors.constEnd(); ++it) {
+            sample("binance_request_errors_total", labels(id) + ",code=\"" + QByteArray::number(it.key()) + '"', it.value());
+        }
+        if (m.otherErrors > 0) {
+            sample("binance_request_errors_total", labels(id) + ",code=\"other\"", m.otherErrors);
+        }
+    }
+
+    family("binance_request_duration_seconds", "histogram", "Time from request sent to response received.");
+    for (int id = 0; id < merged.size(); ++id) {
+        const Merged& m = merged.at(id);
+        if (m.requests == 0) {
+            continue;
+        }
+        QByteArray base = labels(id);
+        quint64 cumulative = 0;
+        for (int b = 0; b < bucketCount; ++b) {
+            cumulative += m.buckets[b];
+            QByteArray le = b < bucketCount - 1 ? QByteArray::number(bucketBoundsUs[b] / 1e6) : QByteArray("+Inf");
+            sample("binance_request_duration_seconds_bucket", base + ",le=\"" + le + '"', cumulative);
+        }
+        out += "binance_request_duration_seconds_sum{" + base + "} " + QByteArray::number(m.latencySumUs / 1e6) + '\n';
+        sample("binance_request_duration_seconds_count", base, cumulative);
+    }
+
+    family("binance_stream_messages_total", "counter", "Websocket messages received.");
+    for (int id = 0; id < merged.size(); ++id) {
+        if (merged.at(id).messages > 0) {
+            sample("binance_stream_messages_total", labels(id), merged.at(id).messages);
+        }
+    }
+    family("binance_stream_bytes_total", "counter", "Websocket payload bytes received.");
+    for (int id = 0; id < merged.size(); ++id) {
+        if (merged.at(id).messages > 0) {
+            sample("binance_stream_bytes_total", labels(id), merged.at(id).bytes);
+        }
+    }
+    family("binance_stream_disconnects_total", "counter", "Websocket disconnects.");
+    for (int id = 0; id < merged.size(); ++id) {
+        if (merged.at(id).disconnects > 0) {
+            sample("binance_stream_disconnects_total", labels(id), merged.at(id).disconnects);
+        }
+    }
+
+    struct Gauge {
+        const char* name;
+        const char* help;
+        std::atomic<qint64> Usage::*field;
+    };
+    const Gauge gauges[] = {
+        {"binance_used_weight_1m", "Last X-MBX-USED-WEIGHT-1M reported to the lane.", &Usage::usedWeight1m},
+        {"binance_order_count_10s", "Last X-MBX-ORDER-COUNT-10S reported to the lane.", &Usage::orderCount10s},
+        {"binance_order_count_1m", "Last X-MBX-ORDER-COUNT-1M reported to the lane.", &Usage::orderCount1m},
+    };
+    for (const Gauge& gauge : gauges) {
+        family(gauge.name, "gauge", gauge.help);
+        for (int lane = 0; lane < lanes.size(); ++lane) {
+            qint64 value = (usage[lane].*gauge.field).load(std::memory_order_relaxed);
+            if (value >= 0) {
+                out += QByteArray(gauge.name) + "{lane=\"" + label(lanes.at(lane)).toUtf8() + "\"} " + QByteArray::number(value) + '\n';
+            }
+        }
+    }
+    return out;
+}
+
+bool binancemetrics::listen(quint16 port, const QHostAddress& address) {
+    if (!server.listen(address, port)) {
+        qDebug() << "binancemetrics: cannot listen on port" << port << server.errorString();
+        return false;
+    }
+    return true;
+}
+
+quint16 binancemetrics::serverPort() const {
+    return server.serverPort();
+}
+
+void binancemetrics::close() {
+    server.close();
+}
+
+void binancemetrics::acceptScrape() {
+    while (QTcpSocket* socket = server.nextPendingConnection()) {
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+            QByteArray request = socket->property("request").toByteArray() + socket->readAll();
+            if (!request.contains("\r\n\r\n")) {
+                socket->setProperty("request", request);
+                return;
+            }
+            QByteArray body = prometheus();
+            socket->write("HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\nContent-Length: "
+                          + QByteArray::number(body.size()) + "\r\nConnection: close\r\n\r\n" + body);
+            socket->disconnectFromHost();
+        });
+    }
+}
@@ -0,0 +1,122 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#ifndef BINANCEMETRICS_H
+#define BINANCEMETRICS_H
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QVector>
+#include <QStringList>
+#include <QTcpServer>
+#include <QHostAddress>
+#include <atomic>
+
+// Request and stream counters per endpoint and lane (binanceapi objectName),
+// exported in Prometheus text format. Every recording thread writes its own
+// shard with plain relaxed stores, so a counter bump costs a few nanoseconds
+// and never contends; prometheus() merges the shards on read.
+//
+// series() interns a (kind, endpoint, lane) triple and is the only call that
+// locks; callers keep the returned id and record against it.
+class binancemetrics : public QObject {
+    Q_OBJECT
+public:
+    enum Kind {
+        Rest,
+        MarketStream,
+        UserStream,
+        WebSocketApi
+    };
+
+    explicit binancemetrics(QObject* parent = nullptr);
+    ~binancemetrics();
+
+    int series(Kind kind, const QString& endpoint, const QString& lane);
+
+    //httpStatus 0 for transport failures, errorCode 0 when the exchange did not send one
+    void recordRequest(int series, int httpStatus, int errorCode, qint64 elapsedUs);
+    void recordMessage(int series, qint64 bytes);
+    void recordDisconnect(int series);
+    //X-MBX-USED-WEIGHT-1M / X-MBX-ORDER-COUNT-10S / -1M of the series' lane, -1 when absent
+    void recordUsage(int series, qint64 usedWeight1m, qint64 orderCount10s, qint64 orderCount1m);
+
+    QByteArray prometheus() const;
+
+    //serves prometheus() over plain HTTP on every path
+    bool listen(quint16 port = 0, const QHostAddress& address = QHostAddress::LocalHost);
+    quint16 serverPort() const;
+    void close();
+
+private slots:
+    void acceptScrape();
+
+private:
+    static const int maxSeries = 1024;
+    static const int maxLanes = 64;
+    static const int codeSlots = 16;
+    static const int bucketCount = 15;
+    static const qint64 bucketBoundsUs[bucketCount - 1];
+
+    // Small open table of (code, count) pairs; codes past the table land in other.
+    struct Codes {
+        Codes();
+        std::atomic<int> code[codeSlots];
+        std::atomic<quint64> count[codeSlots];
+        std::atomic<quint64> other;
+    };
+
+    struct Cell {
+        Cell();
+        std::atomic<quint64> requests;
+        std::atomic<quint64> messages;
+        std::atomic<quint64> bytes;
+        std::atomic<quint64> disconnects;
+        std::atomic<quint64> latencySumUs;
+        std::atomic<quint64> buckets[bucketCount];
+        Codes statuses;
+        Codes errors;
+    };
+
+    struct Shard {
+        Shard();
+        ~Shard();
+        std::atomic<Cell*> cells[maxSeries];
+    };
+
+    struct Descriptor {
+        Kind kind;
+        QString endpoint;
+        int lane;
+    };
+
+    struct Usage {
+        Usage();
+        std::atomic<qint64> usedWeight1m;
+        std::atomic<qint64> orderCount10s;
+        std::atomic<qint64> orderCount1m;
+    };
+
+    Shard* shard();
+    Cell* cell(int series);
+    static void bump(std::atomic<quint64>& counter, quint64 by = 1);
+    static void bump(Codes& codes, int code);
+    static QString label(const QString& value);
+
+    const quint64 generation;
+    mutable QMutex mutex;
+    QVector<Descriptor> descriptors;
+    QHash<QString, int> seriesIds;
+    QStringList lanes;
+    int laneOf[maxSeries];
+    Usage usage[maxLanes];
+    QHash<Qt::HANDLE, Shard*> shardByThread;
+    QList<Shard*> shards;
+    QTcpServer server;
+};
+
+#endif // BINANCEMETRICS_H
@@ -0,0 +1,264 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#include "binancemockexchange.h"
+#include <QTimer>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <cstring>
+
+binancemockreply::binancemockreply(QNetworkAccessManager::Operation operation, const QNetworkRequest& request, int httpStatus,
+                                   const QByteArray& body, QObject* parent)
+    : QNetworkReply(parent), body(body), offset(0) {
+    setRequest(request);
+    setUrl(request.url());
+    setOperation(operation);
+    setAttribute(QNetworkRequest::HttpStatusCodeAttribute, httpStatus);
+    setOpenMode(QIODevice::ReadOnly | QIODevice::Unbuffered);
+}
+
+void binancemockreply::deliver() {
+    if (isFinished()) {
+        return;
+    }
+    int httpStatus = attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    setHeader(QNetworkRequest::ContentLengthHeader, body.size());
+    if (httpStatus >= 500) {
+        setError(QNetworkReply::InternalServerError, "Internal server error");
+    } else if (httpStatus == 401 || httpStatus == 403) {
+        setError(QNetworkReply::ContentAccessDenied, "Access denied");
+    } else if (httpStatus == 404) {
+        setError(QNetworkReply::ContentNotFoundError, "Not found");
+    } else if (httpStatus >= 400) {
+        setError(QNetworkReply::UnknownContentError, QString("HTTP %1").arg(httpStatus));
+    }
+    setFinished(true);
+    emit delivered();
+    emit metaDataChanged();
+    emit readyRead();
+    emit finished();
+}
+
+void binancemockreply::abort() {
+}
+
+bool binancemockreply::isSequential() const {
+    return true;
+}
+
+qint64 binancemockreply::bytesAvailable() const {
+    return body.size() - offset + QNetworkReply::bytesAvailable();
+}
+
+qint64 binancemockreply::readData(char* data, qint64 maxSize) {
+    qint64 count = qMin(maxSize, qint64(body.size()) - offset);
+    if (count <= 0) {
+        return -1;
+    }
+    memcpy(data, body.constData() + offset, size_t(count));
+    offset += count;
+    return count;
+}
+
+binancemockexchange::binancemockexchange(QObject* parent)
+    : QNetworkAccessManager(parent), delay(0), clock(0), nextOrderId(1000000) {
+}
+
+void binancemockexchange::setTime(qint64 msecs) {
+    clock = msecs;
+}
+
+qint64 binancemockexchange::time() const {
+    return clock > 0 ? clock : QDateTime::currentMSecsSinceEpoch();
+}
+
+void binancemockexchange::setResponseDelay(int msec) {
+    delay = qMax(0, msec);
+}
+
+void binancemockexchange::setResponse(const QString& path, const QByteArray& body, int httpStatus) {
+    canned.insert(path, qMakePair(httpStatus, body));
+}
+
+QNetworkReply* binancemockexchange::createRequest(Operation operation, const QNetworkRequest& request, QIODevice* outgoingData) {
+    QByteArray payload = outgoingData ? outgoingData->readAll() : QByteArray();
+    const QString path = request.url().path();
+    emit requestReceived(path, payload.isEmpty() ? request.url().query(QUrl::FullyEncoded).toUtf8() : payload);
+
+    int httpStatus = 200;
+    QByteArray body = respond(operation, path, parameters(request.url(), payload), &httpStatus);
+
+    binancemockreply* reply = new binancemockreply(operation, request, httpStatus, body, this);
+    emit responseReady(path);
+    connect(reply, &binancemockreply::delivered, this, [this, path]() { emit responseDelivered(path); });
+    QTimer::singleShot(delay, reply, &binancemockreply::deliver);
+    return reply;
+}
+
+QUrlQuery binancemockexchange::parameters(const QUrl& url, const QByteArray& payload) {
+    // Parameters may come in the query string, the form body, or both.
+    QUrlQuery params(url);
+    if (!payload.isEmpty()) {
+        int question = payload.indexOf('?');
+        QUrlQuery form(QString::fromUtf8(question >= 0 ? payload.mid(question + 1) : payload));
+        const auto items = form.queryItems(QUrl::FullyEncoded);
+        for (const auto& item : items) {
+            if (!params.hasQueryItem(item.first)) {
+                params.addQueryItem(item.first, item.second);
+            }
+        }
+    }
+    return params;
+}
+
+QByteArray binancemockexchange::respond(Operation operation, const QString& path, const QUrlQuery& params, int* httpStatus) {
+    *httpStatus = 200;
+    auto it = canned.constFind(path);
+    if (it != canned.constEnd()) {
+        *httpStatus = it.value().first;
+        return it.value().second;
+    }
+    if (path.endsWith("/v1/order")) {
+        return handleOrder(operation, params);
+    }
+    if (path.endsWith("/v1/batchOrders")) {
+        return handleBatchOrders(operation, params);
+    }
+    if (path.endsWith("/v1/depth")) {
+        int limit = params.hasQueryItem("limit") ? params.queryItemValue("limit").toInt() : 500;
+        return QJsonDocument(depthSnapshot(params.queryItemValue("symbol"), limit)).toJson(QJsonDocument::Compact);
+    }
+    if (path.endsWith("/v1/time")) {
+        return QString("{\"serverTime\":%1}").arg(time()).toUtf8();
+    }
+    if (path.endsWith("/v1/listenKey")) {
+        return "{\"listenKey\":\"local\"}";
+    }
+    if (path.endsWith("/v1/openOrders") || path.endsWith("/v2/positionRisk")) {
+        return "[]";
+    }
+    return "{}";
+}
+
+QJsonObject binancemockexchange::depthSnapshot(const QString& symbol, int limit) {
+    const Book& book = books[symbol];
+    int count = qBound(1, limit, 1000);
+    QJsonObject depth;
+    qint64 now = time();
+    // Like the exchange, the snapshot lands inside the next diff's U..u range.
+    depth.insert("lastUpdateId", book.lastUpdateId + 1);
+    depth.insert("E", now);
+    depth.insert("T", now);
+    depth.insert("bids", levels(book.mid - book.tick, -book.tick, count));
+    depth.insert("asks", levels(book.mid + book.tick, book.tick, count));
+    return depth;
+}
+
+QJsonObject binancemockexchange::nextDepthUpdate(const QString& symbol) {
+    Book& book = books[symbol];
+    qint64 previous = book.lastUpdateId;
+    qint64 first = previous + 1;
+    book.lastUpdateId += 3;
+    qint64 now = time();
+
+    QJsonObject update;
+    update.insert("e", "depthUpdate");
+    update.insert("E", now);
+    update.insert("T", now);
+    update.insert("s", symbol);
+    update.insert("U", first);
+    update.insert("u", book.lastUpdateId);
+    update.insert("pu", previous);
+    update.insert("b", levels(book.mid - book.tick, -book.tick, 3));
+    update.insert("a", levels(book.mid + book.tick, book.tick, 3));
+    return update;
+}
+
+QJsonArray binancemockexchange::levels(double from, double step, int count) {
+    QJsonArray result;
+    for (int i = 0; i < count; ++i) {
+        QJsonArray level;
+        level.append(QString::number(from + i * step, 'f', 2));
+        level.append(QString::number(0.001 * ((i * 7) % 50 + 1), 'f', 3));
+        result.append(level);
+    }
+    return result;
+}
+
+QByteArray binancemockexchange::handleOrder(Operation operation, const QUrlQuery& params) {
+    QJsonObject order;
+    const auto items = params.queryItems(QUrl::FullyDecoded);
+    for (const auto& item : items) {
+        order.insert(item.first, item.second);
+    }
+    QString status = operation == QNetworkAccessManager::DeleteOperation ? "CANCELED" : "NEW";
+    return QJsonDocument(orderResult(order, status)).toJson(QJsonDocument::Compact);
+}
+
+QByteArray binancemockexchange::handleBatchOrders(Operation operation, const QUrlQuery& params) {
+    QJsonArray results;
+    if (operation == QNetworkAccessManager::DeleteOperation) {
+        QString symbol = params.queryItemValue("symbol", QUrl::FullyDecoded);
+        QJsonArray orderIds = QJsonDocument::fromJson(params.queryItemValue("orderIdList", QUrl::FullyDecoded).toUtf8()).array();
+        QJsonArray clientOrderIds = QJsonDocument::fromJson(params.queryItemValue("origClientOrderIdList", QUrl::FullyDecoded).toUtf8()).array();
+        for (int i = 0; i < qMax(orderIds.size(), clientOrderIds.size()); ++i) {
+            QJsonObject order;
+            order.insert("symbol", symbol);
+            order.insert("orderId", orderIds.at(i));
+            order.insert("origClientOrderId", clientOrderIds.at(i));
+            results.append(orderResult(order, "CANCELED"));
+        }
+    } else {
+        QJsonArray orders = QJsonDocument::fromJson(params.queryItemValue("batchOrders", QUrl::FullyDecoded).toUtf8()).array();
+        for (const QJsonValue& order : orders) {
+            results.append(orderResult(order.toObject(), "NEW"));
+        }
+    }
+    return QJsonDocument(results).toJson(QJsonDocument::Compact);
+}
+
+QJsonObject binancemockexchange::orderResult(const QJsonObject& params, const QString& status) {
+    auto text = [&params](const char* key, const char* fallback) {
+        QJsonValue value = params.value(key);
+        return value.isUndefined() || value.isNull() ? QString(fallback) : value.toVariant().toString();
+    };
+    qint64 orderId = params.value("orderId").toVariant().toLongLong();
+    QString clientOrderId = text("newClientOrderId", "");
+    if (clientOrderId.isEmpty()) {
+        clientOrderId = text("origClientOrderId", "");
+    }
+    // Amends and cancels by client id keep the order id the order was placed with.
+    if (orderId <= 0) {
+        orderId = orderIdsByClientId.value(clientOrderId, -1);
+        if (orderId <= 0) {
+            orderId = nextOrderId++;
+        }
+    }
+    if (!clientOrderId.isEmpty()) {
+        orderIdsByClientId.insert(clientOrderId, orderId);
+    }
+
+    QJsonObject result;
+    result.insert("orderId", orderId);
+    result.insert("symbol", text("symbol", ""));
+    result.insert("status", status);
+    result.insert("clientOrderId", clientOrderId);
+    result.insert("price", text("price", "0"));
+    result.insert("avgPrice", "0.00");
+    result.insert("origQty", text("quantity", "0"));
+    result.insert("executedQty", "0");
+    result.insert("cumQuote", "0");
+    result.insert("timeInForce", text("timeInForce", "GTC"));
+    result.insert("type", text("type", "LIMIT"));
+    result.insert("reduceOnly", text("reduceOnly", "false") == "true");
+    result.insert("side", text("side", ""));
+    result.insert("positionSide", text("positionSide", "BOTH"));
+    result.insert("updateTime", time());
+    emit orderChanged(result);
+    return result;
+}
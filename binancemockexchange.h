@@ -0,0 +1,92 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#ifndef BINANCEMOCKEXCHANGE_H
+#define BINANCEMOCKEXCHANGE_H
+
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QHash>
+#include <QPair>
+#include <QUrlQuery>
+#include <QJsonObject>
+#include <QJsonArray>
+
+// A reply that completes later with a body produced in process; emits the
+// same metaDataChanged/readyRead/finished sequence as a network reply.
+class binancemockreply : public QNetworkReply {
+    Q_OBJECT
+public:
+    binancemockreply(QNetworkAccessManager::Operation operation, const QNetworkRequest& request, int httpStatus,
+                     const QByteArray& body, QObject* parent = nullptr);
+
+    void deliver();
+    void abort() override;
+    bool isSequential() const override;
+    qint64 bytesAvailable() const override;
+
+signals:
+    void delivered();
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+
+private:
+    QByteArray body;
+    qint64 offset;
+};
+
+// In-process stand-in for fapi, installed with binanceapi::setNetworkAccessManager.
+// Order endpoints (order, batchOrders) answer like the exchange does for
+// an accepted request, depth/time/listenKey are generated, everything else
+// gets a canned body, "{}" by default. binancelocalserver serves the same
+// responses over real sockets.
+class binancemockexchange : public QNetworkAccessManager {
+    Q_OBJECT
+public:
+    explicit binancemockexchange(QObject* parent = nullptr);
+
+    void setResponseDelay(int msec);
+    void setResponse(const QString& path, const QByteArray& body, int httpStatus = 200);
+    //exchange clock in ms since epoch for replays, 0 follows the wall clock
+    void setTime(qint64 msecs);
+    qint64 time() const;
+
+    QByteArray respond(Operation operation, const QString& path, const QUrlQuery& params, int* httpStatus);
+    static QUrlQuery parameters(const QUrl& url, const QByteArray& payload);
+    QJsonObject depthSnapshot(const QString& symbol, int limit);
+    QJsonObject nextDepthUpdate(const QString& symbol);
+
+signals:
+    void requestReceived(const QString& path, const QByteArray& payload);
+    void responseReady(const QString& path);
+    void responseDelivered(const QString& path);
+    void orderChanged(const QJsonObject& order);
+
+protected:
+    QNetworkReply* createRequest(Operation operation, const QNetworkRequest& request, QIODevice* outgoingData) override;
+
+private:
+    struct Book {
+        qint64 lastUpdateId = 1000;
+        double mid = 30000.0;
+        double tick = 0.1;
+    };
+
+    QByteArray handleOrder(Operation operation, const QUrlQuery& params);
+    QByteArray handleBatchOrders(Operation operation, const QUrlQuery& params);
+    QJsonObject orderResult(const QJsonObject& params, const QString& status);
+    static QJsonArray levels(double from, double step, int count);
+
+    int delay;
+    qint64 clock;
+    qint64 nextOrderId;
+    QHash<QString, qint64> orderIdsByClientId;
+    QHash<QString, QPair<int, QByteArray>> canned;
+    QHash<QString, Book> books;
+};
+
+#endif // BINANCEMOCKEXCHANGE_H
@@ -0,0 +1,239 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#include "binanceorderbook.h"
+#include "binanceapi.h"
+#include "binancelogger.h"
+#include <QTimer>
+
+// Diffs buffered while a snapshot is in flight; past this we resync again
+// instead of growing without bound behind a stalled snapshot request.
+static const int maxBufferedEvents = 20000;
+
+binanceorderbook::binanceorderbook(binanceapi* api, QObject* parent)
+    : QObject(parent), api(api) {
+    connect(api, &binanceapi::marketStreamEventReceived, this, &binanceorderbook::handleStreamEvent);
+    connect(api, &binanceapi::depthReceived, this, &binanceorderbook::handleSnapshot);
+    connect(api, &binanceapi::depthRequestFailed, this, &binanceorderbook::handleSnapshotFailed);
+    connect(api, &binanceapi::marketStreamDisconnected, this, &binanceorderbook::handleStreamDisconnected);
+    connect(api, &binanceapi::marketStreamConnected, this, &binanceorderbook::handleStreamConnected);
+}
+
+void binanceorderbook::track(const QString& symbol, int snapshotLimit, const QString& speed) {
+    QString key = symbol.toUpper();
+    if (books.contains(key)) {
+        return;
+    }
+
+    Book& book = books[key];
+    book.stream = symbol.toLower() + "@depth" + (speed.isEmpty() ? QString() : "@" + speed);
+    book.snapshotLimit = snapshotLimit;
+
+    // Subscribe first so that every diff after the snapshot is already being buffered.
+    api->subscribeMarketStreams(QStringList() << book.stream);
+    book.resyncTimer.start();
+    requestSnapshot(key, book);
+}
+
+void binanceorderbook::untrack(const QString& symbol) {
+    auto it = books.find(symbol.toUpper());
+    if (it == books.end()) {
+        return;
+    }
+    api->unsubscribeMarketStreams(QStringList() << it.value().stream);
+    books.erase(it);
+}
+
+void binanceorderbook::resync(const QString& symbol) {
+    auto it = books.find(symbol.toUpper());
+    if (it == books.end()) {
+        return;
+    }
+    Book& book = it.value();
+    if (!book.live && book.snapshotPending) {
+        return;
+    }
+
+    book.stats.resyncCount++;
+    book.resyncTimer.start();
+    book.live = false;
+    book.bids.clear();
+    book.asks.clear();
+    book.buffered.clear();
+    requestSnapshot(it.key(), book);
+}
+
+void binanceorderbook::requestSnapshot(const QString& symbol, Book& book) {
+    book.snapshotPending = true;
+    api->getDepth(symbol, book.snapshotLimit);
+}
+
+bool binanceorderbook::isLive(const QString& symbol) const {
+    auto it = books.constFind(symbol.toUpper());
+    return it != books.constEnd() && it.value().live;
+}
+
+qint64 binanceorderbook::lastUpdateId(const QString& symbol) const {
+    auto it = books.constFind(symbol.toUpper());
+    if (it == books.constEnd()) {
+        return -1;
+    }
+    return it.value().previousFinalId >= 0 ? it.value().previousFinalId : it.value().lastUpdateId;
+}
+
+QMap<double, double> binanceorderbook::bids(const QString& symbol) const {
+    return books.value(symbol.toUpper()).bids;
+}
+
+QMap<double, double> binanceorderbook::asks(const QString& symbol) const {
+    return books.value(symbol.toUpper()).asks;
+}
+
+binanceorderbook::Stats binanceorderbook::stats(const QString& symbol) const {
+    return books.value(symbol.toUpper()).stats;
+}
+
+void binanceorderbook::handleStreamEvent(const QString& stream, const QJsonValue& data) {
+    if (!stream.contains("@depth")) {
+        return;
+    }
+    QJsonObject event = data.toObject();
+    QString symbol = event.value("s").toString();
+    auto it = books.find(symbol);
+    if (it == books.end()) {
+        return;
+    }
+    Book& book = it.value();
+
+    if (book.snapshotPending) {
+        book.buffered.append(event);
+        if (book.buffered.size() > maxBufferedEvents) {
+            api->logMessage(binancelogger::Warning, "Depth buffer overflow while waiting for snapshot:", 0, symbol);
+            book.buffered.clear();
+            requestSnapshot(symbol, book);
+        }
+        return;
+    }
+
+    // Diffs older than the snapshot are skipped without touching the book.
+    bool wasLive = book.live;
+    qint64 previousFinalId = book.previousFinalId;
+    if (!applyNext(symbol, book, event) || book.previousFinalId == previousFinalId) {
+        return;
+    }
+    if (!wasLive) {
+        finishResync(symbol, book);
+    }
+    emit bookUpdated(symbol);
+}
+
+void binanceorderbook::handleSnapshot(const QString& symbol, const QJsonObject& depth) {
+    auto it = books.find(symbol.toUpper());
+    if (it == books.end() || !it.value().snapshotPending) {
+        return;
+    }
+    Book& book = it.value();
+    book.snapshotPending = false;
+    book.lastUpdateId = depth.value("lastUpdateId").toVariant().toLongLong();
+    book.previousFinalId = -1;
+    book.bids.clear();
+    book.asks.clear();
+    applyLevels(book.bids, depth.value("bids").toArray());
+    applyLevels(book.asks, depth.value("asks").toArray());
+
+    const QVector<QJsonObject> buffered = book.buffered;
+    book.buffered.clear();
+    for (int i = 0; i < buffered.size(); ++i) {
+        if (!applyNext(it.key(), book, buffered.at(i))) {
+            // applyNext already asked for a new snapshot; the newer diffs are kept for it.
+            book.buffered = buffered.mid(i + 1);
+            return;
+        }
+    }
+
+    // Without a straddling diff yet the book goes live from handleStreamEvent.
+    if (book.live) {
+        finishResync(it.key(), book);
+        emit bookUpdated(it.key());
+    }
+}
+
+void binanceorderbook::finishResync(const QString& symbol, Book& book) {
+    book.stats.lastResyncMs = book.resyncTimer.elapsed();
+    book.stats.totalResyncMs += book.stats.lastResyncMs;
+    emit bookResynced(symbol, book.stats.lastResyncMs);
+}
+
+void binanceorderbook::handleSnapshotFailed(const QString& symbol) {
+    auto it = books.find(symbol.toUpper());
+    if (it == books.end() || !it.value().snapshotPending) {
+        return;
+    }
+    QString key = it.key();
+    QTimer::singleShot(500, this, [this, key]() {
+        auto retry = books.find(key);
+        if (retry != books.end() && retry.value().snapshotPending) {
+            requestSnapshot(key, retry.value());
+        }
+    });
+}
+
+void binanceorderbook::handleStreamDisconnected() {
+    // No diffs flow until binanceapi reconnects; a snapshot taken now would go stale.
+    for (auto it = books.begin(); it != books.end(); ++it) {
+        it.value().live = false;
+        it.value().buffered.clear();
+    }
+}
+
+void binanceorderbook::handleStreamConnected() {
+    for (auto it = books.begin(); it != books.end(); ++it) {
+        resync(it.key());
+    }
+}
+
+bool binanceorderbook::applyNext(const QString& symbol, Book& book, const QJsonObject& event) {
+    qint64 firstId = event.value("U").toVariant().toLongLong();
+    qint64 finalId = event.value("u").toVariant().toLongLong();
+    qint64 previousId = event.value("pu").toVariant().toLongLong();
+
+    if (book.previousFinalId < 0) {
+        // First diff after the snapshot must straddle lastUpdateId.
+        if (finalId < book.lastUpdateId) {
+            return true;
+        }
+        if (firstId > book.lastUpdateId) {
+            book.stats.gapCount++;
+            emit gapDetected(symbol, book.lastUpdateId, firstId);
+            resync(symbol);
+            return false;
+        }
+    } else if (previousId != book.previousFinalId) {
+        book.stats.gapCount++;
+        emit gapDetected(symbol, book.previousFinalId, previousId);
+        resync(symbol);
+        return false;
+    }
+
+    applyLevels(book.bids, event.value("b").toArray());
+    applyLevels(book.asks, event.value("a").toArray());
+    book.previousFinalId = finalId;
+    book.live = true;
+    return true;
+}
+
+void binanceorderbook::applyLevels(QMap<double, double>& side, const QJsonArray& levels) {
+    for (const QJsonValue& level : levels) {
+        QJsonArray pair = level.toArray();
+        double price = pair.at(0).toString().toDouble();
+        double quantity = pair.at(1).toString().toDouble();
+        if (quantity == 0.0) {
+            side.remove(price);
+        } else {
+            side.insert(price, quantity);
+        }
+    }
+}
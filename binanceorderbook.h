@@ -0,0 +1,82 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#ifndef BINANCEORDERBOOK_H
+#define BINANCEORDERBOOK_H
+
+#include <QObject>
+#include <QHash>
+#include <QMap>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QJsonArray>
+
+class binanceapi;
+
+// Local order books built from a /depth snapshot plus the @depth diff stream.
+// Every diff is checked against the U/u/pu sequence ids; a gap only resyncs
+// the symbol it happened on, the shared stream connection stays up. A book is
+// live only once a diff straddling the snapshot has been applied; after a
+// stream drop every book waits for the reconnect and resyncs then.
+class binanceorderbook : public QObject {
+    Q_OBJECT
+public:
+    struct Stats {
+        int resyncCount = 0;
+        int gapCount = 0;
+        qint64 lastResyncMs = 0;
+        qint64 totalResyncMs = 0;
+    };
+
+    explicit binanceorderbook(binanceapi* api, QObject* parent = nullptr);
+    void track(const QString& symbol, int snapshotLimit = 1000, const QString& speed = "100ms");
+    void untrack(const QString& symbol);
+    void resync(const QString& symbol);
+
+    bool isLive(const QString& symbol) const;
+    qint64 lastUpdateId(const QString& symbol) const;
+    QMap<double, double> bids(const QString& symbol) const;
+    QMap<double, double> asks(const QString& symbol) const;
+    Stats stats(const QString& symbol) const;
+
+signals:
+    void bookUpdated(const QString& symbol);
+    void bookResynced(const QString& symbol, qint64 durationMs);
+    void gapDetected(const QString& symbol, qint64 expectedPu, qint64 receivedPu);
+
+private slots:
+    void handleStreamEvent(const QString& stream, const QJsonValue& data);
+    void handleSnapshot(const QString& symbol, const QJsonObject& depth);
+    void handleSnapshotFailed(const QString& symbol);
+    void handleStreamDisconnected();
+    void handleStreamConnected();
+
+private:
+    struct Book {
+        QString stream;
+        int snapshotLimit = 1000;
+        QMap<double, double> bids;
+        QMap<double, double> asks;
+        qint64 lastUpdateId = -1;
+        qint64 previousFinalId = -1;
+        bool live = false;
+        bool snapshotPending = false;
+        QVector<QJsonObject> buffered;
+        QElapsedTimer resyncTimer;
+        Stats stats;
+    };
+
+    void requestSnapshot(const QString& symbol, Book& book);
+    bool applyNext(const QString& symbol, Book& book, const QJsonObject& event);
+    void finishResync(const QString& symbol, Book& book);
+    static void applyLevels(QMap<double, double>& side, const QJsonArray& levels);
+
+    binanceapi* api;
+    QHash<QString, Book> books;
+};
+
+#endif // BINANCEORDERBOOK_H
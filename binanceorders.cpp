@@ -0,0 +1,426 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#include "binanceorders.h"
+#include "binanceapi.h"
+#include "binancelogger.h"
+#include <QDateTime>
+
+binanceorders::binanceorders(binanceapi* api, QObject* parent)
+    : QObject(parent), api(api), needsReconcile(true) {
+    connect(api, &binanceapi::newOrderResponseReceived, this, &binanceorders::handleOrderResponse);
+    connect(api, &binanceapi::orderStatusReceived, this, &binanceorders::handleOrderResponse);
+    connect(api, &binanceapi::modifyOrderResponseReceived, this, &binanceorders::handleAmendResponse);
+    connect(api, &binanceapi::cancelOrderResponseReceived, this, &binanceorders::handleCancelResponse);
+    connect(api, &binanceapi::orderRequestFailed, this, &binanceorders::handleOrderFailed);
+    connect(api, &binanceapi::userStreamEventReceived, this, &binanceorders::handleUserStreamEvent);
+    connect(api, &binanceapi::openOrdersReceived, this, &binanceorders::handleOpenOrders);
+    connect(api, &binanceapi::openOrdersFailed, this, &binanceorders::handleOpenOrdersFailed);
+    connect(api, &binanceapi::orderStatusFailed, this, &binanceorders::handleOrderStatusFailed);
+    connect(api, &binanceapi::userStreamDisconnected, this, &binanceorders::handleUserStreamDisconnected);
+    connect(api, &binanceapi::userStreamConnected, this, [this]() {
+        if (needsReconcile) {
+            reconcile();
+        }
+    });
+}
+
+void binanceorders::setStrategyId(int strategy) {
+    ids.setStrategy(strategy);
+}
+
+binanceclientid& binanceorders::clientIds() {
+    return ids;
+}
+
+void binanceorders::start() {
+    api->openUserStream();
+}
+
+void binanceorders::reconcile(const QString& symbol) {
+    api->getOpenOrders(symbol, -1, QDateTime::currentMSecsSinceEpoch());
+}
+
+int binanceorders::submitNew(const QString& symbol, const QString& side, const QString& type, const QString& timeInForce,
+                             const QString& price, const QString& quantity, const QString& clientOrderId,
+                             const QString& positionSide, const QString& reduceOnly) {
+    QString id = clientOrderId.isEmpty() ? QString::fromLatin1(ids.next()) : clientOrderId;
+    int slot = allocate(id);
+    Order& entry = orders[slot];
+    entry.symbol = symbol;
+    entry.side = side;
+    entry.positionSide = positionSide;
+    entry.type = type;
+    entry.timeInForce = timeInForce;
+    entry.price = price.toDouble();
+    entry.origQty = quantity.toDouble();
+    setStatus(slot, PendingNew);
+
+    api->sendNewOrder(symbol, side, positionSide, type, timeInForce, quantity, reduceOnly, price, id,
+                      QString(), QString(), QString(), QString(), QString(), QString(), "ACK",
+                      -1, QDateTime::currentMSecsSinceEpoch());
+    return slot;
+}
+
+bool binanceorders::submitAmend(int slot, const QString& price, const QString& quantity) {
+    if (slot < 0 || slot >= orders.size()) {
+        return false;
+    }
+    Order& entry = orders[slot];
+    if (!isOpen(entry.status) || entry.status == PendingNew || entry.pendingAmend || entry.pendingCancel) {
+        return false;
+    }
+    entry.pendingAmend = true;
+    api->modifyOrder(entry.orderId, entry.clientOrderId, entry.symbol, entry.side, quantity, price,
+                     -1, QDateTime::currentMSecsSinceEpoch());
+    emit orderUpdated(slot);
+    return true;
+}
+
+int binanceorders::submitAmends(const QVector<Amend>& amends) {
+    QJsonArray batch;
+    int submitted = 0;
+    for (const Amend& amend : amends) {
+        if (amend.slot < 0 || amend.slot >= orders.size()) {
+            continue;
+        }
+        Order& entry = orders[amend.slot];
+        if (!isOpen(entry.status) || entry.status == PendingNew || entry.pendingAmend || entry.pendingCancel) {
+            continue;
+        }
+        entry.pendingAmend = true;
+        QJsonObject order;
+        order.insert("orderId", QString::number(entry.orderId));
+        order.insert("origClientOrderId", entry.clientOrderId);
+        order.insert("symbol", entry.symbol);
+        order.insert("side", entry.side);
+        order.insert("quantity", amend.quantity);
+        order.insert("price", amend.price);
+        batch.append(order);
+        ++submitted;
+        emit orderUpdated(amend.slot);
+
+        // batchOrders takes at most five entries per request.
+        if (batch.size() == 5) {
+            api->batchModifyOrders(batch, -1, QDateTime::currentMSecsSinceEpoch());
+            batch = QJsonArray();
+        }
+    }
+    if (batch.size() == 1) {
+        QJsonObject order = batch.first().toObject();
+        api->modifyOrder(order.value("orderId").toString().toLongLong(), order.value("origClientOrderId").toString(),
+                         order.value("symbol").toString(), order.value("side").toString(), order.value("quantity").toString(),
+                         order.value("price").toString(), -1, QDateTime::currentMSecsSinceEpoch());
+    } else if (!batch.isEmpty()) {
+        api->batchModifyOrders(batch, -1, QDateTime::currentMSecsSinceEpoch());
+    }
+    return submitted;
+}
+
+bool binanceorders::submitCancel(int slot) {
+    if (slot < 0 || slot >= orders.size()) {
+        return false;
+    }
+    Order& entry = orders[slot];
+    if (!isOpen(entry.status) || entry.pendingCancel) {
+        return false;
+    }
+    entry.pendingCancel = true;
+    api->cancelOrder(entry.symbol, entry.orderId, entry.clientOrderId, -1, QDateTime::currentMSecsSinceEpoch());
+    emit orderUpdated(slot);
+    return true;
+}
+
+int binanceorders::slotOf(const QString& clientOrderId) const {
+    qint64 sequence = ids.sequenceOf(clientOrderId);
+    if (sequence >= 0) {
+        return sequence < slotBySequence.size() ? slotBySequence.at(int(sequence)) : -1;
+    }
+    return slots.value(clientOrderId, -1);
+}
+
+const binanceorders::Order* binanceorders::order(int slot) const {
+    return slot >= 0 && slot < orders.size() ? &orders.at(slot) : nullptr;
+}
+
+const binanceorders::Fill* binanceorders::fill(int index) const {
+    return index >= 0 && index < fillLog.size() ? &fillLog.at(index) : nullptr;
+}
+
+QVector<int> binanceorders::openOrders(const QString& symbol) const {
+    QVector<int> result;
+    if (!symbol.isEmpty()) {
+        const QSet<int> open = openBySymbol.value(symbol);
+        result.reserve(open.size());
+        for (int slot : open) {
+            result.append(slot);
+        }
+        return result;
+    }
+    for (auto it = openBySymbol.constBegin(); it != openBySymbol.constEnd(); ++it) {
+        for (int slot : it.value()) {
+            result.append(slot);
+        }
+    }
+    return result;
+}
+
+int binanceorders::openOrderCount(const QString& symbol) const {
+    auto it = openBySymbol.constFind(symbol);
+    return it == openBySymbol.constEnd() ? 0 : it.value().size();
+}
+
+QStringList binanceorders::symbolsWithOpenOrders() const {
+    QStringList symbols;
+    for (auto it = openBySymbol.constBegin(); it != openBySymbol.constEnd(); ++it) {
+        if (!it.value().isEmpty()) {
+            symbols.append(it.key());
+        }
+    }
+    return symbols;
+}
+
+bool binanceorders::isOpen(Status status) {
+    return status == PendingNew || status == New || status == PartiallyFilled;
+}
+
+int binanceorders::allocate(const QString& clientOrderId) {
+    int slot = slotOf(clientOrderId);
+    if (slot >= 0) {
+        return slot;
+    }
+    slot = orders.size();
+    orders.append(Order());
+    orders[slot].clientOrderId = clientOrderId;
+    orders[slot].status = Expired;
+
+    // Our own ids map straight to the slot through their counter.
+    qint64 sequence = ids.sequenceOf(clientOrderId);
+    if (sequence >= 0) {
+        while (slotBySequence.size() <= sequence) {
+            slotBySequence.append(-1);
+        }
+        slotBySequence[int(sequence)] = slot;
+    } else {
+        slots.insert(clientOrderId, slot);
+    }
+    return slot;
+}
+
+void binanceorders::setStatus(int slot, Status status) {
+    Order& entry = orders[slot];
+    bool wasOpen = isOpen(entry.status) && openBySymbol.value(entry.symbol).contains(slot);
+    entry.status = status;
+    if (isOpen(status) == wasOpen) {
+        return;
+    }
+
+    QSet<int>& open = openBySymbol[entry.symbol];
+    if (isOpen(status)) {
+        open.insert(slot);
+        if (open.size() == 1) {
+            emit exposureChanged(entry.symbol, true);
+        }
+    } else {
+        entry.pendingAmend = false;
+        entry.pendingCancel = false;
+        open.remove(slot);
+        if (open.isEmpty()) {
+            emit exposureChanged(entry.symbol, false);
+        }
+    }
+}
+
+binanceorders::Status binanceorders::parseStatus(const QString& status) {
+    if (status == "NEW") {
+        return New;
+    }
+    if (status == "PARTIALLY_FILLED") {
+        return PartiallyFilled;
+    }
+    if (status == "FILLED") {
+        return Filled;
+    }
+    if (status == "CANCELED") {
+        return Canceled;
+    }
+    if (status == "REJECTED") {
+        return Rejected;
+    }
+    return Expired;
+}
+
+int binanceorders::apply(const QJsonObject& order) {
+    QString clientOrderId = order.value("clientOrderId").toString();
+    if (clientOrderId.isEmpty()) {
+        return -1;
+    }
+    int slot = allocate(clientOrderId);
+    Order& entry = orders[slot];
+
+    // REST answers and stream events race each other; never move backwards.
+    qint64 updateTime = order.value("updateTime").toVariant().toLongLong();
+    if (updateTime < entry.updateTime) {
+        return slot;
+    }
+    entry.updateTime = updateTime;
+    entry.symbol = order.value("symbol").toString();
+    entry.orderId = order.value("orderId").toVariant().toLongLong();
+    entry.side = order.value("side").toString();
+    entry.positionSide = order.value("positionSide").toString();
+    entry.type = order.value("type").toString();
+    entry.timeInForce = order.value("timeInForce").toString();
+    entry.price = order.value("price").toString().toDouble();
+    entry.origQty = order.value("origQty").toString().toDouble();
+    entry.executedQty = qMax(entry.executedQty, order.value("executedQty").toString().toDouble());
+    entry.avgPrice = order.value("avgPrice").toString().toDouble();
+    setStatus(slot, parseStatus(order.value("status").toString()));
+    return slot;
+}
+
+void binanceorders::handleOrderResponse(const QJsonObject& result) {
+    int slot = apply(result);
+    if (slot >= 0) {
+        emit orderUpdated(slot);
+    }
+}
+
+void binanceorders::handleAmendResponse(const QJsonObject& result) {
+    int slot = apply(result);
+    if (slot >= 0) {
+        orders[slot].pendingAmend = false;
+        emit orderUpdated(slot);
+    }
+}
+
+void binanceorders::handleCancelResponse(const QJsonObject& result) {
+    int slot = apply(result);
+    if (slot >= 0) {
+        orders[slot].pendingCancel = false;
+        emit orderUpdated(slot);
+    }
+}
+
+void binanceorders::handleOrderFailed(const QString& clientOrderId, int code, const QString& message) {
+    int slot = slotOf(clientOrderId);
+    if (slot < 0) {
+        return;
+    }
+    Order& entry = orders[slot];
+    api->logMessage(binancelogger::Warning, "Order request failed:", code, clientOrderId + ' ' + message);
+    if (entry.status == PendingNew) {
+        setStatus(slot, Rejected);
+    } else {
+        entry.pendingAmend = false;
+        entry.pendingCancel = false;
+        // Unknown order on amend/cancel: it closed on the exchange before we heard about it.
+        if (code == -2011 || code == -2013) {
+            api->checkOrderStatus(entry.symbol, entry.orderId, entry.clientOrderId, -1, QDateTime::currentMSecsSinceEpoch());
+        }
+    }
+    emit orderUpdated(slot);
+}
+
+void binanceorders::handleUserStreamEvent(const QJsonObject& event) {
+    if (event.value("e").toString() != "ORDER_TRADE_UPDATE") {
+        return;
+    }
+    QJsonObject update = event.value("o").toObject();
+    QString clientOrderId = update.value("c").toString();
+    int slot = allocate(clientOrderId);
+    Order& entry = orders[slot];
+
+    qint64 updateTime = update.value("T").toVariant().toLongLong();
+    if (updateTime >= entry.updateTime) {
+        entry.updateTime = updateTime;
+        entry.symbol = update.value("s").toString();
+        entry.orderId = update.value("i").toVariant().toLongLong();
+        entry.side = update.value("S").toString();
+        entry.positionSide = update.value("ps").toString();
+        entry.type = update.value("o").toString();
+        entry.timeInForce = update.value("f").toString();
+        entry.price = update.value("p").toString().toDouble();
+        entry.origQty = update.value("q").toString().toDouble();
+        entry.executedQty = qMax(entry.executedQty, update.value("z").toString().toDouble());
+        entry.avgPrice = update.value("ap").toString().toDouble();
+        if (update.value("x").toString() == "AMENDMENT") {
+            entry.pendingAmend = false;
+        }
+        setStatus(slot, parseStatus(update.value("X").toString()));
+    }
+
+    int fillIndex = -1;
+    if (update.value("x").toString() == "TRADE") {
+        Fill trade;
+        trade.slot = slot;
+        trade.tradeId = update.value("t").toVariant().toLongLong();
+        trade.price = update.value("L").toString().toDouble();
+        trade.quantity = update.value("l").toString().toDouble();
+        trade.commission = update.value("n").toString().toDouble();
+        trade.commissionAsset = update.value("N").toString();
+        trade.maker = update.value("m").toBool();
+        trade.time = updateTime;
+        fillIndex = fillLog.size();
+        fillLog.append(trade);
+        orders[slot].fills.append(fillIndex);
+    }
+
+    emit orderUpdated(slot);
+    if (fillIndex >= 0) {
+        emit orderFilled(slot, fillIndex);
+    }
+}
+
+void binanceorders::handleOpenOrders(const QString& symbol, const QJsonArray& openOrders) {
+    QSet<int> seen;
+    for (const QJsonValue& value : openOrders) {
+        int slot = apply(value.toObject());
+        if (slot >= 0) {
+            seen.insert(slot);
+            emit orderUpdated(slot);
+        }
+    }
+
+    // Anything we still think is open but the exchange does not list closed
+    // while we were not listening; ask for its final state.
+    const QVector<int> local = this->openOrders(symbol);
+    for (int slot : local) {
+        const Order& entry = orders.at(slot);
+        if (!seen.contains(slot) && entry.status != PendingNew) {
+            api->checkOrderStatus(entry.symbol, entry.orderId, entry.clientOrderId, -1, QDateTime::currentMSecsSinceEpoch());
+        }
+    }
+    if (symbol.isEmpty()) {
+        needsReconcile = false;
+    }
+    emit reconciled(symbol);
+}
+
+void binanceorders::handleOpenOrdersFailed(const QString& symbol, int code, const QString& message) {
+    api->logMessage(binancelogger::Warning, "Reconcile failed:", code, symbol + ' ' + message);
+    // Retried with the next user stream connect or an explicit reconcile().
+    needsReconcile = true;
+    emit reconcileFailed(symbol, code, message);
+}
+
+void binanceorders::handleOrderStatusFailed(const QString& clientOrderId, int code, const QString& message) {
+    int slot = slotOf(clientOrderId);
+    if (slot < 0) {
+        return;
+    }
+    // -2013: the exchange has no such order, so it is not open either.
+    if (code == -2013) {
+        setStatus(slot, Expired);
+        emit orderUpdated(slot);
+        return;
+    }
+    needsReconcile = true;
+    emit reconcileFailed(orders.at(slot).symbol, code, message);
+}
+
+void binanceorders::handleUserStreamDisconnected() {
+    needsReconcile = true;
+}
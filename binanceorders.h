@@ -0,0 +1,133 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#ifndef BINANCEORDERS_H
+#define BINANCEORDERS_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QJsonObject>
+#include <QJsonArray>
+#include "binanceclientid.h"
+
+class binanceapi;
+
+// In-process order management. Every order we know about owns a slot in a
+// dense table; acks, fills and cancels from REST responses and the user data
+// stream are applied to that slot, so open orders and fills are answered
+// locally. getOpenOrders is only used to reconcile at startup and after the
+// user stream dropped.
+class binanceorders : public QObject {
+    Q_OBJECT
+public:
+    enum Status {
+        PendingNew,
+        New,
+        PartiallyFilled,
+        Filled,
+        Canceled,
+        Rejected,
+        Expired
+    };
+
+    struct Order {
+        QString symbol;
+        QString clientOrderId;
+        qint64 orderId = -1;
+        QString side;
+        QString positionSide;
+        QString type;
+        QString timeInForce;
+        double price = 0.0;
+        double origQty = 0.0;
+        double executedQty = 0.0;
+        double avgPrice = 0.0;
+        Status status = PendingNew;
+        bool pendingAmend = false;
+        bool pendingCancel = false;
+        qint64 updateTime = 0;
+        QVector<int> fills;
+    };
+
+    struct Fill {
+        int slot = -1;
+        qint64 tradeId = -1;
+        double price = 0.0;
+        double quantity = 0.0;
+        double commission = 0.0;
+        QString commissionAsset;
+        bool maker = false;
+        qint64 time = 0;
+    };
+
+    struct Amend {
+        int slot = -1;
+        QString price;
+        QString quantity;
+    };
+
+    explicit binanceorders(binanceapi* api, QObject* parent = nullptr);
+
+    //strategy encoded into generated clientOrderIds, set before submitting; not a reserved binanceclientid strategy
+    void setStrategyId(int strategy);
+    binanceclientid& clientIds();
+
+    void start();
+    void reconcile(const QString& symbol = QString());
+
+    int submitNew(const QString& symbol, const QString& side, const QString& type, const QString& timeInForce,
+                  const QString& price, const QString& quantity, const QString& clientOrderId = QString(),
+                  const QString& positionSide = QString(), const QString& reduceOnly = QString());
+    bool submitAmend(int slot, const QString& price, const QString& quantity);
+    int submitAmends(const QVector<Amend>& amends);
+    bool submitCancel(int slot);
+
+    int slotOf(const QString& clientOrderId) const;
+    const Order* order(int slot) const;
+    const Fill* fill(int index) const;
+    QVector<int> openOrders(const QString& symbol = QString()) const;
+    int openOrderCount(const QString& symbol) const;
+    QStringList symbolsWithOpenOrders() const;
+    static bool isOpen(Status status);
+
+signals:
+    void orderUpdated(int slot);
+    void orderFilled(int slot, int fill);
+    void exposureChanged(const QString& symbol, bool hasOpenOrders);
+    void reconciled(const QString& symbol);
+    //local state may be stale until the next successful reconcile
+    void reconcileFailed(const QString& symbol, int code, const QString& message);
+
+private slots:
+    void handleOrderResponse(const QJsonObject& result);
+    void handleAmendResponse(const QJsonObject& result);
+    void handleCancelResponse(const QJsonObject& result);
+    void handleOrderFailed(const QString& clientOrderId, int code, const QString& message);
+    void handleUserStreamEvent(const QJsonObject& event);
+    void handleOpenOrders(const QString& symbol, const QJsonArray& orders);
+    void handleOpenOrdersFailed(const QString& symbol, int code, const QString& message);
+    void handleOrderStatusFailed(const QString& clientOrderId, int code, const QString& message);
+    void handleUserStreamDisconnected();
+
+private:
+    int allocate(const QString& clientOrderId);
+    int apply(const QJsonObject& order);
+    void setStatus(int slot, Status status);
+    static Status parseStatus(const QString& status);
+
+    binanceapi* api;
+    QVector<Order> orders;
+    QVector<Fill> fillLog;
+    QHash<QString, int> slots;
+    QHash<QString, QSet<int>> openBySymbol;
+    bool needsReconcile;
+    binanceclientid ids;
+    QVector<int> slotBySequence;
+};
+
+#endif // BINANCEORDERS_H
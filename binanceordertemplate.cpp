@@ -0,0 +1,133 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#include "binanceordertemplate.h"
+#include "binanceapi.h"
+#include <QDateTime>
+#include <QUrl>
+
+binanceordertemplate::binanceordertemplate(binanceapi* api, const QString& symbol, const QString& side, const QString& type,
+                                           const QString& timeInForce, const QString& positionSide,
+                                           const QString& newOrderRespType, int priceDecimals, int quantityDecimals,
+                                           qint64 recvWindow)
+    : api(api), request(api->endpointRequest(binanceendpointid::NewOrder)), mac(QCryptographicHash::Sha256),
+      prefixLength(0), priceDecimals(priceDecimals), quantityDecimals(quantityDecimals) {
+    api->keySigner(mac);
+
+    buffer.reserve(512);
+    buffer += "symbol=" + QUrl::toPercentEncoding(symbol);
+    buffer += "&side=" + QUrl::toPercentEncoding(side);
+    if (!positionSide.isEmpty()) {
+        buffer += "&positionSide=" + QUrl::toPercentEncoding(positionSide);
+    }
+    buffer += "&type=" + QUrl::toPercentEncoding(type);
+    if (!timeInForce.isEmpty()) {
+        buffer += "&timeInForce=" + QUrl::toPercentEncoding(timeInForce);
+    }
+    if (!newOrderRespType.isEmpty()) {
+        buffer += "&newOrderRespType=" + QUrl::toPercentEncoding(newOrderRespType);
+    }
+    if (recvWindow >= 0) {
+        buffer += "&recvWindow=" + QByteArray::number(recvWindow);
+    }
+    prefixLength = buffer.size();
+    signatureHex.reserve(64);
+}
+
+int binanceordertemplate::writeInteger(char* out, qint64 value) {
+    char digits[24];
+    int count = 0;
+    bool negative = value < 0;
+    quint64 magnitude = negative ? quint64(-(value + 1)) + 1 : quint64(value);
+    do {
+        digits[count++] = char('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+
+    int length = 0;
+    if (negative) {
+        out[length++] = '-';
+    }
+    while (count) {
+        out[length++] = digits[--count];
+    }
+    return length;
+}
+
+int binanceordertemplate::writeFixed(char* out, qint64 mantissa, int decimals) {
+    if (decimals <= 0) {
+        return writeInteger(out, mantissa);
+    }
+    char digits[24];
+    int count = 0;
+    quint64 magnitude = mantissa < 0 ? quint64(-(mantissa + 1)) + 1 : quint64(mantissa);
+    do {
+        digits[count++] = char('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+    while (count <= decimals) {
+        digits[count++] = '0';
+    }
+
+    int length = 0;
+    if (mantissa < 0) {
+        out[length++] = '-';
+    }
+    while (count) {
+        if (count == decimals) {
+            out[length++] = '.';
+        }
+        out[length++] = digits[--count];
+    }
+    return length;
+}
+
+const QByteArray& binanceordertemplate::encode(qint64 price, qint64 quantity, const QByteArray& clientOrderId, qint64 timestamp) {
+    // Shrinking keeps the reserved capacity, so encoding does not allocate.
+    buffer.resize(prefixLength);
+
+    char scratch[64];
+    if (price > 0) {
+        buffer.append("&price=", 7);
+        buffer.append(scratch, writeFixed(scratch, price, priceDecimals));
+    }
+    buffer.append("&quantity=", 10);
+    buffer.append(scratch, writeFixed(scratch, quantity, quantityDecimals));
+    if (!clientOrderId.isEmpty()) {
+        buffer.append("&newClientOrderId=", 18);
+        buffer.append(clientOrderId);
+    }
+    buffer.append("&timestamp=", 11);
+    buffer.append(scratch, writeInteger(scratch, timestamp));
+    return buffer;
+}
+
+const QByteArray& binanceordertemplate::sign() {
+    mac.reset();
+    mac.addData(buffer);
+    signatureHex = mac.result().toHex();
+    // The exchange reads the signature from the parameters, never from a header.
+    buffer.append("&signature=", 11);
+    buffer.append(signatureHex);
+    return signatureHex;
+}
+
+void binanceordertemplate::send(qint64 price, qint64 quantity, const QByteArray& clientOrderId, qint64 timestamp) {
+    encode(price, quantity, clientOrderId, timestamp >= 0 ? timestamp : QDateTime::currentMSecsSinceEpoch());
+    sign();
+    clientOrderIdText = QString::fromLatin1(clientOrderId);
+    // A deliberate copy: posting buffer itself would share it with the
+    // upload, and the next encode() would detach it anyway.
+    api->postSignedOrder(request, QByteArray(buffer.constData(), buffer.size()), clientOrderIdText);
+}
+
+const QByteArray& binanceordertemplate::payload() const {
+    return buffer;
+}
+
+const QByteArray& binanceordertemplate::signature() const {
+    return signatureHex;
+}
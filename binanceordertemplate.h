@@ -0,0 +1,58 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#ifndef BINANCEORDERTEMPLATE_H
+#define BINANCEORDERTEMPLATE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QNetworkRequest>
+#include <QMessageAuthenticationCode>
+
+class binanceapi;
+
+// A new-order payload with the constant fields (symbol, side, type,
+// timeInForce, positionSide, newOrderRespType, recvWindow) encoded once.
+// Per order only price, quantity, clientOrderId and timestamp are written
+// into the reserved tail of the buffer, which is then signed with a
+// pre-keyed HMAC whose hex digest is appended as the signature parameter.
+// Prices and quantities are fixed point integers (ticks/lots) so no
+// floating point formatting is involved. send() posts a copy of the
+// buffer, the network layer keeps it until the upload is done.
+// Orders sent this way bypass the optional binancevalidator.
+class binanceordertemplate {
+public:
+    binanceordertemplate(binanceapi* api, const QString& symbol, const QString& side, const QString& type,
+                         const QString& timeInForce, const QString& positionSide = QString(),
+                         const QString& newOrderRespType = "ACK", int priceDecimals = 2, int quantityDecimals = 3,
+                         qint64 recvWindow = -1);
+
+    const QByteArray& encode(qint64 price, qint64 quantity, const QByteArray& clientOrderId, qint64 timestamp);
+    const QByteArray& sign();
+    void send(qint64 price, qint64 quantity, const QByteArray& clientOrderId, qint64 timestamp = -1);
+
+    //form body as posted, &signature=<hex> included after sign()
+    const QByteArray& payload() const;
+    const QByteArray& signature() const;
+
+    static int writeFixed(char* out, qint64 mantissa, int decimals);
+    static int writeInteger(char* out, qint64 value);
+
+private:
+    Q_DISABLE_COPY(binanceordertemplate)
+
+    binanceapi* api;
+    QNetworkRequest request;
+    QMessageAuthenticationCode mac;
+    QByteArray buffer;
+    QByteArray signatureHex;
+    QString clientOrderIdText;
+    int prefixLength;
+    int priceDecimals;
+    int quantityDecimals;
+};
+
+#endif // BINANCEORDERTEMPLATE_H
@@ -0,0 +1,375 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#include "binancepanic.h"
+#include "binanceapi.h"
+#include "binanceorders.h"
+#include "binancepositions.h"
+#include "binancelogger.h"
+#include <QDateTime>
+
+// positionRisk is one request; past this the run is ended rather than left waiting.
+static const int positionsTimeoutMs = 5000;
+// Same for every cancel and close; Qt5 network replies have no timeout of their own.
+static const int requestTimeoutMs = 5000;
+
+binancepanic::binancepanic(const QString& apiKey, const QString& apiSecret, int laneCount, QObject* parent)
+    : QObject(parent), laneIndex(0), orders(nullptr), positions(nullptr), orderLimit(300), running(false),
+      awaitingPositions(false), ids(binanceclientid::panicStrategy) {
+    for (int i = 0; i < qMax(1, laneCount); ++i) {
+        binanceapi* lane = new binanceapi(apiKey, apiSecret, this);
+        lane->setObjectName(QString("panic-%1").arg(i));
+        connect(lane, &binanceapi::cancelAllOpenOrdersReceived, this, &binancepanic::handleCancelAll);
+        connect(lane, &binanceapi::cancelAllOpenOrdersFailed, this, &binancepanic::handleCancelAllFailed);
+        connect(lane, &binanceapi::newOrderResponseReceived, this, &binancepanic::handleOrderResponse);
+        connect(lane, &binanceapi::orderRequestFailed, this, &binancepanic::handleOrderFailed);
+        connect(lane, &binanceapi::positionRiskReceived, this, &binancepanic::handlePositionRisk);
+        connect(lane, &binanceapi::positionRiskFailed, this, &binancepanic::handlePositionRiskFailed);
+        lanes.append(lane);
+    }
+    drainTimer.setSingleShot(true);
+    drainTimer.setTimerType(Qt::PreciseTimer);
+    connect(&drainTimer, &QTimer::timeout, this, &binancepanic::drainCloses);
+    positionsTimer.setSingleShot(true);
+    connect(&positionsTimer, &QTimer::timeout, this, &binancepanic::positionsTimedOut);
+    requestTimer.setSingleShot(true);
+    connect(&requestTimer, &QTimer::timeout, this, &binancepanic::requestsTimedOut);
+}
+
+void binancepanic::setOrders(binanceorders* orders) {
+    this->orders = orders;
+}
+
+void binancepanic::setPositions(binancepositions* positions) {
+    this->positions = positions;
+}
+
+void binancepanic::setMetrics(binancemetrics* metrics) {
+    for (binanceapi* lane : qAsConst(lanes)) {
+        lane->setMetrics(metrics);
+    }
+}
+
+void binancepanic::setTracer(binancetracer* tracer) {
+    for (binanceapi* lane : qAsConst(lanes)) {
+        lane->setTracer(tracer);
+    }
+}
+
+void binancepanic::setLogger(binancelogger* logger) {
+    for (binanceapi* lane : qAsConst(lanes)) {
+        lane->setLogger(logger);
+    }
+}
+
+void binancepanic::setOrderRateLimit(int ordersPer10s) {
+    orderLimit = qMax(1, ordersPer10s);
+}
+
+bool binancepanic::isRunning() const {
+    return running;
+}
+
+QHash<QString, binancepanic::SymbolState> binancepanic::progress() const {
+    return states;
+}
+
+void binancepanic::flatten() {
+    if (running) {
+        lanes.first()->logMessage(binancelogger::Warning, "Panic: flatten again, resending for symbols not flat yet");
+        for (auto it = states.constBegin(); it != states.constEnd(); ++it) {
+            if (it.value().doneUs < 0 && !it.value().cancelDone) {
+                sendCancel(it.key());
+            }
+        }
+        // Closes are reduce-only or by position side, so a repeated one cannot flip a position.
+        if (positions) {
+            for (const binancepositions::Position& position : positions->openPositions()) {
+                closePosition(position.symbol, position.quantity, position.positionSide);
+            }
+        } else if (!awaitingPositions) {
+            states.remove("*");
+            awaitingPositions = true;
+            positionsTimer.start(positionsTimeoutMs);
+            nextLane()->getPositionRisk(QString(), -1, QDateTime::currentMSecsSinceEpoch());
+        }
+        drainCloses();
+        checkDone();
+        return;
+    }
+    running = true;
+    clock.start();
+    states.clear();
+    closeSymbols.clear();
+    cancelDeadlines.clear();
+    closeDeadlines.clear();
+    queued.clear();
+    lanes.first()->logMessage(binancelogger::Warning, "Panic: flattening all symbols");
+
+    if (orders) {
+        for (const QString& symbol : orders->symbolsWithOpenOrders()) {
+            cancelSymbol(symbol);
+        }
+    }
+    if (positions) {
+        for (const binancepositions::Position& position : positions->openPositions()) {
+            closePosition(position.symbol, position.quantity, position.positionSide);
+        }
+        awaitingPositions = false;
+    } else {
+        awaitingPositions = true;
+        positionsTimer.start(positionsTimeoutMs);
+        nextLane()->getPositionRisk(QString(), -1, QDateTime::currentMSecsSinceEpoch());
+    }
+    drainCloses();
+    checkDone();
+}
+
+binanceapi* binancepanic::nextLane() {
+    binanceapi* lane = lanes.at(laneIndex);
+    laneIndex = (laneIndex + 1) % lanes.size();
+    return lane;
+}
+
+void binancepanic::cancelSymbol(const QString& symbol) {
+    if (states.contains(symbol)) {
+        return;
+    }
+    states.insert(symbol, SymbolState());
+    sendCancel(symbol);
+}
+
+void binancepanic::sendCancel(const QString& symbol) {
+    cancelDeadlines.insert(symbol, clock.elapsed() + requestTimeoutMs);
+    startRequestTimer();
+    nextLane()->cancelAllOpenOrders(symbol, -1, QDateTime::currentMSecsSinceEpoch());
+}
+
+void binancepanic::closePosition(const QString& symbol, double quantity, const QString& positionSide) {
+    // A symbol already settled in this run is not reopened by a later position snapshot.
+    auto it = states.constFind(symbol);
+    if (it != states.constEnd() && it.value().doneUs >= 0) {
+        return;
+    }
+    cancelSymbol(symbol);
+    queueClose(symbol, quantity, positionSide);
+}
+
+void binancepanic::startRequestTimer() {
+    // Deadlines are all send time plus requestTimeoutMs, so a running timer is already due first.
+    if (!requestTimer.isActive()) {
+        requestTimer.start(requestTimeoutMs);
+    }
+}
+
+void binancepanic::requestsTimedOut() {
+    qint64 now = clock.elapsed();
+    QStringList cancels;
+    for (auto it = cancelDeadlines.constBegin(); it != cancelDeadlines.constEnd(); ++it) {
+        if (it.value() <= now) {
+            cancels.append(it.key());
+        }
+    }
+    QStringList closes;
+    for (auto it = closeDeadlines.constBegin(); it != closeDeadlines.constEnd(); ++it) {
+        if (it.value() <= now) {
+            closes.append(it.key());
+        }
+    }
+    for (const QString& symbol : cancels) {
+        handleCancelAllFailed(symbol, -1007, "Timeout waiting for response");
+    }
+    for (const QString& clientOrderId : closes) {
+        handleOrderFailed(clientOrderId, -1007, "Timeout waiting for response");
+    }
+
+    qint64 next = -1;
+    for (qint64 deadline : qAsConst(cancelDeadlines)) {
+        next = next < 0 ? deadline : qMin(next, deadline);
+    }
+    for (qint64 deadline : qAsConst(closeDeadlines)) {
+        next = next < 0 ? deadline : qMin(next, deadline);
+    }
+    if (next >= 0) {
+        requestTimer.start(int(qMax<qint64>(0, next - now)));
+    }
+}
+
+void binancepanic::queueClose(const QString& symbol, double quantity, const QString& positionSide) {
+    if (quantity == 0.0) {
+        return;
+    }
+    Close close;
+    close.symbol = symbol;
+    close.side = quantity > 0.0 ? "SELL" : "BUY";
+    close.positionSide = positionSide == "BOTH" ? QString() : positionSide;
+    close.quantity = formatQuantity(qAbs(quantity));
+    queued.enqueue(close);
+    ++states[symbol].closesPending;
+}
+
+void binancepanic::drainCloses() {
+    qint64 now = clock.elapsed();
+    while (!sentMs.isEmpty() && now - sentMs.head() >= 10000) {
+        sentMs.dequeue();
+    }
+    while (!queued.isEmpty() && sentMs.size() < orderLimit) {
+        Close close = queued.dequeue();
+        QString clientOrderId = QString::fromLatin1(ids.next());
+        closeSymbols.insert(clientOrderId, close.symbol);
+        closeDeadlines.insert(clientOrderId, now + requestTimeoutMs);
+        startRequestTimer();
+        // Hedge mode closes by position side, one-way mode by reduceOnly.
+        QString reduceOnly = close.positionSide.isEmpty() ? QString("true") : QString();
+        nextLane()->sendNewOrder(close.symbol, close.side, close.positionSide, "MARKET", QString(), close.quantity,
+                                 reduceOnly, QString(), clientOrderId, QString(), QString(), QString(), QString(),
+                                 QString(), QString(), "ACK", -1, QDateTime::currentMSecsSinceEpoch());
+        sentMs.enqueue(now);
+    }
+    if (!queued.isEmpty()) {
+        lanes.first()->logMessage(binancelogger::Warning, "Panic: order limit reached, closes waiting:", queued.size());
+        drainTimer.start(int(10000 - (now - sentMs.head()) + 1));
+    }
+}
+
+void binancepanic::handleCancelAll(const QString& symbol, const QJsonObject& result) {
+    Q_UNUSED(result);
+    cancelDeadlines.remove(symbol);
+    auto it = states.find(symbol);
+    if (it == states.end() || it.value().cancelDone) {
+        return;
+    }
+    it.value().cancelDone = true;
+    checkSymbol(symbol);
+}
+
+void binancepanic::handleCancelAllFailed(const QString& symbol, int code, const QString& message) {
+    cancelDeadlines.remove(symbol);
+    auto it = states.find(symbol);
+    if (it == states.end() || it.value().cancelDone) {
+        return;
+    }
+    it.value().cancelDone = true;
+    it.value().failed = true;
+    it.value().error = QString("cancel %1 %2").arg(code).arg(message);
+    checkSymbol(symbol);
+}
+
+void binancepanic::handleOrderResponse(const QJsonObject& result) {
+    QString clientOrderId = result.value("clientOrderId").toString();
+    closeDeadlines.remove(clientOrderId);
+    QString symbol = closeSymbols.take(clientOrderId);
+    if (!symbol.isEmpty()) {
+        closeFinished(symbol, true, QString());
+    }
+}
+
+void binancepanic::handleOrderFailed(const QString& clientOrderId, int code, const QString& message) {
+    closeDeadlines.remove(clientOrderId);
+    QString symbol = closeSymbols.take(clientOrderId);
+    if (symbol.isEmpty()) {
+        return;
+    }
+    // -2022: reduce only rejected, the position is already gone.
+    closeFinished(symbol, code == -2022, QString("close %1 %2").arg(code).arg(message));
+}
+
+void binancepanic::closeFinished(const QString& symbol, bool ok, const QString& error) {
+    SymbolState& state = states[symbol];
+    --state.closesPending;
+    if (!ok) {
+        state.failed = true;
+        state.error = error;
+    }
+    checkSymbol(symbol);
+}
+
+void binancepanic::handlePositionRisk(const QJsonArray& entries) {
+    if (!running || !awaitingPositions) {
+        return;
+    }
+    awaitingPositions = false;
+    positionsTimer.stop();
+    for (const QJsonValue& value : entries) {
+        QJsonObject entry = value.toObject();
+        double quantity = entry.value("positionAmt").toString().toDouble();
+        if (quantity == 0.0) {
+            continue;
+        }
+        closePosition(entry.value("symbol").toString(), quantity, entry.value("positionSide").toString());
+    }
+    drainCloses();
+    checkDone();
+}
+
+void binancepanic::handlePositionRiskFailed(int code, const QString& message) {
+    positionsFailed(QString("positionRisk %1 %2").arg(code).arg(message));
+}
+
+void binancepanic::positionsTimedOut() {
+    positionsFailed(QString("positionRisk timed out after %1 ms").arg(positionsTimeoutMs));
+}
+
+void binancepanic::positionsFailed(const QString& error) {
+    if (!running || !awaitingPositions) {
+        return;
+    }
+    awaitingPositions = false;
+    positionsTimer.stop();
+    lanes.first()->logMessage(binancelogger::Error, "Panic:", 0, error);
+    // Positions are unknown, so the run cannot claim flat; "*" stands for all of them.
+    SymbolState state;
+    state.cancelDone = true;
+    state.failed = true;
+    state.error = error;
+    state.doneUs = clock.nsecsElapsed() / 1000;
+    states.insert("*", state);
+    checkDone();
+}
+
+void binancepanic::checkSymbol(const QString& symbol) {
+    SymbolState& state = states[symbol];
+    if (!state.cancelDone || state.closesPending > 0 || state.doneUs >= 0) {
+        return;
+    }
+    state.doneUs = clock.nsecsElapsed() / 1000;
+    emit symbolFlat(symbol, state.doneUs, !state.failed);
+    checkDone();
+}
+
+void binancepanic::checkDone() {
+    if (!running || awaitingPositions) {
+        return;
+    }
+    QStringList failed;
+    for (auto it = states.constBegin(); it != states.constEnd(); ++it) {
+        if (it.value().doneUs < 0) {
+            return;
+        }
+        if (it.value().failed) {
+            failed.append(it.key());
+        }
+    }
+    running = false;
+    requestTimer.stop();
+    cancelDeadlines.clear();
+    closeDeadlines.clear();
+    qint64 elapsedUs = clock.nsecsElapsed() / 1000;
+    lanes.first()->logMessage(binancelogger::Info, "Panic: flat after us:", elapsedUs,
+                              QString("%1 symbols, %2 failed").arg(states.size()).arg(failed.size()));
+    emit flattened(elapsedUs, failed);
+}
+
+QString binancepanic::formatQuantity(double quantity) {
+    QString text = QString::number(quantity, 'f', 8);
+    while (text.endsWith('0')) {
+        text.chop(1);
+    }
+    if (text.endsWith('.')) {
+        text.chop(1);
+    }
+    return text;
+}
@@ -0,0 +1,119 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#ifndef BINANCEPANIC_H
+#define BINANCEPANIC_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QQueue>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QJsonArray>
+#include "binanceclientid.h"
+
+class binanceapi;
+class binanceorders;
+class binancepositions;
+class binancemetrics;
+class binancetracer;
+class binancelogger;
+
+// Kill switch. flatten() cancels every open order and closes every position
+// with reduce-only market orders on all symbols at once. Requests are spread
+// over several binanceapi lanes, each with its own network manager and
+// connection pool, so they are not serialized behind one another. Market
+// closes stay within the per 10s order limit. Progress is tracked per symbol
+// and the total time to flat is reported. A cancel or close without an answer
+// within the request timeout fails its symbol, so a stalled reply cannot keep
+// a run open.
+class binancepanic : public QObject {
+    Q_OBJECT
+public:
+    struct SymbolState {
+        bool cancelDone = false;
+        int closesPending = 0;
+        bool failed = false;
+        QString error;
+        qint64 doneUs = -1;
+    };
+
+    binancepanic(const QString& apiKey, const QString& apiSecret, int laneCount = 4, QObject* parent = nullptr);
+
+    void setOrders(binanceorders* orders);
+    //without positions they are fetched from positionRisk first
+    void setPositions(binancepositions* positions);
+    void setOrderRateLimit(int ordersPer10s);
+    //lanes are labelled panic-<n>
+    void setMetrics(binancemetrics* metrics);
+    void setTracer(binancetracer* tracer);
+    //lanes log through it, the run's progress goes to the first lane
+    void setLogger(binancelogger* logger);
+
+    //failedSymbols holds "*" when positionRisk failed or timed out and no position could be closed;
+    //called during a run, it resends the cancels and closes of symbols that are not flat yet
+    void flatten();
+    bool isRunning() const;
+    QHash<QString, SymbolState> progress() const;
+
+signals:
+    void symbolFlat(const QString& symbol, qint64 elapsedUs, bool ok);
+    void flattened(qint64 elapsedUs, const QStringList& failedSymbols);
+
+private slots:
+    void handleCancelAll(const QString& symbol, const QJsonObject& result);
+    void handleCancelAllFailed(const QString& symbol, int code, const QString& message);
+    void handleOrderResponse(const QJsonObject& result);
+    void handleOrderFailed(const QString& clientOrderId, int code, const QString& message);
+    void handlePositionRisk(const QJsonArray& positions);
+    void handlePositionRiskFailed(int code, const QString& message);
+    void positionsTimedOut();
+    void requestsTimedOut();
+    void drainCloses();
+
+private:
+    struct Close {
+        QString symbol;
+        QString side;
+        QString positionSide;
+        QString quantity;
+    };
+
+    binanceapi* nextLane();
+    void cancelSymbol(const QString& symbol);
+    void sendCancel(const QString& symbol);
+    void closePosition(const QString& symbol, double quantity, const QString& positionSide);
+    void startRequestTimer();
+    void queueClose(const QString& symbol, double quantity, const QString& positionSide);
+    void closeFinished(const QString& symbol, bool ok, const QString& error);
+    void checkSymbol(const QString& symbol);
+    void checkDone();
+    void positionsFailed(const QString& error);
+    static QString formatQuantity(double quantity);
+
+    QVector<binanceapi*> lanes;
+    int laneIndex;
+    binanceorders* orders;
+    binancepositions* positions;
+    int orderLimit;
+    bool running;
+    bool awaitingPositions;
+    QElapsedTimer clock;
+    QHash<QString, SymbolState> states;
+    QHash<QString, QString> closeSymbols;
+    QHash<QString, qint64> cancelDeadlines;
+    QHash<QString, qint64> closeDeadlines;
+    QQueue<Close> queued;
+    QQueue<qint64> sentMs;
+    QTimer drainTimer;
+    QTimer positionsTimer;
+    QTimer requestTimer;
+    binanceclientid ids;
+};
+
+#endif // BINANCEPANIC_H
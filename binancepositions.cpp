@@ -0,0 +1,304 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#include "binancepositions.h"
+#include "binanceapi.h"
+#include "binanceorders.h"
+#include "binancemarkprices.h"
+#include "binancevalidator.h"
+#include "binancelogger.h"
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QSet>
+
+binancepositions::binancepositions(binanceapi* api, binanceorders* orders, binancemarkprices* markPrices, QObject* parent)
+    : QObject(parent), api(api), orders(orders), markPrices(markPrices), validator(nullptr), marginAsset("USDT"),
+      wallet(0.0), crossWallet(0.0), crossMaintenance(0.0), crossUnrealized(0.0) {
+    reconcileTimer.setInterval(5 * 60 * 1000);
+    connect(&reconcileTimer, &QTimer::timeout, this, &binancepositions::reconcile);
+    connect(orders, &binanceorders::orderFilled, this, &binancepositions::handleFill);
+    connect(markPrices, &binancemarkprices::updated, this, &binancepositions::handleMarkPrices);
+    connect(api, &binanceapi::userStreamEventReceived, this, &binancepositions::handleUserStreamEvent);
+    connect(api, &binanceapi::positionRiskReceived, this, &binancepositions::handlePositionRisk);
+    connect(api, &binanceapi::accountInformationReceived, this, &binancepositions::handleAccountInformation);
+    // Events may have been missed while the stream was down.
+    connect(api, &binanceapi::userStreamConnected, this, &binancepositions::reconcile);
+}
+
+void binancepositions::setValidator(binancevalidator* validator) {
+    this->validator = validator;
+}
+
+void binancepositions::setMarginAsset(const QString& asset) {
+    marginAsset = asset;
+}
+
+void binancepositions::setReconcileInterval(int msec) {
+    reconcileTimer.setInterval(msec);
+}
+
+void binancepositions::start() {
+    reconcile();
+    reconcileTimer.start();
+}
+
+void binancepositions::reconcile() {
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    api->getPositionRisk(QString(), -1, now);
+    api->getAccountInformation(-1, now);
+}
+
+bool binancepositions::get(const QString& symbol, Position* position, const QString& positionSide) const {
+    auto it = index.constFind(symbol + '|' + positionSide);
+    if (it == index.constEnd()) {
+        return false;
+    }
+    *position = table.at(it.value());
+    return true;
+}
+
+QVector<binancepositions::Position> binancepositions::openPositions() const {
+    QVector<Position> open;
+    for (const Position& position : table) {
+        if (position.quantity != 0.0) {
+            open.append(position);
+        }
+    }
+    return open;
+}
+
+double binancepositions::walletBalance() const {
+    return wallet;
+}
+
+double binancepositions::crossMarginRatio() const {
+    double marginBalance = crossWallet + crossUnrealized;
+    return marginBalance > 0.0 ? crossMaintenance / marginBalance : 0.0;
+}
+
+int binancepositions::slotFor(const QString& symbol, const QString& positionSide) {
+    const QString key = symbol + '|' + positionSide;
+    auto it = index.constFind(key);
+    if (it != index.constEnd()) {
+        return it.value();
+    }
+    int slot = table.size();
+    Position position;
+    position.symbol = symbol;
+    position.positionSide = positionSide;
+    table.append(position);
+    index.insert(key, slot);
+    return slot;
+}
+
+double binancepositions::maintenanceRate(const QString& symbol, double notional, double* maintAmount) const {
+    *maintAmount = 0.0;
+    const binancevalidator::Rules* rules = validator ? validator->rules(symbol) : nullptr;
+    if (!rules || rules->brackets.isEmpty()) {
+        return 0.0;
+    }
+    for (const binancevalidator::Bracket& bracket : rules->brackets) {
+        if (notional <= bracket.notionalCap) {
+            *maintAmount = bracket.maintAmount;
+            return bracket.maintMarginRatio;
+        }
+    }
+    *maintAmount = rules->brackets.last().maintAmount;
+    return rules->brackets.last().maintMarginRatio;
+}
+
+void binancepositions::reprice(Position& position) const {
+    double mark = markPrices->markPrice(position.symbol);
+    if (mark > 0.0) {
+        position.markPrice = mark;
+    } else if (position.markPrice <= 0.0) {
+        position.markPrice = position.entryPrice;
+    }
+    double size = qAbs(position.quantity);
+    double notional = size * position.markPrice;
+    double maintAmount = 0.0;
+    double rate = maintenanceRate(position.symbol, notional, &maintAmount);
+    position.unrealizedPnl = position.quantity * (position.markPrice - position.entryPrice);
+    position.maintenanceMargin = size > 0.0 ? qMax(0.0, notional * rate - maintAmount) : 0.0;
+}
+
+void binancepositions::repriceAll() {
+    crossMaintenance = 0.0;
+    crossUnrealized = 0.0;
+    for (Position& position : table) {
+        reprice(position);
+        if (!position.isolated) {
+            crossMaintenance += position.maintenanceMargin;
+            crossUnrealized += position.unrealizedPnl;
+        }
+    }
+
+    // Liquidation estimate from the exchange's formula:
+    // (WB - TMM1 + UPNL1 + cum - side * size * entry) / (size * MMR - side * size)
+    // where TMM1/UPNL1 are the other cross positions, zero for isolated.
+    for (Position& position : table) {
+        if (position.quantity == 0.0) {
+            position.liquidationPrice = 0.0;
+            position.marginRatio = 0.0;
+            continue;
+        }
+        double side = position.quantity > 0.0 ? 1.0 : -1.0;
+        double size = qAbs(position.quantity);
+        double maintAmount = 0.0;
+        double rate = maintenanceRate(position.symbol, size * position.markPrice, &maintAmount);
+        double balance;
+        if (position.isolated) {
+            balance = position.isolatedWallet;
+            double marginBalance = position.isolatedWallet + position.unrealizedPnl;
+            position.marginRatio = marginBalance > 0.0 ? position.maintenanceMargin / marginBalance : 0.0;
+        } else {
+            balance = crossWallet - (crossMaintenance - position.maintenanceMargin)
+                      + (crossUnrealized - position.unrealizedPnl);
+            position.marginRatio = crossMarginRatio();
+        }
+        double denominator = size * rate - side * size;
+        double price = denominator != 0.0 ? (balance + maintAmount - side * size * position.entryPrice) / denominator : 0.0;
+        position.liquidationPrice = qMax(0.0, price);
+    }
+}
+
+void binancepositions::handleFill(int slot, int fill) {
+    const binanceorders::Order* order = orders->order(slot);
+    const binanceorders::Fill* trade = orders->fill(fill);
+    if (!order || !trade) {
+        return;
+    }
+    QString positionSide = order->positionSide.isEmpty() ? QString("BOTH") : order->positionSide;
+    Position& position = table[slotFor(order->symbol, positionSide)];
+    // An ACCOUNT_UPDATE for this trade already arrived and carried the new position.
+    if (trade->time <= position.updateTime) {
+        return;
+    }
+
+    double delta = order->side == "BUY" ? trade->quantity : -trade->quantity;
+    double held = position.quantity;
+    if (held == 0.0 || (held > 0.0) == (delta > 0.0)) {
+        position.entryPrice = (position.entryPrice * qAbs(held) + trade->price * qAbs(delta)) / (qAbs(held) + qAbs(delta));
+    } else {
+        double closed = qMin(qAbs(delta), qAbs(held));
+        position.realizedPnl += (trade->price - position.entryPrice) * closed * (held > 0.0 ? 1.0 : -1.0);
+        if (qAbs(delta) > qAbs(held)) {
+            position.entryPrice = trade->price;
+        }
+    }
+    position.quantity = held + delta;
+    if (qAbs(position.quantity) < 1e-12) {
+        position.quantity = 0.0;
+        position.entryPrice = 0.0;
+    }
+
+    repriceAll();
+    emit positionChanged(order->symbol, positionSide);
+    emit riskUpdated();
+}
+
+void binancepositions::handleUserStreamEvent(const QJsonObject& event) {
+    if (event.value("e").toString() != "ACCOUNT_UPDATE") {
+        return;
+    }
+    qint64 time = event.value("T").toVariant().toLongLong();
+    QJsonObject update = event.value("a").toObject();
+
+    for (const QJsonValue& value : update.value("B").toArray()) {
+        QJsonObject balance = value.toObject();
+        if (balance.value("a").toString() == marginAsset) {
+            wallet = balance.value("wb").toString().toDouble();
+            crossWallet = balance.value("cw").toString().toDouble();
+        }
+    }
+
+    QVector<int> changed;
+    for (const QJsonValue& value : update.value("P").toArray()) {
+        QJsonObject entry = value.toObject();
+        int slot = slotFor(entry.value("s").toString(), entry.value("ps").toString());
+        Position& position = table[slot];
+        position.quantity = entry.value("pa").toString().toDouble();
+        position.entryPrice = entry.value("ep").toString().toDouble();
+        position.breakEvenPrice = entry.value("bep").toString().toDouble();
+        position.realizedPnl = entry.value("cr").toString().toDouble();
+        position.isolated = entry.value("mt").toString() == "isolated";
+        position.isolatedWallet = entry.value("iw").toString().toDouble();
+        position.updateTime = time;
+        changed.append(slot);
+    }
+
+    repriceAll();
+    for (int slot : changed) {
+        emit positionChanged(table.at(slot).symbol, table.at(slot).positionSide);
+    }
+    emit riskUpdated();
+}
+
+void binancepositions::handlePositionRisk(const QJsonArray& positions, const QString& symbol) {
+    QSet<int> seen;
+    for (const QJsonValue& value : positions) {
+        QJsonObject entry = value.toObject();
+        int slot = slotFor(entry.value("symbol").toString(), entry.value("positionSide").toString());
+        Position& position = table[slot];
+        qint64 updateTime = entry.value("updateTime").toVariant().toLongLong();
+        seen.insert(slot);
+        // A stream update newer than this snapshot wins.
+        if (updateTime < position.updateTime) {
+            continue;
+        }
+        position.quantity = entry.value("positionAmt").toString().toDouble();
+        position.entryPrice = entry.value("entryPrice").toString().toDouble();
+        position.breakEvenPrice = entry.value("breakEvenPrice").toString().toDouble();
+        position.isolated = entry.value("marginType").toString() == "isolated";
+        position.isolatedWallet = entry.value("isolatedWallet").toString().toDouble();
+        position.markPrice = entry.value("markPrice").toString().toDouble();
+        position.updateTime = updateTime;
+    }
+
+    // Only a full (no symbol) query tells us a position we still hold is gone.
+    if (symbol.isEmpty()) {
+        for (int slot = 0; slot < table.size(); ++slot) {
+            if (!seen.contains(slot) && table.at(slot).quantity != 0.0) {
+                api->logMessage(binancelogger::Warning, "Position closed while unobserved:", 0,
+                                table.at(slot).symbol + ' ' + table.at(slot).positionSide);
+                table[slot].quantity = 0.0;
+                table[slot].entryPrice = 0.0;
+            }
+        }
+    }
+
+    repriceAll();
+    emit reconciled();
+    emit riskUpdated();
+}
+
+void binancepositions::handleAccountInformation(const QByteArray& data) {
+    QJsonObject account = QJsonDocument::fromJson(data).object();
+    for (const QJsonValue& value : account.value("assets").toArray()) {
+        QJsonObject asset = value.toObject();
+        if (asset.value("asset").toString() == marginAsset) {
+            wallet = asset.value("walletBalance").toString().toDouble();
+            crossWallet = asset.value("crossWalletBalance").toString().toDouble();
+        }
+    }
+    repriceAll();
+    emit riskUpdated();
+}
+
+void binancepositions::handleMarkPrices() {
+    bool open = false;
+    for (const Position& position : table) {
+        if (position.quantity != 0.0) {
+            open = true;
+            break;
+        }
+    }
+    if (!open) {
+        return;
+    }
+    repriceAll();
+    emit riskUpdated();
+}
@@ -0,0 +1,95 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#ifndef BINANCEPOSITIONS_H
+#define BINANCEPOSITIONS_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QTimer>
+#include <QJsonObject>
+#include <QJsonArray>
+
+class binanceapi;
+class binanceorders;
+class binancemarkprices;
+class binancevalidator;
+
+// Positions and PnL kept locally. Fills from the order manager move a
+// position as they happen, ACCOUNT_UPDATE events overwrite it with the
+// exchange's figures, and every mark price tick reprices the open ones
+// (unrealized PnL, maintenance margin, liquidation estimate, margin ratio).
+// positionRisk/account are only polled to reconcile.
+class binancepositions : public QObject {
+    Q_OBJECT
+public:
+    struct Position {
+        QString symbol;
+        QString positionSide;
+        double quantity = 0.0;
+        double entryPrice = 0.0;
+        double breakEvenPrice = 0.0;
+        //before commission, the same figure as ACCOUNT_UPDATE's cr
+        double realizedPnl = 0.0;
+        bool isolated = false;
+        double isolatedWallet = 0.0;
+        double markPrice = 0.0;
+        double unrealizedPnl = 0.0;
+        double maintenanceMargin = 0.0;
+        double liquidationPrice = 0.0;
+        double marginRatio = 0.0;
+        qint64 updateTime = 0;
+    };
+
+    explicit binancepositions(binanceapi* api, binanceorders* orders, binancemarkprices* markPrices,
+                              QObject* parent = nullptr);
+
+    //maintenance brackets for the liquidation estimate
+    void setValidator(binancevalidator* validator);
+    void setMarginAsset(const QString& asset);
+    void setReconcileInterval(int msec);
+    void start();
+    void reconcile();
+
+    bool get(const QString& symbol, Position* position, const QString& positionSide = "BOTH") const;
+    QVector<Position> openPositions() const;
+    double walletBalance() const;
+    double crossMarginRatio() const;
+
+signals:
+    void positionChanged(const QString& symbol, const QString& positionSide);
+    void riskUpdated();
+    void reconciled();
+
+private slots:
+    void handleFill(int slot, int fill);
+    void handleUserStreamEvent(const QJsonObject& event);
+    void handlePositionRisk(const QJsonArray& positions, const QString& symbol);
+    void handleAccountInformation(const QByteArray& data);
+    void handleMarkPrices();
+
+private:
+    int slotFor(const QString& symbol, const QString& positionSide);
+    void reprice(Position& position) const;
+    void repriceAll();
+    double maintenanceRate(const QString& symbol, double notional, double* maintAmount) const;
+
+    binanceapi* api;
+    binanceorders* orders;
+    binancemarkprices* markPrices;
+    binancevalidator* validator;
+    QString marginAsset;
+    QTimer reconcileTimer;
+    QHash<QString, int> index;
+    QVector<Position> table;
+    double wallet;
+    double crossWallet;
+    double crossMaintenance;
+    double crossUnrealized;
+};
+
+#endif // BINANCEPOSITIONS_H
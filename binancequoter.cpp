@@ -0,0 +1,176 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#include "binancequoter.h"
+#include "binanceorders.h"
+#include <algorithm>
+
+binancequoter::binancequoter(binanceorders* orders, QObject* parent)
+    : QObject(parent), orders(orders), timeInForce("GTC") {
+    connect(orders, &binanceorders::orderUpdated, this, &binancequoter::handleOrderUpdated);
+}
+
+void binancequoter::setTimeInForce(const QString& timeInForce) {
+    this->timeInForce = timeInForce;
+}
+
+void binancequoter::setPositionSide(const QString& positionSide) {
+    this->positionSide = positionSide;
+}
+
+void binancequoter::setQuotes(const QString& symbol, const QVector<Quote>& quotes) {
+    desired.insert(symbol, quotes);
+    apply(symbol);
+}
+
+void binancequoter::clearQuotes(const QString& symbol) {
+    setQuotes(symbol, QVector<Quote>());
+}
+
+binancequoter::Stats binancequoter::stats(const QString& symbol) const {
+    return counters.value(symbol);
+}
+
+bool binancequoter::busy(const QString& symbol) const {
+    const QSet<int> slots = owned.value(symbol);
+    for (int slot : slots) {
+        const binanceorders::Order* entry = orders->order(slot);
+        if (entry && (entry->status == binanceorders::PendingNew || entry->pendingAmend || entry->pendingCancel)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void binancequoter::apply(const QString& symbol) {
+    Stats& stat = counters[symbol];
+    if (busy(symbol)) {
+        deferred.insert(symbol);
+        ++stat.deferred;
+        return;
+    }
+    deferred.remove(symbol);
+
+    const QVector<Quote> wanted = desired.value(symbol);
+    QVector<binanceorders::Amend> amends;
+    QVector<int> cancels;
+    QVector<Quote> placements;
+
+    for (const QString side : {QStringLiteral("BUY"), QStringLiteral("SELL")}) {
+        QVector<int> live;
+        const QSet<int> slots = owned.value(symbol);
+        for (int slot : slots) {
+            const binanceorders::Order* entry = orders->order(slot);
+            if (entry && entry->side == side && binanceorders::isOpen(entry->status)) {
+                live.append(slot);
+            }
+        }
+        QVector<Quote> todo;
+        for (const Quote& quote : wanted) {
+            if (quote.side.compare(side, Qt::CaseInsensitive) == 0) {
+                todo.append(quote);
+            }
+        }
+
+        // Orders already resting at the wanted price and size stay untouched.
+        for (int i = todo.size() - 1; i >= 0; --i) {
+            double price = todo.at(i).price.toDouble();
+            double quantity = todo.at(i).quantity.toDouble();
+            for (int j = 0; j < live.size(); ++j) {
+                const binanceorders::Order* entry = orders->order(live.at(j));
+                if (samePrice(entry->price, price) && samePrice(entry->origQty - entry->executedQty, quantity)) {
+                    live.remove(j);
+                    todo.remove(i);
+                    ++stat.kept;
+                    break;
+                }
+            }
+        }
+
+        // Pair what is left best price to best price so each amend moves the least.
+        bool buy = side == "BUY";
+        std::sort(live.begin(), live.end(), [this, buy](int a, int b) {
+            double pa = orders->order(a)->price;
+            double pb = orders->order(b)->price;
+            return buy ? pa > pb : pa < pb;
+        });
+        std::sort(todo.begin(), todo.end(), [buy](const Quote& a, const Quote& b) {
+            double pa = a.price.toDouble();
+            double pb = b.price.toDouble();
+            return buy ? pa > pb : pa < pb;
+        });
+
+        int paired = qMin(live.size(), todo.size());
+        for (int i = 0; i < paired; ++i) {
+            const binanceorders::Order* entry = orders->order(live.at(i));
+            const Quote& quote = todo.at(i);
+            // modifyOrder takes the total quantity, the quote is what should still rest.
+            binanceorders::Amend amend;
+            amend.slot = live.at(i);
+            amend.price = quote.price;
+            amend.quantity = formatQuantity(entry->executedQty + quote.quantity.toDouble(), quote.quantity);
+            amends.append(amend);
+        }
+        for (int i = paired; i < live.size(); ++i) {
+            cancels.append(live.at(i));
+        }
+        for (int i = paired; i < todo.size(); ++i) {
+            placements.append(todo.at(i));
+        }
+    }
+
+    int amended = orders->submitAmends(amends);
+    int cancelled = 0;
+    for (int slot : cancels) {
+        if (orders->submitCancel(slot)) {
+            ++cancelled;
+        }
+    }
+    for (const Quote& quote : placements) {
+        int slot = orders->submitNew(symbol, quote.side.toUpper(), "LIMIT", timeInForce, quote.price, quote.quantity,
+                                     QString(), positionSide);
+        // A synchronous rejection was reported before the slot was ours; never own it.
+        const binanceorders::Order* entry = orders->order(slot);
+        if (entry && binanceorders::isOpen(entry->status)) {
+            owned[symbol].insert(slot);
+            ownerOf.insert(slot, symbol);
+        }
+    }
+
+    Stats& after = counters[symbol];
+    after.amended += amended;
+    after.placed += placements.size();
+    after.cancelled += cancelled;
+    if (amended || cancelled || !placements.isEmpty()) {
+        emit requoted(symbol, amended, placements.size(), cancelled);
+    }
+}
+
+void binancequoter::handleOrderUpdated(int slot) {
+    auto it = ownerOf.constFind(slot);
+    if (it == ownerOf.constEnd()) {
+        return;
+    }
+    const QString symbol = it.value();
+    const binanceorders::Order* entry = orders->order(slot);
+    if (!entry || !binanceorders::isOpen(entry->status)) {
+        owned[symbol].remove(slot);
+        ownerOf.remove(slot);
+    }
+    if (deferred.contains(symbol) && !busy(symbol)) {
+        apply(symbol);
+    }
+}
+
+bool binancequoter::samePrice(double a, double b) {
+    return qAbs(a - b) <= 1e-9 * qMax(1.0, qMax(qAbs(a), qAbs(b)));
+}
+
+QString binancequoter::formatQuantity(double quantity, const QString& like) {
+    int dot = like.indexOf('.');
+    int decimals = dot < 0 ? 0 : like.size() - dot - 1;
+    return QString::number(quantity, 'f', decimals);
+}
@@ -0,0 +1,70 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#ifndef BINANCEQUOTER_H
+#define BINANCEQUOTER_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+
+class binanceorders;
+
+// Keeps a set of resting limit orders in line with the quotes a strategy
+// wants. Every setQuotes call is diffed against the live orders this quoter
+// owns: matching orders are left alone, the rest are moved in place with
+// modifyOrder (batched five at a time) and only the surplus is placed or
+// cancelled. While an amend, cancel or placement is still in flight the
+// symbol is not touched; the latest quotes are applied once it settles.
+class binancequoter : public QObject {
+    Q_OBJECT
+public:
+    struct Quote {
+        QString side;
+        QString price;
+        QString quantity;
+    };
+
+    struct Stats {
+        int kept = 0;
+        int amended = 0;
+        int placed = 0;
+        int cancelled = 0;
+        int deferred = 0;
+    };
+
+    explicit binancequoter(binanceorders* orders, QObject* parent = nullptr);
+
+    void setTimeInForce(const QString& timeInForce);
+    void setPositionSide(const QString& positionSide);
+    void setQuotes(const QString& symbol, const QVector<Quote>& quotes);
+    void clearQuotes(const QString& symbol);
+    Stats stats(const QString& symbol) const;
+
+signals:
+    void requoted(const QString& symbol, int amended, int placed, int cancelled);
+
+private slots:
+    void handleOrderUpdated(int slot);
+
+private:
+    bool busy(const QString& symbol) const;
+    void apply(const QString& symbol);
+    static bool samePrice(double a, double b);
+    static QString formatQuantity(double quantity, const QString& like);
+
+    binanceorders* orders;
+    QString timeInForce;
+    QString positionSide;
+    QHash<QString, QVector<Quote>> desired;
+    QHash<QString, QSet<int>> owned;
+    QHash<int, QString> ownerOf;
+    QSet<QString> deferred;
+    QHash<QString, Stats> counters;
+};
+
+#endif // BINANCEQUOTER_H
@@ -0,0 +1,117 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#include "binancerecorder.h"
+#include <QMutexLocker>
+#include <chrono>
+
+static const quint32 journalMagic = 0x424e524a; // "BNRJ"
+static const quint16 journalVersion = 1;
+
+binancerecorder::binancerecorder(QObject* parent)
+    : QObject(parent) {
+}
+
+binancerecorder::~binancerecorder() {
+    close();
+}
+
+bool binancerecorder::open(const QString& fileName) {
+    QMutexLocker locker(&mutex);
+    if (file.isOpen()) {
+        file.close();
+    }
+    file.setFileName(fileName);
+    bool fresh = !file.exists() || file.size() == 0;
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qDebug() << "Could not open journal:" << fileName << file.errorString();
+        return false;
+    }
+    out.setDevice(&file);
+    out.setVersion(QDataStream::Qt_5_12);
+    if (fresh) {
+        out << journalMagic << journalVersion;
+    }
+    return true;
+}
+
+void binancerecorder::close() {
+    QMutexLocker locker(&mutex);
+    if (file.isOpen()) {
+        file.flush();
+        file.close();
+    }
+    out.setDevice(nullptr);
+}
+
+bool binancerecorder::isOpen() const {
+    return file.isOpen();
+}
+
+void binancerecorder::flush() {
+    QMutexLocker locker(&mutex);
+    if (file.isOpen()) {
+        file.flush();
+    }
+}
+
+void binancerecorder::recordReply(const char* handler, QNetworkReply* reply) {
+    Record entry;
+    entry.kind = Reply;
+    entry.receiveNs = nowNs();
+    entry.handler = handler;
+    entry.url = reply->url().toEncoded();
+    entry.httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    entry.networkError = reply->error();
+    if (reply->error()) {
+        entry.errorString = reply->errorString();
+    }
+    // peek leaves the body in place for the handler that runs right after us.
+    entry.payload = reply->peek(reply->bytesAvailable());
+    record(entry);
+}
+
+void binancerecorder::recordFrame(const char* handler, const QString& message) {
+    Record entry;
+    entry.kind = Frame;
+    entry.receiveNs = nowNs();
+    entry.handler = handler;
+    entry.payload = message.toUtf8();
+    record(entry);
+}
+
+void binancerecorder::record(const Record& record) {
+    QMutexLocker locker(&mutex);
+    if (!file.isOpen()) {
+        return;
+    }
+    out << quint8(record.kind) << record.receiveNs << record.handler << record.url
+        << record.httpStatus << record.networkError << record.errorString << record.payload;
+}
+
+qint64 binancerecorder::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+bool binancerecorder::readHeader(QDataStream& in) {
+    in.setVersion(QDataStream::Qt_5_12);
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version;
+    return in.status() == QDataStream::Ok && magic == journalMagic && version == journalVersion;
+}
+
+bool binancerecorder::readRecord(QDataStream& in, Record& record) {
+    if (in.atEnd()) {
+        return false;
+    }
+    quint8 kind = 0;
+    in >> kind >> record.receiveNs >> record.handler >> record.url
+       >> record.httpStatus >> record.networkError >> record.errorString >> record.payload;
+    record.kind = Kind(kind);
+    // A torn trailing record from a crashed writer simply ends the journal.
+    return in.status() == QDataStream::Ok;
+}
@@ -0,0 +1,64 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#ifndef BINANCERECORDER_H
+#define BINANCERECORDER_H
+
+#include <QObject>
+#include <QFile>
+#include <QDataStream>
+#include <QMutex>
+#include <QNetworkReply>
+
+// Append-only journal of everything the client received. Each record keeps
+// the handler it was delivered to, so binancereplayer can push it back
+// through the very same decode path later.
+//
+// Record layout (QDataStream, Qt_5_12):
+//   quint8 kind, qint64 receiveNs, QByteArray handler, QByteArray url,
+//   qint32 httpStatus, qint32 networkError, QString errorString, QByteArray payload
+class binancerecorder : public QObject {
+    Q_OBJECT
+public:
+    enum Kind : quint8 {
+        Reply = 1,
+        Frame = 2
+    };
+
+    struct Record {
+        Kind kind = Reply;
+        qint64 receiveNs = 0;
+        QByteArray handler;
+        QByteArray url;
+        qint32 httpStatus = 0;
+        qint32 networkError = 0;
+        QString errorString;
+        QByteArray payload;
+    };
+
+    explicit binancerecorder(QObject* parent = nullptr);
+    ~binancerecorder();
+
+    bool open(const QString& fileName);
+    void close();
+    bool isOpen() const;
+    void flush();
+
+    void recordReply(const char* handler, QNetworkReply* reply);
+    void recordFrame(const char* handler, const QString& message);
+    void record(const Record& record);
+
+    static qint64 nowNs();
+    static bool readRecord(QDataStream& in, Record& record);
+    static bool readHeader(QDataStream& in);
+
+private:
+    QFile file;
+    QDataStream out;
+    QMutex mutex;
+};
+
+#endif // BINANCERECORDER_H
@@ -0,0 +1,174 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#include "binancereplayer.h"
+#include <QCoreApplication>
+#include <QTimer>
+#include <cstring>
+
+binancereplayreply::binancereplayreply(const QUrl& url, int httpStatus, const QByteArray& body, QObject* parent,
+                                       QNetworkReply::NetworkError error, const QString& errorString)
+    : QNetworkReply(parent), body(body), offset(0) {
+    setUrl(url);
+    setOperation(QNetworkAccessManager::GetOperation);
+    if (httpStatus > 0) {
+        setAttribute(QNetworkRequest::HttpStatusCodeAttribute, httpStatus);
+    }
+    if (error != QNetworkReply::NoError) {
+        setError(error, errorString);
+    }
+    setOpenMode(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    setFinished(true);
+}
+
+void binancereplayreply::abort() {
+}
+
+bool binancereplayreply::isSequential() const {
+    return true;
+}
+
+qint64 binancereplayreply::bytesAvailable() const {
+    return body.size() - offset + QNetworkReply::bytesAvailable();
+}
+
+qint64 binancereplayreply::readData(char* data, qint64 maxSize) {
+    qint64 count = qMin(maxSize, qint64(body.size()) - offset);
+    if (count <= 0) {
+        return -1;
+    }
+    memcpy(data, body.constData() + offset, size_t(count));
+    offset += count;
+    return count;
+}
+
+binancereplayer::binancereplayer(QObject* parent)
+    : QObject(parent), pace(AsFastAsPossible), running(false), hasPending(false), firstReceiveNs(0), records(0) {
+}
+
+void binancereplayer::addTarget(QObject* target) {
+    targets.append(target);
+    routes.clear();
+}
+
+bool binancereplayer::open(const QString& fileName) {
+    if (file.isOpen()) {
+        file.close();
+    }
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "Could not open journal:" << fileName << file.errorString();
+        return false;
+    }
+    in.setDevice(&file);
+    if (!binancerecorder::readHeader(in)) {
+        qDebug() << "Not a binance journal:" << fileName;
+        file.close();
+        return false;
+    }
+    hasPending = false;
+    records = 0;
+    return true;
+}
+
+void binancereplayer::start(Pace pace) {
+    if (!file.isOpen()) {
+        return;
+    }
+    this->pace = pace;
+    running = true;
+    records = 0;
+    clock.start();
+
+    if (pace == RecordedPace) {
+        hasPending = binancerecorder::readRecord(in, pending);
+        firstReceiveNs = pending.receiveNs;
+        replayNext();
+        return;
+    }
+
+    binancerecorder::Record record;
+    while (running && binancerecorder::readRecord(in, record)) {
+        dispatch(record);
+        // Handlers deleteLater() their replies; keep those from piling up.
+        if ((records & 1023) == 0) {
+            QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+        }
+    }
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+    finish();
+}
+
+void binancereplayer::stop() {
+    running = false;
+}
+
+qint64 binancereplayer::replayedRecords() const {
+    return records;
+}
+
+qint64 binancereplayer::elapsedNs() const {
+    return clock.nsecsElapsed();
+}
+
+void binancereplayer::replayNext() {
+    while (running && hasPending) {
+        qint64 dueNs = pending.receiveNs - firstReceiveNs;
+        qint64 waitMs = (dueNs - clock.nsecsElapsed()) / 1000000;
+        if (waitMs > 0) {
+            QTimer::singleShot(int(waitMs), Qt::PreciseTimer, this, &binancereplayer::replayNext);
+            return;
+        }
+        dispatch(pending);
+        hasPending = binancerecorder::readRecord(in, pending);
+    }
+    finish();
+}
+
+void binancereplayer::finish() {
+    if (!running) {
+        return;
+    }
+    running = false;
+    emit finished(records, clock.nsecsElapsed());
+}
+
+binancereplayer::Route binancereplayer::route(const binancerecorder::Record& record) {
+    QByteArray key = record.handler + char('0' + record.kind);
+    auto it = routes.constFind(key);
+    if (it != routes.constEnd()) {
+        return it.value();
+    }
+
+    QByteArray signature = QMetaObject::normalizedSignature(
+        record.handler + (record.kind == binancerecorder::Reply ? "(QNetworkReply*)" : "(QString)"));
+    Route found;
+    for (QObject* target : qAsConst(targets)) {
+        int index = target->metaObject()->indexOfMethod(signature.constData());
+        if (index >= 0) {
+            found.target = target;
+            found.method = target->metaObject()->method(index);
+            break;
+        }
+    }
+    routes.insert(key, found);
+    return found;
+}
+
+bool binancereplayer::dispatch(const binancerecorder::Record& record) {
+    Route target = route(record);
+    if (!target.target) {
+        return false;
+    }
+    records++;
+
+    if (record.kind == binancerecorder::Reply) {
+        QNetworkReply* reply = new binancereplayreply(QUrl::fromEncoded(record.url), record.httpStatus, record.payload, this,
+                                                      QNetworkReply::NetworkError(record.networkError), record.errorString);
+        return target.method.invoke(target.target, Qt::DirectConnection, Q_ARG(QNetworkReply*, reply));
+    }
+    return target.method.invoke(target.target, Qt::DirectConnection, Q_ARG(QString, QString::fromUtf8(record.payload)));
+}
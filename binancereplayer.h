@@ -0,0 +1,90 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#ifndef BINANCEREPLAYER_H
+#define BINANCEREPLAYER_H
+
+#include <QObject>
+#include <QFile>
+#include <QDataStream>
+#include <QHash>
+#include <QList>
+#include <QMetaMethod>
+#include <QNetworkReply>
+#include <QElapsedTimer>
+#include "binancerecorder.h"
+
+// A finished QNetworkReply that serves a recorded body, so handlers written
+// against QNetworkReply* run unchanged on journal data.
+class binancereplayreply : public QNetworkReply {
+    Q_OBJECT
+public:
+    binancereplayreply(const QUrl& url, int httpStatus, const QByteArray& body, QObject* parent = nullptr,
+                       QNetworkReply::NetworkError error = QNetworkReply::NoError, const QString& errorString = QString());
+
+    void abort() override;
+    bool isSequential() const override;
+    qint64 bytesAvailable() const override;
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+
+private:
+    QByteArray body;
+    qint64 offset;
+};
+
+// Feeds a binancerecorder journal back into the handlers it was recorded
+// from, either at the recorded pace or as fast as the handlers allow.
+class binancereplayer : public QObject {
+    Q_OBJECT
+public:
+    enum Pace {
+        RecordedPace,
+        AsFastAsPossible
+    };
+
+    explicit binancereplayer(QObject* parent = nullptr);
+
+    void addTarget(QObject* target);
+    bool open(const QString& fileName);
+    void start(Pace pace = AsFastAsPossible);
+    void stop();
+
+    qint64 replayedRecords() const;
+    qint64 elapsedNs() const;
+
+    bool dispatch(const binancerecorder::Record& record);
+
+signals:
+    void finished(qint64 records, qint64 elapsedNs);
+
+private slots:
+    void replayNext();
+
+private:
+    struct Route {
+        QObject* target = nullptr;
+        QMetaMethod method;
+    };
+
+    Route route(const binancerecorder::Record& record);
+    void finish();
+
+    QList<QObject*> targets;
+    QHash<QByteArray, Route> routes;
+    QFile file;
+    QDataStream in;
+    Pace pace;
+    bool running;
+    bool hasPending;
+    binancerecorder::Record pending;
+    qint64 firstReceiveNs;
+    qint64 records;
+    QElapsedTimer clock;
+};
+
+#endif // BINANCEREPLAYER_H
@@ -0,0 +1,129 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#include "binanceresponsecache.h"
+
+binanceresponsecache::binanceresponsecache()
+    : refreshAhead(0.8), hitCount(0), missCount(0) {
+    clock.start();
+    for (int i = 0; i < int(binanceendpointid::Count); ++i) {
+        ttls[i] = 0;
+        generations[i] = 0;
+    }
+    // Changes on exchange listings, tier or account setting updates; assetIndex
+    // tracks prices, so it only saves bursts of reads.
+    ttls[int(binanceendpointid::ExchangeInfo)] = 5 * 60 * 1000;
+    ttls[int(binanceendpointid::LeverageBracket)] = 10 * 60 * 1000;
+    ttls[int(binanceendpointid::CommissionRate)] = 10 * 60 * 1000;
+    ttls[int(binanceendpointid::IndexInfo)] = 5 * 60 * 1000;
+    ttls[int(binanceendpointid::AssetIndex)] = 60 * 1000;
+    ttls[int(binanceendpointid::PositionMode)] = 10 * 60 * 1000;
+    ttls[int(binanceendpointid::ApiTradingStatus)] = 60 * 1000;
+}
+
+void binanceresponsecache::setTtl(binanceendpointid endpoint, int ttlMs) {
+    ttls[int(endpoint)] = qMax(0, ttlMs);
+    if (ttlMs <= 0) {
+        invalidate(endpoint);
+    }
+}
+
+int binanceresponsecache::ttl(binanceendpointid endpoint) const {
+    return ttls[int(endpoint)];
+}
+
+void binanceresponsecache::setRefreshAhead(double fraction) {
+    refreshAhead = qBound(0.0, fraction, 1.0);
+}
+
+QString binanceresponsecache::entryKey(binanceendpointid endpoint, const QString& key) {
+    return QString::number(int(endpoint)) + '|' + key;
+}
+
+binanceresponsecache::State binanceresponsecache::lookup(binanceendpointid endpoint, const QString& key, QUrl* url, QByteArray* body) {
+    int ttlMs = ttls[int(endpoint)];
+    auto it = ttlMs > 0 ? entries.find(entryKey(endpoint, key)) : entries.end();
+    qint64 ageMs = it != entries.end() ? clock.elapsed() - it->storedMs : 0;
+    if (it == entries.end() || ageMs >= ttlMs) {
+        ++missCount;
+        return Miss;
+    }
+    ++hitCount;
+    *url = it->url;
+    *body = it->body;
+    return ageMs >= qint64(ttlMs * refreshAhead) && !it->refreshing ? Refresh : Hit;
+}
+
+void binanceresponsecache::store(binanceendpointid endpoint, const QString& key, const QUrl& url, const QByteArray& body) {
+    if (ttls[int(endpoint)] <= 0) {
+        return;
+    }
+    Entry& entry = entries[entryKey(endpoint, key)];
+    entry.url = url;
+    entry.body = body;
+    entry.document = QJsonDocument();
+    entry.decoded = false;
+    entry.storedMs = clock.elapsed();
+}
+
+const QJsonDocument* binanceresponsecache::document(binanceendpointid endpoint, const QString& key) {
+    auto it = entries.find(entryKey(endpoint, key));
+    if (it == entries.end()) {
+        return nullptr;
+    }
+    if (!it->decoded) {
+        it->document = QJsonDocument::fromJson(it->body);
+        it->decoded = true;
+    }
+    return &it->document;
+}
+
+bool binanceresponsecache::beginRefresh(binanceendpointid endpoint, const QString& key) {
+    auto it = entries.find(entryKey(endpoint, key));
+    if (it == entries.end() || it->refreshing) {
+        return false;
+    }
+    it->refreshing = true;
+    return true;
+}
+
+void binanceresponsecache::endRefresh(binanceendpointid endpoint, const QString& key) {
+    auto it = entries.find(entryKey(endpoint, key));
+    if (it != entries.end()) {
+        it->refreshing = false;
+    }
+}
+
+quint64 binanceresponsecache::generation(binanceendpointid endpoint) const {
+    return generations[int(endpoint)];
+}
+
+void binanceresponsecache::invalidate(binanceendpointid endpoint) {
+    ++generations[int(endpoint)];
+    const QString prefix = entryKey(endpoint, QString());
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (it.key().startsWith(prefix)) {
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void binanceresponsecache::clear() {
+    for (int i = 0; i < int(binanceendpointid::Count); ++i) {
+        ++generations[i];
+    }
+    entries.clear();
+}
+
+qint64 binanceresponsecache::hits() const {
+    return hitCount;
+}
+
+qint64 binanceresponsecache::misses() const {
+    return missCount;
+}
@@ -0,0 +1,81 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#ifndef BINANCERESPONSECACHE_H
+#define BINANCERESPONSECACHE_H
+
+#include <QHash>
+#include <QUrl>
+#include <QByteArray>
+#include <QJsonDocument>
+#include <QElapsedTimer>
+#include "binanceendpoints.h"
+
+// Response bodies of static-data endpoints (exchangeInfo, leverageBracket,
+// commissionRate, indexInfo, assetIndex, positionSide/dual, apiTradingStatus)
+// keyed by endpoint and the request parameters that select the data (the
+// symbol; never timestamp or signature). Bodies are implicitly shared, a
+// hit copies nothing. document() decodes an entry's body on first use and
+// keeps the result, so no hit parses the body again.
+//
+// An entry older than refreshAhead * ttl is still served but reported as
+// Refresh, so the owner can fetch a replacement before it expires.
+// invalidate() also bumps the endpoint's generation; a fetch that started
+// before the invalidation must not be stored.
+//
+// Not thread-safe; owned by one binanceapi and used from its thread.
+class binanceresponsecache {
+public:
+    enum State {
+        Miss,
+        Hit,
+        Refresh
+    };
+
+    binanceresponsecache();
+
+    //0 disables caching for the endpoint
+    void setTtl(binanceendpointid endpoint, int ttlMs);
+    int ttl(binanceendpointid endpoint) const;
+    void setRefreshAhead(double fraction);
+
+    State lookup(binanceendpointid endpoint, const QString& key, QUrl* url, QByteArray* body);
+    void store(binanceendpointid endpoint, const QString& key, const QUrl& url, const QByteArray& body);
+    //nullptr without an entry
+    const QJsonDocument* document(binanceendpointid endpoint, const QString& key);
+    //false while a refresh of the entry is already in flight
+    bool beginRefresh(binanceendpointid endpoint, const QString& key);
+    void endRefresh(binanceendpointid endpoint, const QString& key);
+
+    quint64 generation(binanceendpointid endpoint) const;
+    void invalidate(binanceendpointid endpoint);
+    void clear();
+
+    qint64 hits() const;
+    qint64 misses() const;
+
+private:
+    struct Entry {
+        QUrl url;
+        QByteArray body;
+        QJsonDocument document;
+        bool decoded = false;
+        qint64 storedMs = 0;
+        bool refreshing = false;
+    };
+
+    static QString entryKey(binanceendpointid endpoint, const QString& key);
+
+    QElapsedTimer clock;
+    int ttls[int(binanceendpointid::Count)];
+    quint64 generations[int(binanceendpointid::Count)];
+    double refreshAhead;
+    QHash<QString, Entry> entries;
+    qint64 hitCount;
+    qint64 missCount;
+};
+
+#endif // BINANCERESPONSECACHE_H
@@ -0,0 +1,154 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#include "binancetracer.h"
+#include <QThread>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+#include <cmath>
+
+static std::atomic<quint64> nextGeneration(1);
+
+binancetracer::Buffer::Buffer(int capacity)
+    : threadId(0), spans(new Span[capacity]), capacity(capacity), size(0), dropped(0) {
+}
+
+binancetracer::Buffer::~Buffer() {
+    delete[] spans;
+}
+
+binancetracer::binancetracer(int spansPerThread, QObject* parent)
+    : QObject(parent), generation(nextGeneration.fetch_add(1)), spansPerThread(qMax(1, spansPerThread)), period(0), ids(0) {
+    clock.start();
+}
+
+binancetracer::~binancetracer() {
+    qDeleteAll(buffers);
+}
+
+void binancetracer::setSampleRate(double rate) {
+    period.store(rate <= 0.0 ? 0 : quint64(qMax(1.0, std::round(1.0 / qMin(1.0, rate)))), std::memory_order_relaxed);
+}
+
+double binancetracer::sampleRate() const {
+    quint64 every = period.load(std::memory_order_relaxed);
+    return every == 0 ? 0.0 : 1.0 / every;
+}
+
+bool binancetracer::sample() {
+    // Every period-th call per thread; deterministic and free of shared writes.
+    quint64 every = period.load(std::memory_order_relaxed);
+    if (every == 0) {
+        return false;
+    }
+    thread_local quint64 calls = 0;
+    return calls++ % every == 0;
+}
+
+qint64 binancetracer::now() const {
+    return clock.nsecsElapsed();
+}
+
+quint64 binancetracer::nextId() {
+    return ids.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+binancetracer::Buffer* binancetracer::buffer() {
+    thread_local quint64 cachedGeneration = 0;
+    thread_local Buffer* cached = nullptr;
+    if (cachedGeneration == generation) {
+        return cached;
+    }
+    QMutexLocker lock(&mutex);
+    Buffer*& found = bufferByThread[QThread::currentThreadId()];
+    if (!found) {
+        found = new Buffer(spansPerThread);
+        found->threadId = quint64(buffers.size() + 1);
+        QString name = QThread::currentThread()->objectName();
+        found->threadName = name.isEmpty() ? QString("thread-%1").arg(found->threadId) : name;
+        buffers.append(found);
+    }
+    cachedGeneration = generation;
+    cached = found;
+    return found;
+}
+
+void binancetracer::record(const char* name, const char* stage, quint64 id, qint64 startNs, qint64 endNs) {
+    Buffer* own = buffer();
+    int at = own->size.load(std::memory_order_relaxed);
+    if (at >= own->capacity) {
+        own->dropped.store(own->dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return;
+    }
+    own->spans[at] = Span{name, stage, id, startNs, qMax(startNs, endNs)};
+    own->size.store(at + 1, std::memory_order_release);
+}
+
+qint64 binancetracer::dropped() const {
+    QMutexLocker lock(&mutex);
+    qint64 total = 0;
+    for (const Buffer* source : buffers) {
+        total += qint64(source->dropped.load(std::memory_order_relaxed));
+    }
+    return total;
+}
+
+QByteArray binancetracer::toChromeTrace() const {
+    QJsonArray events;
+    QMutexLocker lock(&mutex);
+    for (const Buffer* source : buffers) {
+        QJsonObject thread;
+        thread.insert("name", "thread_name");
+        thread.insert("ph", "M");
+        thread.insert("pid", 1);
+        thread.insert("tid", qint64(source->threadId));
+        thread.insert("args", QJsonObject{{"name", source->threadName}});
+        events.append(thread);
+
+        int size = source->size.load(std::memory_order_acquire);
+        for (int i = 0; i < size; ++i) {
+            const Span& span = source->spans[i];
+            QJsonObject begin;
+            begin.insert("name", QString::fromLatin1(span.stage ? span.stage : span.name));
+            begin.insert("cat", QString::fromLatin1(span.name));
+            begin.insert("id", QString::number(span.id, 16).prepend("0x"));
+            begin.insert("pid", 1);
+            begin.insert("tid", qint64(source->threadId));
+            QJsonObject end = begin;
+            begin.insert("ph", "b");
+            begin.insert("ts", span.startNs / 1000.0);
+            end.insert("ph", "e");
+            end.insert("ts", span.endNs / 1000.0);
+            events.append(begin);
+            events.append(end);
+        }
+    }
+
+    QJsonObject trace;
+    trace.insert("traceEvents", events);
+    trace.insert("displayTimeUnit", "ns");
+    return QJsonDocument(trace).toJson(QJsonDocument::Compact);
+}
+
+bool binancetracer::writeChromeTrace(const QString& fileName) const {
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << "binancetracer: cannot write" << fileName << file.errorString();
+        return false;
+    }
+    return file.write(toChromeTrace()) >= 0;
+}
+
+void binancetracer::clear() {
+    QMutexLocker lock(&mutex);
+    for (Buffer* source : qAsConst(buffers)) {
+        source->size.store(0, std::memory_order_relaxed);
+        source->dropped.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,79 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#ifndef BINANCETRACER_H
+#define BINANCETRACER_H
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QList>
+#include <QElapsedTimer>
+#include <atomic>
+
+// Sampled request lifecycle spans, dumped as Chrome trace-event JSON
+// (chrome://tracing, Perfetto). Each recording thread appends to its own
+// fixed size buffer without locking; a full buffer drops spans and counts
+// them. A request is one async track: the outer span carries the endpoint
+// name and the stage spans (queue, connect, wait, download, decode, deliver)
+// nest inside it.
+//
+// name and stage must be string literals or otherwise outlive the tracer.
+class binancetracer : public QObject {
+    Q_OBJECT
+public:
+    explicit binancetracer(int spansPerThread = 65536, QObject* parent = nullptr);
+    ~binancetracer();
+
+    //fraction of requests and messages traced, 0 disables, 1 traces all
+    void setSampleRate(double rate);
+    double sampleRate() const;
+    bool sample();
+
+    qint64 now() const;
+    quint64 nextId();
+    //stage nullptr records the outer span of the request
+    void record(const char* name, const char* stage, quint64 id, qint64 startNs, qint64 endNs);
+
+    qint64 dropped() const;
+    QByteArray toChromeTrace() const;
+    bool writeChromeTrace(const QString& fileName) const;
+    //only while no thread is recording
+    void clear();
+
+private:
+    struct Span {
+        const char* name;
+        const char* stage;
+        quint64 id;
+        qint64 startNs;
+        qint64 endNs;
+    };
+
+    struct Buffer {
+        explicit Buffer(int capacity);
+        ~Buffer();
+        QString threadName;
+        quint64 threadId;
+        Span* spans;
+        int capacity;
+        std::atomic<int> size;
+        std::atomic<quint64> dropped;
+    };
+
+    Buffer* buffer();
+
+    const quint64 generation;
+    const int spansPerThread;
+    std::atomic<quint64> period;
+    std::atomic<quint64> ids;
+    QElapsedTimer clock;
+    mutable QMutex mutex;
+    QHash<Qt::HANDLE, Buffer*> bufferByThread;
+    QList<Buffer*> buffers;
+};
+
+#endif // BINANCETRACER_H
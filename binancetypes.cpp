@@ -0,0 +1,143 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#include "binancetypes.h"
+#include <QJsonValue>
+
+namespace binancetypes {
+
+// Binance sends prices and quantities as strings, ids and times as numbers.
+static double decimal(const QJsonValue& value) {
+    return value.isString() ? value.toString().toDouble() : value.toDouble();
+}
+
+static qint64 integer(const QJsonValue& value) {
+    return value.isString() ? value.toString().toLongLong() : qint64(value.toDouble());
+}
+
+static void decodeLevels(const QJsonArray& rows, QVector<PriceLevel>& levels) {
+    levels.reserve(rows.size());
+    for (const QJsonValue& row : rows) {
+        const QJsonArray level = row.toArray();
+        levels.append(PriceLevel{decimal(level.at(0)), decimal(level.at(1))});
+    }
+}
+
+DepthSnapshotPtr decodeDepth(const QString& symbol, const QJsonObject& depth) {
+    QSharedPointer<DepthSnapshot> snapshot(new DepthSnapshot);
+    snapshot->symbol = symbol;
+    snapshot->lastUpdateId = integer(depth.value("lastUpdateId"));
+    snapshot->eventTime = integer(depth.value("E"));
+    snapshot->transactionTime = integer(depth.value("T"));
+    decodeLevels(depth.value("bids").toArray(), snapshot->bids);
+    decodeLevels(depth.value("asks").toArray(), snapshot->asks);
+    return snapshot;
+}
+
+KlineBatchPtr decodeKlines(const QString& endpoint, const QString& symbol, const QString& interval, const QJsonArray& rows) {
+    QSharedPointer<KlineBatch> batch(new KlineBatch);
+    batch->endpoint = endpoint;
+    batch->symbol = symbol;
+    batch->interval = interval;
+    batch->klines.reserve(rows.size());
+    // [openTime, open, high, low, close, volume, closeTime, quoteVolume, trades, takerBuyVolume, takerBuyQuoteVolume, ignore]
+    for (const QJsonValue& row : rows) {
+        const QJsonArray fields = row.toArray();
+        Kline kline;
+        kline.openTime = integer(fields.at(0));
+        kline.open = decimal(fields.at(1));
+        kline.high = decimal(fields.at(2));
+        kline.low = decimal(fields.at(3));
+        kline.close = decimal(fields.at(4));
+        kline.volume = decimal(fields.at(5));
+        kline.closeTime = integer(fields.at(6));
+        kline.quoteVolume = decimal(fields.at(7));
+        kline.trades = integer(fields.at(8));
+        kline.takerBuyVolume = decimal(fields.at(9));
+        kline.takerBuyQuoteVolume = decimal(fields.at(10));
+        batch->klines.append(kline);
+    }
+    return batch;
+}
+
+OrderAckPtr decodeOrderAck(const QJsonObject& order) {
+    QSharedPointer<OrderAck> ack(new OrderAck);
+    ack->symbol = order.value("symbol").toString();
+    ack->orderId = integer(order.value("orderId"));
+    ack->clientOrderId = order.value("clientOrderId").toString();
+    ack->side = order.value("side").toString();
+    ack->positionSide = order.value("positionSide").toString();
+    ack->type = order.value("type").toString();
+    ack->timeInForce = order.value("timeInForce").toString();
+    ack->status = order.value("status").toString();
+    ack->price = decimal(order.value("price"));
+    ack->stopPrice = decimal(order.value("stopPrice"));
+    ack->avgPrice = decimal(order.value("avgPrice"));
+    ack->origQty = decimal(order.value("origQty"));
+    ack->executedQty = decimal(order.value("executedQty"));
+    ack->cumQuote = decimal(order.value("cumQuote"));
+    ack->reduceOnly = order.value("reduceOnly").toBool();
+    ack->closePosition = order.value("closePosition").toBool();
+    ack->updateTime = integer(order.value("updateTime"));
+    return ack;
+}
+
+PositionListPtr decodePositions(const QJsonArray& positions) {
+    QSharedPointer<PositionList> list(new PositionList);
+    list->positions.reserve(positions.size());
+    for (const QJsonValue& value : positions) {
+        const QJsonObject entry = value.toObject();
+        Position position;
+        position.symbol = entry.value("symbol").toString();
+        position.positionSide = entry.value("positionSide").toString();
+        position.marginType = entry.value("marginType").toString();
+        position.positionAmt = decimal(entry.value("positionAmt"));
+        position.entryPrice = decimal(entry.value("entryPrice"));
+        position.markPrice = decimal(entry.value("markPrice"));
+        position.unRealizedProfit = decimal(entry.value("unRealizedProfit"));
+        position.liquidationPrice = decimal(entry.value("liquidationPrice"));
+        position.isolatedMargin = decimal(entry.value("isolatedMargin"));
+        position.notional = decimal(entry.value("notional"));
+        position.leverage = int(integer(entry.value("leverage")));
+        position.updateTime = integer(entry.value("updateTime"));
+        list->positions.append(position);
+    }
+    return list;
+}
+
+IncomeRecordsPtr decodeIncome(const QJsonArray& records) {
+    QSharedPointer<IncomeRecords> income(new IncomeRecords);
+    income->records.reserve(records.size());
+    for (const QJsonValue& value : records) {
+        const QJsonObject entry = value.toObject();
+        Income record;
+        record.symbol = entry.value("symbol").toString();
+        record.incomeType = entry.value("incomeType").toString();
+        record.asset = entry.value("asset").toString();
+        record.info = entry.value("info").toString();
+        record.tradeId = entry.value("tradeId").toString();
+        record.income = decimal(entry.value("income"));
+        record.time = integer(entry.value("time"));
+        record.tranId = integer(entry.value("tranId"));
+        income->records.append(record);
+    }
+    return income;
+}
+
+void registerMetaTypes() {
+    // Thread-safe once; several lanes construct their binanceapi on their own threads.
+    static const bool registered = []() {
+        qRegisterMetaType<DepthSnapshotPtr>("binancetypes::DepthSnapshotPtr");
+        qRegisterMetaType<KlineBatchPtr>("binancetypes::KlineBatchPtr");
+        qRegisterMetaType<OrderAckPtr>("binancetypes::OrderAckPtr");
+        qRegisterMetaType<PositionListPtr>("binancetypes::PositionListPtr");
+        qRegisterMetaType<IncomeRecordsPtr>("binancetypes::IncomeRecordsPtr");
+        return true;
+    }();
+    Q_UNUSED(registered);
+}
+
+}
@@ -0,0 +1,137 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#ifndef BINANCETYPES_H
+#define BINANCETYPES_H
+
+#include <QString>
+#include <QVector>
+#include <QSharedPointer>
+#include <QMetaType>
+#include <QJsonObject>
+#include <QJsonArray>
+
+// Typed endpoint results. Each is decoded once on the network thread into
+// plain numbers and strings and published as a QSharedPointer to const, so a
+// queued delivery to any number of receivers copies one pointer and bumps a
+// reference count; nobody can modify what another receiver is reading.
+namespace binancetypes {
+
+struct PriceLevel {
+    double price = 0.0;
+    double quantity = 0.0;
+};
+
+struct DepthSnapshot {
+    QString symbol;
+    qint64 lastUpdateId = 0;
+    qint64 eventTime = 0;
+    qint64 transactionTime = 0;
+    QVector<PriceLevel> bids;
+    QVector<PriceLevel> asks;
+};
+
+struct Kline {
+    qint64 openTime = 0;
+    qint64 closeTime = 0;
+    double open = 0.0;
+    double high = 0.0;
+    double low = 0.0;
+    double close = 0.0;
+    double volume = 0.0;
+    double quoteVolume = 0.0;
+    double takerBuyVolume = 0.0;
+    double takerBuyQuoteVolume = 0.0;
+    qint64 trades = 0;
+};
+
+//klines, continuousKlines, indexPriceKlines and markPriceKlines; symbol holds the pair for the last two
+struct KlineBatch {
+    QString endpoint;
+    QString symbol;
+    QString interval;
+    QVector<Kline> klines;
+};
+
+//REST and WebSocket API order placement, amendment and cancel results
+struct OrderAck {
+    QString symbol;
+    qint64 orderId = 0;
+    QString clientOrderId;
+    QString side;
+    QString positionSide;
+    QString type;
+    QString timeInForce;
+    QString status;
+    double price = 0.0;
+    double stopPrice = 0.0;
+    double avgPrice = 0.0;
+    double origQty = 0.0;
+    double executedQty = 0.0;
+    double cumQuote = 0.0;
+    bool reduceOnly = false;
+    bool closePosition = false;
+    qint64 updateTime = 0;
+};
+
+struct Position {
+    QString symbol;
+    QString positionSide;
+    QString marginType;
+    double positionAmt = 0.0;
+    double entryPrice = 0.0;
+    double markPrice = 0.0;
+    double unRealizedProfit = 0.0;
+    double liquidationPrice = 0.0;
+    double isolatedMargin = 0.0;
+    double notional = 0.0;
+    int leverage = 0;
+    qint64 updateTime = 0;
+};
+
+struct PositionList {
+    QVector<Position> positions;
+};
+
+struct Income {
+    QString symbol;
+    QString incomeType;
+    QString asset;
+    QString info;
+    QString tradeId;
+    double income = 0.0;
+    qint64 time = 0;
+    qint64 tranId = 0;
+};
+
+struct IncomeRecords {
+    QVector<Income> records;
+};
+
+typedef QSharedPointer<const DepthSnapshot> DepthSnapshotPtr;
+typedef QSharedPointer<const KlineBatch> KlineBatchPtr;
+typedef QSharedPointer<const OrderAck> OrderAckPtr;
+typedef QSharedPointer<const PositionList> PositionListPtr;
+typedef QSharedPointer<const IncomeRecords> IncomeRecordsPtr;
+
+DepthSnapshotPtr decodeDepth(const QString& symbol, const QJsonObject& depth);
+KlineBatchPtr decodeKlines(const QString& endpoint, const QString& symbol, const QString& interval, const QJsonArray& rows);
+OrderAckPtr decodeOrderAck(const QJsonObject& order);
+PositionListPtr decodePositions(const QJsonArray& positions);
+IncomeRecordsPtr decodeIncome(const QJsonArray& records);
+
+//once per process before queued connections carry these types; binanceapi does it on construction
+void registerMetaTypes();
+
+}
+
+Q_DECLARE_METATYPE(binancetypes::DepthSnapshotPtr)
+Q_DECLARE_METATYPE(binancetypes::KlineBatchPtr)
+Q_DECLARE_METATYPE(binancetypes::OrderAckPtr)
+Q_DECLARE_METATYPE(binancetypes::PositionListPtr)
+Q_DECLARE_METATYPE(binancetypes::IncomeRecordsPtr)
+
+#endif // BINANCETYPES_H
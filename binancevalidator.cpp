@@ -0,0 +1,246 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#include "binancevalidator.h"
+#include "binanceapi.h"
+#include "binancemarkprices.h"
+#include "binanceorders.h"
+#include "binancepositions.h"
+#include <QDateTime>
+#include <cmath>
+
+binancevalidator::binancevalidator(binanceapi* api, QObject* parent)
+    : QObject(parent), api(api), markPrices(nullptr), orders(nullptr), positions(nullptr) {
+    connect(api, &binanceapi::exchangeInfoReceived, this, &binancevalidator::handleExchangeInfo);
+    connect(api, &binanceapi::leverageBracketReceived, this, &binancevalidator::handleLeverageBracket);
+    connect(api, &binanceapi::leverageChanged, this, &binancevalidator::setLeverage);
+    connect(api, &binanceapi::positionRiskReceived, this, &binancevalidator::handlePositionRisk);
+}
+
+void binancevalidator::refresh() {
+    api->getExchangeInfo();
+    api->getLeverageBracket(QString(), -1, QDateTime::currentMSecsSinceEpoch());
+    // Leverage set before this process started is only known from positionRisk.
+    api->getPositionRisk(QString(), -1, QDateTime::currentMSecsSinceEpoch());
+}
+
+void binancevalidator::setMarkPrices(binancemarkprices* markPrices) {
+    this->markPrices = markPrices;
+}
+
+void binancevalidator::setOrders(binanceorders* orders) {
+    this->orders = orders;
+}
+
+void binancevalidator::setPositions(binancepositions* positions) {
+    this->positions = positions;
+}
+
+void binancevalidator::setLeverage(const QString& symbol, int leverage) {
+    if (!symbol.isEmpty()) {
+        rulesFor(symbol).leverage = leverage;
+    }
+}
+
+binancevalidator::Rules& binancevalidator::rulesFor(const QString& symbol) {
+    auto it = index.constFind(symbol);
+    if (it != index.constEnd()) {
+        return table[it.value()];
+    }
+    index.insert(symbol, table.size());
+    table.append(Rules());
+    table.last().symbol = symbol;
+    return table.last();
+}
+
+double binancevalidator::positionQuantity(const Rules& r) const {
+    if (!positions) {
+        return r.positionQty;
+    }
+    // Hedge mode sides are netted, as in positionQty.
+    double quantity = 0.0;
+    binancepositions::Position position;
+    for (const char* side : {"BOTH", "LONG", "SHORT"}) {
+        if (positions->get(r.symbol, &position, QLatin1String(side))) {
+            quantity += position.quantity;
+        }
+    }
+    return quantity;
+}
+
+const binancevalidator::Rules* binancevalidator::rules(const QString& symbol) const {
+    auto it = index.constFind(symbol);
+    return it == index.constEnd() ? nullptr : &table.at(it.value());
+}
+
+bool binancevalidator::onStep(double value, double origin, double step) {
+    if (step <= 0.0) {
+        return true;
+    }
+    double steps = (value - origin) / step;
+    return std::fabs(steps - std::round(steps)) < 1e-6;
+}
+
+int binancevalidator::check(const QString& symbol, const QString& side, const QString& type, const QString& price,
+                            const QString& quantity, bool reduceOnly, QString* message) const {
+    const Rules* symbolRules = rules(symbol);
+    if (!symbolRules || !symbolRules->trading) {
+        *message = "Invalid symbol.";
+        return -1121;
+    }
+    const Rules& r = *symbolRules;
+    bool market = type == "MARKET" || type == "STOP_MARKET" || type == "TAKE_PROFIT_MARKET" || type == "TRAILING_STOP_MARKET";
+
+    double qty = quantity.toDouble();
+    if (!quantity.isEmpty()) {
+        double minQty = market ? r.marketMinQty : r.minQty;
+        double maxQty = market ? r.marketMaxQty : r.maxQty;
+        double stepSize = market ? r.marketStepSize : r.stepSize;
+        if (qty <= 0.0) {
+            *message = "Quantity less than or equal to zero.";
+            return -4003;
+        }
+        if (qty < minQty) {
+            *message = QString("Quantity less than min quantity %1.").arg(minQty);
+            return -4004;
+        }
+        if (maxQty > 0.0 && qty > maxQty) {
+            *message = QString("Quantity greater than max quantity %1.").arg(maxQty);
+            return -4005;
+        }
+        if (!onStep(qty, minQty, stepSize)) {
+            *message = QString("Quantity not increased by step size %1.").arg(stepSize);
+            return -4023;
+        }
+    }
+
+    double mark = markPrices ? markPrices->markPrice(symbol) : 0.0;
+    double px = market ? mark : price.toDouble();
+    if (!market && !price.isEmpty()) {
+        if (px < r.minPrice) {
+            *message = QString("Price less than min price %1.").arg(r.minPrice);
+            return -4013;
+        }
+        if (r.maxPrice > 0.0 && px > r.maxPrice) {
+            *message = QString("Price greater than max price %1.").arg(r.maxPrice);
+            return -1013;
+        }
+        if (!onStep(px, r.minPrice, r.tickSize)) {
+            *message = QString("Price not increased by tick size %1.").arg(r.tickSize);
+            return -4014;
+        }
+        if (mark > 0.0 && side == "BUY" && r.multiplierUp > 0.0 && px > mark * r.multiplierUp) {
+            *message = QString("Limit price can't be higher than %1.").arg(mark * r.multiplierUp);
+            return -4016;
+        }
+        if (mark > 0.0 && side == "SELL" && r.multiplierDown > 0.0 && px < mark * r.multiplierDown) {
+            *message = QString("Limit price can't be lower than %1.").arg(mark * r.multiplierDown);
+            return -4024;
+        }
+    }
+
+    if (orders && r.maxNumOrders > 0 && orders->openOrderCount(symbol) >= r.maxNumOrders) {
+        *message = "Reach max open order limit.";
+        return -2025;
+    }
+
+    double notional = px * qty;
+    if (!reduceOnly && notional > 0.0) {
+        if (notional < r.minNotional) {
+            *message = QString("Order's notional must be no smaller than %1.").arg(r.minNotional);
+            return -4164;
+        }
+        // Highest notional cap among the brackets that still allow our leverage.
+        double cap = 0.0;
+        for (const Bracket& bracket : r.brackets) {
+            if (bracket.initialLeverage >= r.leverage && bracket.notionalCap > cap) {
+                cap = bracket.notionalCap;
+            }
+        }
+        // The cap bounds the position the order leaves behind; an order that
+        // shrinks the position is never held back by it.
+        double current = positionQuantity(r);
+        double before = std::fabs(current) * px;
+        double after = std::fabs(current + (side == "SELL" ? -qty : qty)) * px;
+        if (r.leverage > 0 && !r.brackets.isEmpty() && after > cap && after > before) {
+            *message = "Exceeded the maximum allowable position at current leverage.";
+            return -2027;
+        }
+    }
+    return 0;
+}
+
+void binancevalidator::handleExchangeInfo(const QJsonObject& exchangeInfo) {
+    const QJsonArray symbols = exchangeInfo.value("symbols").toArray();
+    for (const QJsonValue& value : symbols) {
+        QJsonObject symbol = value.toObject();
+        Rules& r = rulesFor(symbol.value("symbol").toString());
+        r.trading = symbol.value("status").toString() == "TRADING";
+
+        const QJsonArray filters = symbol.value("filters").toArray();
+        for (const QJsonValue& filterValue : filters) {
+            QJsonObject filter = filterValue.toObject();
+            QString type = filter.value("filterType").toString();
+            if (type == "PRICE_FILTER") {
+                r.minPrice = filter.value("minPrice").toString().toDouble();
+                r.maxPrice = filter.value("maxPrice").toString().toDouble();
+                r.tickSize = filter.value("tickSize").toString().toDouble();
+            } else if (type == "LOT_SIZE") {
+                r.minQty = filter.value("minQty").toString().toDouble();
+                r.maxQty = filter.value("maxQty").toString().toDouble();
+                r.stepSize = filter.value("stepSize").toString().toDouble();
+            } else if (type == "MARKET_LOT_SIZE") {
+                r.marketMinQty = filter.value("minQty").toString().toDouble();
+                r.marketMaxQty = filter.value("maxQty").toString().toDouble();
+                r.marketStepSize = filter.value("stepSize").toString().toDouble();
+            } else if (type == "MIN_NOTIONAL") {
+                r.minNotional = filter.value("notional").toString().toDouble();
+            } else if (type == "PERCENT_PRICE") {
+                r.multiplierUp = filter.value("multiplierUp").toString().toDouble();
+                r.multiplierDown = filter.value("multiplierDown").toString().toDouble();
+            } else if (type == "MAX_NUM_ORDERS") {
+                r.maxNumOrders = filter.value("limit").toInt();
+            }
+        }
+    }
+    emit rulesUpdated();
+}
+
+void binancevalidator::handlePositionRisk(const QJsonArray& entries) {
+    QHash<QString, double> quantities;
+    for (const QJsonValue& value : entries) {
+        QJsonObject entry = value.toObject();
+        QString symbol = entry.value("symbol").toString();
+        int leverage = entry.value("leverage").toString().toInt();
+        if (leverage > 0) {
+            rulesFor(symbol).leverage = leverage;
+        }
+        quantities[symbol] += entry.value("positionAmt").toString().toDouble();
+    }
+    for (auto it = quantities.constBegin(); it != quantities.constEnd(); ++it) {
+        rulesFor(it.key()).positionQty = it.value();
+    }
+    emit rulesUpdated();
+}
+
+void binancevalidator::handleLeverageBracket(const QJsonArray& brackets) {
+    for (const QJsonValue& value : brackets) {
+        QJsonObject symbol = value.toObject();
+        Rules& r = rulesFor(symbol.value("symbol").toString());
+        r.brackets.clear();
+        const QJsonArray list = symbol.value("brackets").toArray();
+        for (const QJsonValue& bracketValue : list) {
+            QJsonObject entry = bracketValue.toObject();
+            Bracket bracket;
+            bracket.initialLeverage = entry.value("initialLeverage").toInt();
+            bracket.notionalCap = entry.value("notionalCap").toDouble();
+            bracket.maintMarginRatio = entry.value("maintMarginRatio").toDouble();
+            bracket.maintAmount = entry.value("cum").toDouble();
+            r.brackets.append(bracket);
+        }
+    }
+    emit rulesUpdated();
+}
@@ -0,0 +1,92 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+#ifndef BINANCEVALIDATOR_H
+#define BINANCEVALIDATOR_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QJsonObject>
+#include <QJsonArray>
+
+class binanceapi;
+class binancemarkprices;
+class binanceorders;
+class binancepositions;
+
+// Pre-trade checks against the symbol filters from exchangeInfo and the
+// notional caps from leverageBracket. Leverage and position size are seeded
+// from positionRisk; the cap is checked against the position the order would
+// leave, not the order alone. Rejections use the error codes the exchange
+// would have answered with, so callers handle both the same way.
+class binancevalidator : public QObject {
+    Q_OBJECT
+public:
+    struct Bracket {
+        int initialLeverage = 0;
+        double notionalCap = 0.0;
+        double maintMarginRatio = 0.0;
+        double maintAmount = 0.0;
+    };
+
+    struct Rules {
+        QString symbol;
+        bool trading = false;
+        double minPrice = 0.0;
+        double maxPrice = 0.0;
+        double tickSize = 0.0;
+        double minQty = 0.0;
+        double maxQty = 0.0;
+        double stepSize = 0.0;
+        double marketMinQty = 0.0;
+        double marketMaxQty = 0.0;
+        double marketStepSize = 0.0;
+        double minNotional = 0.0;
+        double multiplierUp = 0.0;
+        double multiplierDown = 0.0;
+        int maxNumOrders = 0;
+        int leverage = 0;
+        //net signed position from positionRisk, used without binancepositions
+        double positionQty = 0.0;
+        QVector<Bracket> brackets;
+    };
+
+    explicit binancevalidator(binanceapi* api, QObject* parent = nullptr);
+
+    void refresh();
+    void setMarkPrices(binancemarkprices* markPrices);
+    void setOrders(binanceorders* orders);
+    //live position sizes for the bracket cap, instead of the last positionRisk
+    void setPositions(binancepositions* positions);
+    void setLeverage(const QString& symbol, int leverage);
+
+    int check(const QString& symbol, const QString& side, const QString& type, const QString& price,
+              const QString& quantity, bool reduceOnly, QString* message) const;
+    const Rules* rules(const QString& symbol) const;
+    static bool onStep(double value, double origin, double step);
+
+signals:
+    void rulesUpdated();
+
+private slots:
+    void handleExchangeInfo(const QJsonObject& exchangeInfo);
+    void handleLeverageBracket(const QJsonArray& brackets);
+    void handlePositionRisk(const QJsonArray& positions);
+
+private:
+    Rules& rulesFor(const QString& symbol);
+    double positionQuantity(const Rules& r) const;
+
+    binanceapi* api;
+    binancemarkprices* markPrices;
+    binanceorders* orders;
+    binancepositions* positions;
+    QHash<QString, int> index;
+    QVector<Rules> table;
+};
+
+#endif // BINANCEVALIDATOR_H
@@ -0,0 +1,46 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+// Standalone local fapi stand-in.
+//
+//   localserver [--http-port N] [--stream-port N] [--latency MIN[:MAX]]
+//               [--error-rate P] [--429-rate P] [--disconnect-rate P]
+//               [--stream-interval MS]
+//
+// Clients connect with binanceapi::setBaseUrls("http://127.0.0.1:<http-port>",
+// "ws://127.0.0.1:<stream-port>", "ws://127.0.0.1:<stream-port>/ws-fapi/v1").
+#include "../binancelocalserver.h"
+#include <QCoreApplication>
+#include <QStringList>
+#include <cstdio>
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    auto option = [&args](const QString& name, const QString& fallback) {
+        int at = args.indexOf(name);
+        return at >= 0 && at + 1 < args.size() ? args.at(at + 1) : fallback;
+    };
+
+    binancelocalserver::Faults faults;
+    const QStringList latency = option("--latency", "0").split(':');
+    faults.minLatencyMs = latency.value(0).toInt();
+    faults.maxLatencyMs = latency.value(1, latency.value(0)).toInt();
+    faults.errorRate = option("--error-rate", "0").toDouble();
+    faults.rateLimitRate = option("--429-rate", "0").toDouble();
+    faults.disconnectRate = option("--disconnect-rate", "0").toDouble();
+
+    binancelocalserver server;
+    server.setFaults(faults);
+    server.setStreamInterval(option("--stream-interval", "100").toInt());
+    if (!server.listen(quint16(option("--http-port", "8080").toUInt()), quint16(option("--stream-port", "8081").toUInt()))) {
+        return 1;
+    }
+    printf("rest %s\nstream %s\nws-api %s\n", qPrintable(server.restUrl()), qPrintable(server.streamUrl()),
+           qPrintable(server.webSocketApiUrl()));
+    fflush(stdout);
+    return app.exec();
+}
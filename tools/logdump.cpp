@@ -0,0 +1,43 @@
+/*
+======================================================================
+=        Copyright (C) Mehdi torshani  email:mehdi.torshani@gmail.com
+=                       .:M.T:.
+======================================================================
+*/
+// Renders a binancelogger file as text, one record per line.
+//
+//   logdump <file> [--level debug|info|warn|error] [--endpoint NAME]
+#include "../binancelogger.h"
+#include <QCoreApplication>
+#include <QStringList>
+#include <cstdio>
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    if (args.size() < 2) {
+        fprintf(stderr, "usage: logdump <file> [--level debug|info|warn|error] [--endpoint NAME]\n");
+        return 1;
+    }
+    auto option = [&args](const QString& name, const QString& fallback) {
+        int at = args.indexOf(name);
+        return at >= 0 && at + 1 < args.size() ? args.at(at + 1) : fallback;
+    };
+
+    const QStringList levels = {"TRACE", "DEBUG", "INFO", "WARN", "ERROR"};
+    int minimum = qMax(0, levels.indexOf(option("--level", "trace").toUpper()));
+    const QString endpoint = option("--endpoint", QString());
+
+    for (const QString& line : binancelogger::decode(args.at(1))) {
+        // "<date> <time> <LEVEL> [<thread>] <endpoint> ..."
+        const QStringList fields = line.split(' ');
+        if (levels.indexOf(fields.value(2)) < minimum) {
+            continue;
+        }
+        if (!endpoint.isEmpty() && fields.value(4) != endpoint) {
+            continue;
+        }
+        printf("%s\n", qPrintable(line));
+    }
+    return 0;
+}